@@ -0,0 +1,183 @@
+// GEMV kernel benchmark.
+// Launches gemv_f, gemv_int8 and gemv_int32 over a sweep of shapes and reports launch latency and,
+// with --cycles, DPU cycles and instructions of the slowest tasklet (max over DPUs).
+// --cycles needs kernels built with -DKERNEL_PERF_COUNTERS=ON, compare two builds to compare kernel versions.
+// Results go to stdout as CSV, one record per type and shape.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "gemv_kernel.hpp"
+
+namespace {
+
+struct Options {
+  std::vector<std::string> types{"f", "int8", "int32"};
+  std::vector<uint32_t> rows{1024, 4096};
+  std::vector<uint32_t> cols{1024, 4096};
+  uint32_t iterations = 10;
+  bool cycles = false;
+};
+
+struct Result {
+  std::string type;
+  uint32_t m;
+  uint32_t n;
+  uint32_t nr_dpus;
+  double p50_us;
+  uint32_t cycles;
+  uint32_t instructions;
+};
+
+void usage(const char *name) {
+  std::cout << "Usage: " << name << " [options]\n"
+            << "  --types LIST      f,int8,int32\n"
+            << "  --rows LIST       m values\n"
+            << "  --cols LIST       n values\n"
+            << "  --iterations N    timed launches per shape\n"
+            << "  --cycles 0|1      read perf counters, kernels need KERNEL_PERF_COUNTERS\n";
+}
+
+std::vector<std::string> split(const std::string &list) {
+  std::vector<std::string> items;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (false == item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+std::vector<uint32_t> split_numbers(const std::string &list) {
+  std::vector<uint32_t> numbers;
+  for (auto &item : split(list)) {
+    numbers.push_back(static_cast<uint32_t>(strtoul(item.c_str(), nullptr, 10)));
+  }
+  return numbers;
+}
+
+bool parse(int argc, char **argv, Options &opts) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      usage(argv[0]);
+      std::exit(0);
+    }
+    if (i + 1 == argc) {
+      std::cerr << "Missing value for " << arg << "\n";
+      return false;
+    }
+    std::string value = argv[++i];
+    if (arg == "--types") {
+      opts.types = split(value);
+    } else if (arg == "--rows") {
+      opts.rows = split_numbers(value);
+    } else if (arg == "--cols") {
+      opts.cols = split_numbers(value);
+    } else if (arg == "--iterations") {
+      opts.iterations = std::max(1u, static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10)));
+    } else if (arg == "--cycles") {
+      opts.cycles = value != "0";
+    } else {
+      std::cerr << "Unknown option " << arg << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename inType, typename outType, class Kernel>
+bool measure(const std::string &type, uint32_t m, uint32_t n, const Options &opts, std::vector<Result> &results) {
+  std::vector<inType> A(static_cast<size_t>(m) * n, 1);
+  std::vector<inType> x(n, 1);
+  outType alpha = 1;
+  outType beta = 0;
+
+  Kernel kernel;
+  if (false == kernel.init(m, n)) {
+    std::cerr << "Couldn't initialize " << type << " m=" << m << " n=" << n << ", skipping\n";
+    return false;
+  }
+  kernel.set_params(&alpha, &beta, false);
+  kernel.set_A(A.data(), false);
+  kernel.set_x(x.data(), false);
+  kernel.launch(false);
+
+  std::vector<double> samples;
+  for (uint32_t i = 0; i < opts.iterations; i++) {
+    auto start = std::chrono::steady_clock::now();
+    kernel.launch(false);
+    samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+  }
+  std::sort(samples.begin(), samples.end());
+
+  Result r{.type = type,
+           .m = m,
+           .n = n,
+           .nr_dpus = kernel.get_nr_dpus(),
+           .p50_us = samples[samples.size() / 2],
+           .cycles = 0,
+           .instructions = 0};
+  if (opts.cycles) {
+    auto perf_results = kernel.get_perf_results();
+    if (perf_results.empty()) {
+      std::cerr << "No perf counters in " << type << " kernels, rebuild with -DKERNEL_PERF_COUNTERS=ON, skipping\n";
+      return false;
+    }
+    for (auto &perf : perf_results) {
+      r.cycles = std::max(r.cycles, perf.nb_cycles);
+      r.instructions = std::max(r.instructions, perf.nb_instr);
+    }
+  }
+  results.push_back(r);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options opts;
+  if (false == parse(argc, argv, opts)) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<Result> results;
+  for (auto &type : opts.types) {
+    for (auto m : opts.rows) {
+      for (auto n : opts.cols) {
+        if (type == "f") {
+          measure<float, float, GEMVF_Kernel>(type, m, n, opts, results);
+        } else if (type == "int8") {
+          measure<int8_t, int, GEMV_INT8_Kernel>(type, m, n, opts, results);
+        } else if (type == "int32") {
+          measure<int, int, GEMV_INT32_Kernel>(type, m, n, opts, results);
+        } else {
+          std::cerr << "Unknown type " << type << "\n";
+          return 1;
+        }
+      }
+    }
+  }
+
+  if (results.empty()) {
+    std::cerr << "Nothing measured\n";
+    return 1;
+  }
+
+  std::cout << "type,m,n,nr_dpus,p50_us,cycles,instructions\n";
+  for (auto &r : results) {
+    std::cout << r.type << "," << r.m << "," << r.n << "," << r.nr_dpus << "," << r.p50_us << "," << r.cycles << ","
+              << r.instructions << "\n";
+  }
+  return 0;
+}
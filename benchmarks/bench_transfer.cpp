@@ -0,0 +1,325 @@
+// Host <-> MRAM transfer benchmark.
+// Measures scatter (transfer_chunks), broadcast (transfer_full), gather (safe_gather) and per DPU
+// dpu_copy_from over a sweep of chunk sizes, DPU/rank counts, host buffer alignments and sync/async flags.
+// Results go to stdout (or --output) as CSV or JSON, one record per configuration.
+//
+// Works on hardware and on the functional simulator: pass --profile backend=simulator and keep
+// --chunks/--dpus small there, the simulator moves a few MB/s at best.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "dpu_transfer_helper.hpp"
+#include "kernel.hpp"
+
+namespace {
+
+struct Options {
+  std::vector<std::string> ops{"scatter", "broadcast", "gather", "copy_from"};
+  std::vector<size_t> chunks{64, 4096, 65536, 1048576};
+  std::vector<uint32_t> dpus{64};
+  std::vector<uint32_t> ranks{};
+  std::vector<size_t> host_offsets{0, 4};
+  std::vector<std::string> modes{"sync", "async"};
+  uint32_t iterations = 20;
+  uint32_t warmup = 2;
+  std::string profile;
+  std::string format = "csv";
+  std::string output;
+};
+
+struct Result {
+  std::string op;
+  std::string mode;
+  uint32_t nr_ranks;
+  uint32_t nr_dpus;
+  size_t chunk_size;
+  size_t host_offset;
+  uint32_t iterations;
+  double gbps;
+  double min_us;
+  double p50_us;
+  double p90_us;
+  double p99_us;
+  double max_us;
+};
+
+void usage(const char *name) {
+  std::cout << "Usage: " << name << " [options]\n"
+            << "  --ops LIST           scatter,broadcast,gather,copy_from\n"
+            << "  --chunks LIST        bytes per DPU, rounded up to 8\n"
+            << "  --dpus LIST          DPU counts to allocate with dpu_alloc\n"
+            << "  --ranks LIST         rank counts to allocate with dpu_alloc_ranks (all their DPUs are used)\n"
+            << "  --host-offsets LIST  misalignment of the host buffer in bytes\n"
+            << "  --modes LIST         sync,async (gather and copy_from are always sync)\n"
+            << "  --iterations N       timed iterations per configuration\n"
+            << "  --warmup N           untimed iterations per configuration\n"
+            << "  --profile STR        dpu_alloc profile, e.g. backend=simulator\n"
+            << "  --format csv|json\n"
+            << "  --output PATH        default stdout\n";
+}
+
+std::vector<std::string> split(const std::string &list) {
+  std::vector<std::string> items;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (false == item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+template <typename T>
+std::vector<T> split_numbers(const std::string &list) {
+  std::vector<T> numbers;
+  for (auto &item : split(list)) {
+    numbers.push_back(static_cast<T>(strtoull(item.c_str(), nullptr, 10)));
+  }
+  return numbers;
+}
+
+bool parse(int argc, char **argv, Options &opts) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      usage(argv[0]);
+      std::exit(0);
+    }
+    if (i + 1 == argc) {
+      std::cerr << "Missing value for " << arg << "\n";
+      return false;
+    }
+    std::string value = argv[++i];
+    if (arg == "--ops") {
+      opts.ops = split(value);
+    } else if (arg == "--chunks") {
+      opts.chunks = split_numbers<size_t>(value);
+    } else if (arg == "--dpus") {
+      opts.dpus = split_numbers<uint32_t>(value);
+    } else if (arg == "--ranks") {
+      opts.ranks = split_numbers<uint32_t>(value);
+    } else if (arg == "--host-offsets") {
+      opts.host_offsets = split_numbers<size_t>(value);
+    } else if (arg == "--modes") {
+      opts.modes = split(value);
+    } else if (arg == "--iterations") {
+      opts.iterations = std::max(1u, static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10)));
+    } else if (arg == "--warmup") {
+      opts.warmup = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+    } else if (arg == "--profile") {
+      opts.profile = value;
+    } else if (arg == "--format") {
+      opts.format = value;
+    } else if (arg == "--output") {
+      opts.output = value;
+    } else {
+      std::cerr << "Unknown option " << arg << "\n";
+      return false;
+    }
+  }
+  return opts.format == "csv" || opts.format == "json";
+}
+
+double percentile(const std::vector<double> &sorted, double p) {
+  size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+class Bench {
+ public:
+  Bench(Kernel &kernel, uint32_t nr_ranks, const Options &opts) : kernel(kernel), nr_ranks(nr_ranks), opts(opts) {}
+
+  void run(std::vector<Result> &results) {
+    for (auto &op : opts.ops) {
+      for (auto chunk : opts.chunks) {
+        for (auto offset : opts.host_offsets) {
+          for (auto &mode : opts.modes) {
+            bool async = mode == "async";
+            if (async && (op == "gather" || op == "copy_from")) {
+              continue;
+            }
+            results.push_back(measure(op, alignUp(chunk, 8), offset, async));
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  // One transfer of chunk_size bytes to/from every DPU. Async ops are only queued here.
+  void transfer(const std::string &op, uint8_t *data, size_t chunk_size, bool async) {
+    auto set = kernel.get_dpu_set();
+    uint32_t nr_dpus = kernel.get_nr_dpus();
+    auto flags = async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT;
+    if (op == "scatter") {
+      transfer_chunks(set, nr_dpus, DPU_XFER_TO_DPU, flags, DPU_MRAM_HEAP_POINTER_NAME, 0, data, chunk_size,
+                      nr_dpus * chunk_size);
+    } else if (op == "broadcast") {
+      transfer_full(set, flags, DPU_MRAM_HEAP_POINTER_NAME, 0, data, chunk_size);
+    } else if (op == "gather") {
+      safe_gather(set, nr_dpus, DPU_MRAM_HEAP_POINTER_NAME, 0, data, chunk_size, nr_dpus * chunk_size);
+    } else if (op == "copy_from") {
+      dpu_set_t dpu;
+      uint32_t dpu_idx;
+      DPU_FOREACH(set, dpu, dpu_idx) {
+        if (dpu_idx == nr_dpus) {
+          break;
+        }
+        DPU_ASSERT(dpu_copy_from(dpu, DPU_MRAM_HEAP_POINTER_NAME, 0, data + dpu_idx * chunk_size, chunk_size));
+      }
+    }
+  }
+
+  Result measure(const std::string &op, size_t chunk_size, size_t host_offset, bool async) {
+    uint32_t nr_dpus = kernel.get_nr_dpus();
+    size_t size = nr_dpus * chunk_size;
+    std::vector<uint8_t> buffer(size + 128);
+    auto base = alignUp(reinterpret_cast<uintptr_t>(buffer.data()), 64) + host_offset % 64;
+    auto *data = reinterpret_cast<uint8_t *>(base);
+    for (size_t i = 0; i < size; i++) {
+      data[i] = static_cast<uint8_t>(i);
+    }
+
+    for (uint32_t i = 0; i < opts.warmup; i++) {
+      transfer(op, data, chunk_size, async);
+    }
+    kernel.sync();
+
+    // Async iterations are queued back to back, a sample is the average of the batch
+    std::vector<double> samples;
+    if (async) {
+      auto start = std::chrono::steady_clock::now();
+      for (uint32_t i = 0; i < opts.iterations; i++) {
+        transfer(op, data, chunk_size, true);
+      }
+      kernel.sync();
+      double total = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+      samples.assign(opts.iterations, total / opts.iterations);
+    } else {
+      for (uint32_t i = 0; i < opts.iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        transfer(op, data, chunk_size, false);
+        samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+      }
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double mean = 0;
+    for (auto s : samples) {
+      mean += s;
+    }
+    mean /= samples.size();
+
+    return Result{.op = op,
+                  .mode = async ? "async" : "sync",
+                  .nr_ranks = nr_ranks,
+                  .nr_dpus = nr_dpus,
+                  .chunk_size = chunk_size,
+                  .host_offset = host_offset,
+                  .iterations = opts.iterations,
+                  .gbps = size / mean / 1e3,
+                  .min_us = samples.front(),
+                  .p50_us = percentile(samples, 0.5),
+                  .p90_us = percentile(samples, 0.9),
+                  .p99_us = percentile(samples, 0.99),
+                  .max_us = samples.back()};
+  }
+
+  Kernel &kernel;
+  uint32_t nr_ranks;
+  const Options &opts;
+};
+
+// Any kernel with an MRAM heap does, nothing is launched
+void setup(Kernel &kernel, dpu_set_t set) {
+  uint32_t nr_dpus = 0;
+  DPU_ASSERT(dpu_get_nr_dpus(set, &nr_dpus));
+  kernel.set_dpu_set(set, nr_dpus);
+  kernel.load_program("gemv_f.kernel");
+}
+
+void write_csv(std::ostream &out, const std::vector<Result> &results) {
+  out << "op,mode,nr_ranks,nr_dpus,chunk_size,host_offset,iterations,gbps,min_us,p50_us,p90_us,p99_us,max_us\n";
+  for (auto &r : results) {
+    out << r.op << "," << r.mode << "," << r.nr_ranks << "," << r.nr_dpus << "," << r.chunk_size << ","
+        << r.host_offset << "," << r.iterations << "," << r.gbps << "," << r.min_us << "," << r.p50_us << ","
+        << r.p90_us << "," << r.p99_us << "," << r.max_us << "\n";
+  }
+}
+
+void write_json(std::ostream &out, const std::vector<Result> &results) {
+  out << "[\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    auto &r = results[i];
+    out << "  {\"op\": \"" << r.op << "\", \"mode\": \"" << r.mode << "\", \"nr_ranks\": " << r.nr_ranks
+        << ", \"nr_dpus\": " << r.nr_dpus << ", \"chunk_size\": " << r.chunk_size
+        << ", \"host_offset\": " << r.host_offset << ", \"iterations\": " << r.iterations
+        << ", \"gbps\": " << r.gbps << ", \"min_us\": " << r.min_us << ", \"p50_us\": " << r.p50_us
+        << ", \"p90_us\": " << r.p90_us << ", \"p99_us\": " << r.p99_us << ", \"max_us\": " << r.max_us << "}"
+        << (i + 1 == results.size() ? "\n" : ",\n");
+  }
+  out << "]\n";
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options opts;
+  if (false == parse(argc, argv, opts)) {
+    usage(argv[0]);
+    return 1;
+  }
+  const char *profile = opts.profile.empty() ? nullptr : opts.profile.c_str();
+
+  std::vector<Result> results;
+  for (auto nr_dpus : opts.dpus) {
+    dpu_set_t set;
+    if (dpu_alloc(nr_dpus, profile, &set) != DPU_OK) {
+      std::cerr << "Couldn't allocate nr_dpus=" << nr_dpus << ", skipping\n";
+      continue;
+    }
+    uint32_t nr_ranks = 0;
+    DPU_ASSERT(dpu_get_nr_ranks(set, &nr_ranks));
+    Kernel kernel;
+    setup(kernel, set);
+    Bench(kernel, nr_ranks, opts).run(results);
+  }
+  for (auto nr_ranks : opts.ranks) {
+    dpu_set_t set;
+    if (dpu_alloc_ranks(nr_ranks, profile, &set) != DPU_OK) {
+      std::cerr << "Couldn't allocate nr_ranks=" << nr_ranks << ", skipping\n";
+      continue;
+    }
+    Kernel kernel;
+    setup(kernel, set);
+    Bench(kernel, nr_ranks, opts).run(results);
+  }
+
+  std::ofstream file;
+  if (false == opts.output.empty()) {
+    file.open(opts.output);
+    if (false == file.is_open()) {
+      std::cerr << "Couldn't open " << opts.output << "\n";
+      return 1;
+    }
+  }
+  std::ostream &out = opts.output.empty() ? std::cout : file;
+  if (opts.format == "json") {
+    write_json(out, results);
+  } else {
+    write_csv(out, results);
+  }
+  return 0;
+}
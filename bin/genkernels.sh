@@ -0,0 +1,37 @@
+# Usage: genkernels.sh <header> <assembly> <kernel files...>
+# Emits an assembly file pulling every DPU kernel image in with .incbin, so the binaries are linked
+# as they are instead of being compiled from byte arrays, and a header with the table of them.
+
+header=$1
+asm=$2
+shift 2
+
+{
+    echo "    .section .rodata"
+    for file in "$@"; do
+        ident=pimblas_kernel_$(basename "$file" | sed 's/[^a-zA-Z0-9]/_/g')
+        echo "    .balign 8"
+        echo "    .globl ${ident}"
+        echo "    .hidden ${ident}"
+        echo "${ident}:"
+        echo "    .incbin \"${file}\""
+    done
+    echo "    .section .note.GNU-stack,\"\",@progbits"
+} > "$asm"
+
+{
+    echo "#pragma once"
+    echo "#include <stddef.h>"
+    echo "#include <stdint.h>"
+
+    entries=""
+    for file in "$@"; do
+        name=$(basename "$file")
+        ident=pimblas_kernel_$(echo "$name" | sed 's/[^a-zA-Z0-9]/_/g')
+        size=$(wc -c < "$file" | tr -d ' ')
+        echo "extern \"C\" const uint8_t ${ident}[];"
+        entries="$entries {\"$name\", ${ident}, ${size}},"
+    done
+
+    echo "#define _PIMBLAS_EMBEDDED_KERNELS_ $entries"
+} > "$header"
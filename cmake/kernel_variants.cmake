@@ -0,0 +1,47 @@
+# Compile time variants of the GEMV kernels. Every source is built once per block size, tasklet count
+# and row path as <kernel>_b<BLOCK_SIZE>_t<NR_TASKLETS>_<a|u>.kernel, a - ALIGNED_ROWS fast path, u - any row.
+# The host picks one of them with the table generated by gemv_variant_table below.
+
+set(GEMV_VARIANT_KERNELS gemv_f gemv_int8 gemv_int16 gemv_int32)
+# Block sizes in elements of A
+set(GEMV_VARIANT_BLOCKS_gemv_f 64 128 256 512)
+set(GEMV_VARIANT_BLOCKS_gemv_int8 256 512 1024 2048)
+set(GEMV_VARIANT_BLOCKS_gemv_int16 128 256 512 1024)
+set(GEMV_VARIANT_BLOCKS_gemv_int32 64 128 256 512)
+# Tasklet counts, ascending. Short shares of rows run on fewer tasklets (one pair of rows each),
+# the kernels themselves take any count from 1 to 24.
+set(GEMV_VARIANT_TASKLETS 4 8 16)
+set(GEMV_VARIANT_ROWS a u)
+
+set(GEMV_VARIANTS_CMAKE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+function(gemv_variant_name OUT KERNEL BLOCK TASKLETS ROWS)
+  set(${OUT} "${KERNEL}_b${BLOCK}_t${TASKLETS}_${ROWS}" PARENT_SCOPE)
+endfunction()
+
+# Names of all variant targets (without .kernel)
+function(gemv_variant_names OUT)
+  set(names "")
+  foreach(kernel ${GEMV_VARIANT_KERNELS})
+    foreach(block ${GEMV_VARIANT_BLOCKS_${kernel}})
+      foreach(tasklets ${GEMV_VARIANT_TASKLETS})
+        foreach(rows ${GEMV_VARIANT_ROWS})
+          gemv_variant_name(name ${kernel} ${block} ${tasklets} ${rows})
+          list(APPEND names ${name})
+        endforeach()
+      endforeach()
+    endforeach()
+  endforeach()
+  set(${OUT} ${names} PARENT_SCOPE)
+endfunction()
+
+# Header with the lists above for src/host/gemv_variants.cpp
+function(gemv_variant_table OUT_FILE)
+  set(GEMV_VARIANT_TABLES "")
+  foreach(kernel ${GEMV_VARIANT_KERNELS})
+    string(REPLACE ";" ", " blocks "${GEMV_VARIANT_BLOCKS_${kernel}}")
+    string(APPEND GEMV_VARIANT_TABLES "{\"${kernel}.kernel\", \"${kernel}\", {${blocks}}}, ")
+  endforeach()
+  string(REPLACE ";" ", " GEMV_VARIANT_TASKLET_LIST "${GEMV_VARIANT_TASKLETS}")
+  configure_file(${GEMV_VARIANTS_CMAKE_DIR}/gemv_variants_table.h.in ${OUT_FILE} @ONLY)
+endfunction()
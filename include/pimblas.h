@@ -29,6 +29,80 @@ int gemv_f(uint32_t m, uint32_t n, const float *A, const float *x, float *y, con
 
 int gemv_int32(uint32_t m, uint32_t n, const int *A, const int *x, int *y, const int *alpha, const int *beta);
 int gemv_int8(uint32_t m, uint32_t n, const int8_t *A, const int8_t *x, int *y, const int *alpha, const int *beta);
+int gemv_int16(uint32_t m, uint32_t n, const int16_t *A, const int16_t *x, int *y, const int *alpha, const int *beta);
+
+/* 16-bit floating point A and x (fp16 for hgemv, bfloat16 for gemv_bf16) as raw bits, float y.
+   Products are accumulated in float on DPUs, A takes half the MRAM and transfers of float A. */
+int gemv_bf16(uint32_t m, uint32_t n, const uint16_t *A, const uint16_t *x, float *y, const float *alpha,
+              const float *beta);
+int hgemv(uint32_t m, uint32_t n, const uint16_t *A, const uint16_t *x, float *y, const float *alpha,
+          const float *beta);
+
+/* 4-bit grouped quantized weights: every group_size (16 to 256, power of two) weights of a row share an fp16 scale
+   and, with zero_points, a zero point. pimblas_q4_pack quantizes row major m x n W into packed, which holds
+   pimblas_q4_size bytes. y = alpha * W * x + beta * y, float x is quantized to int8 on the host,
+   int8 x stands for x_scale * x. */
+size_t pimblas_q4_size(uint32_t m, uint32_t n, uint32_t group_size, int zero_points);
+int pimblas_q4_pack(uint32_t m, uint32_t n, const float *W, uint32_t group_size, int zero_points, uint8_t *packed);
+int gemv_q4_f(uint32_t m, uint32_t n, const uint8_t *A, uint32_t group_size, int zero_points, const float *x,
+              float *y, const float *alpha, const float *beta);
+int gemv_q4_int8(uint32_t m, uint32_t n, const uint8_t *A, uint32_t group_size, int zero_points, const int8_t *x,
+                 float x_scale, float *y, const float *alpha, const float *beta);
+
+/* Out of core GEMV for matrices bigger than MRAM of max_dpus DPUs (0 - every free DPU of the pool or a default).
+   A is streamed in row slabs, next slab uploads while the previous one computes. */
+int gemv_f_streaming(uint32_t m, uint32_t n, const float *A, const float *x, float *y, const float *alpha,
+                     const float *beta, uint32_t max_dpus);
+int gemv_int8_streaming(uint32_t m, uint32_t n, const int8_t *A, const int8_t *x, int *y, const int *alpha,
+                        const int *beta, uint32_t max_dpus);
+int gemv_int32_streaming(uint32_t m, uint32_t n, const int *A, const int *x, int *y, const int *alpha,
+                         const int *beta, uint32_t max_dpus);
+
+/* Weight resident GEMV: A is uploaded once, every execute only moves x and y */
+typedef enum pimblas_dtype { PIMBLAS_DTYPE_FLOAT = 0, PIMBLAS_DTYPE_INT8, PIMBLAS_DTYPE_INT32 } pimblas_dtype;
+typedef struct pimblas_gemv_plan pimblas_gemv_plan;
+
+/* A, x are of dtype, y, alpha and beta are float for PIMBLAS_DTYPE_FLOAT and int otherwise */
+pimblas_gemv_plan *pimblas_gemv_plan_create(uint32_t m, uint32_t n, const void *A, pimblas_dtype dtype);
+int pimblas_gemv_plan_execute(pimblas_gemv_plan *plan, const void *x, void *y, const void *alpha, const void *beta);
+void pimblas_gemv_plan_destroy(pimblas_gemv_plan *plan);
+
+/* Streams: ops enqueued on one stream run in order on a host worker thread,
+   ops on different streams run concurrently on disjoint DPU sets.
+   Scalars (m, n, k, alpha, beta) are copied at enqueue time, buffers must stay valid until the op completes. */
+typedef struct pimblas_stream pimblas_stream;
+typedef struct pimblas_event pimblas_event;
+
+pimblas_stream *pimblas_stream_create(void);
+void pimblas_stream_destroy(pimblas_stream *stream);
+/* Returns the first error of ops since the last synchronize */
+int pimblas_stream_synchronize(pimblas_stream *stream);
+/* Ops enqueued after this call wait until event completes */
+int pimblas_stream_wait_event(pimblas_stream *stream, pimblas_event *event);
+
+pimblas_event *pimblas_event_create(void);
+void pimblas_event_destroy(pimblas_event *event);
+int pimblas_event_record(pimblas_event *event, pimblas_stream *stream);
+int pimblas_event_wait(pimblas_event *event);
+/* 1 - completed, 0 - pending */
+int pimblas_event_query(pimblas_event *event);
+
+int gemv_f_async(pimblas_stream *stream, uint32_t m, uint32_t n, const float *A, const float *x, float *y,
+                 const float *alpha, const float *beta);
+int gemv_int8_async(pimblas_stream *stream, uint32_t m, uint32_t n, const int8_t *A, const int8_t *x, int *y,
+                    const int *alpha, const int *beta);
+int gemv_int32_async(pimblas_stream *stream, uint32_t m, uint32_t n, const int *A, const int *x, int *y,
+                     const int *alpha, const int *beta);
+int pimblas_gemv_plan_execute_async(pimblas_stream *stream, pimblas_gemv_plan *plan, const void *x, void *y,
+                                    const void *alpha, const void *beta);
+int gemm_row_maj_f_async(pimblas_stream *stream, const int *m, const int *n, const int *k, const float *alpha,
+                         const float *a, const float *b, const float *beta, float *c);
+int gemm_row_maj_int8_async(pimblas_stream *stream, const int *m, const int *n, const int *k, const int *alpha,
+                            const int8_t *a, const int8_t *b, const int *beta, int *c);
+int gemm_row_maj_int32_async(pimblas_stream *stream, const int *m, const int *n, const int *k, const int *alpha,
+                             const int32_t *a, const int32_t *b, const int *beta, int *c);
+int softmax_async(pimblas_stream *stream, const float *vec_in, float *vec_out, size_t size);
+int relu_f_async(pimblas_stream *stream, const float *input, float *output, size_t num_elem);
 
 int vector_add(const int *a_input_ptr, const int *b_input_ptr, size_t num_elem, int *output);
 void sgemm_wrapper(const char *transa, const char *transb, const int *m, const int *n, const int *k, const float *alpha,
@@ -39,8 +113,15 @@ void gemm_row_maj_f(const int *m, const int *n, const int *k, const float *alpha
                     const float *beta, float *c);
 void gemm_row_maj_int8(const int *m, const int *n, const int *k, const int *alpha, const int8_t *a, const int8_t *b,
                        const int *beta, int *c);
+void gemm_row_maj_int16(const int *m, const int *n, const int *k, const int *alpha, const int16_t *a, const int16_t *b,
+                        const int *beta, int *c);
 void gemm_row_maj_int32(const int *m, const int *n, const int *k, const int *alpha, const int32_t *a, const int32_t *b,
                         const int *beta, int *c);
+/* 16-bit floating point A and B as raw bits (see hgemv), float C */
+void gemm_row_maj_f16(const int *m, const int *n, const int *k, const float *alpha, const uint16_t *a,
+                      const uint16_t *b, const float *beta, float *c);
+void gemm_row_maj_bf16(const int *m, const int *n, const int *k, const float *alpha, const uint16_t *a,
+                       const uint16_t *b, const float *beta, float *c);
 
 int relu_f(const float *input, float *output, size_t num_elem);
 int vec_add_f(const float *input_a, const float *input_b, float *output, size_t size);
@@ -1,5 +1,7 @@
 #include "common.hpp"
 
+#include "dpu_pool.hpp"
+
 const char *pimblas_get_kernel_dir() {
   const char *p = std::getenv("PIMBLAS_KERNEL_DIR");
   if (p) {
@@ -20,9 +22,9 @@ char *pimblas_get_kernel_dir_concat_free(const char *name) {
 
 const char *pimblas_get_git_version() { return _PIMBLAS_GIT_VERSION_; }
 
-void pimblas_constructor() {}
+void pimblas_constructor() { DPUPool::instance().reserve_from_env(); }
 
-void pimblas_destructor() {}
+void pimblas_destructor() { DPUPool::instance().shutdown(); }
 
 #ifdef LOGGING
 namespace pimblas {
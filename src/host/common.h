@@ -11,6 +11,12 @@
 #define S2(x) S1(x)
 #define LOCATION __FILE__ ":" S2(__LINE__)
 
+// Allocate DPUs from the rank pool (falls back to dpu_alloc when the pool can't serve the request)
+int pimblas_dpu_alloc(uint32_t nr_dpus, struct dpu_set_t *set);
+void pimblas_dpu_free(struct dpu_set_t set);
+// Load a kernel by name, from the embedded image unless PIMBLAS_KERNEL_DIR is set or the image is missing
+dpu_error_t pimblas_dpu_load(struct dpu_set_t set, const char *name, struct dpu_program_t **program);
+
 #ifdef LOGGING
 void pimlog_redirect(int level, const char *file_line, const char *format, ...);
 
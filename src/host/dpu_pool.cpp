@@ -0,0 +1,202 @@
+#include "dpu_pool.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+DPUPool &DPUPool::instance() {
+  static DPUPool pool;
+  return pool;
+}
+
+DPUPool::~DPUPool() { shutdown(); }
+
+bool DPUPool::reserve(uint32_t nr_ranks) {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (reserved) {
+    show_warn("dpu_pool: Ranks are already reserved");
+    return false;
+  }
+
+  if (dpu_alloc_ranks(nr_ranks, nullptr, &pool_set) != DPU_OK) {
+    show_error("dpu_pool: Couldn't reserve nr_ranks=[{}]", nr_ranks);
+    return false;
+  }
+
+  dpu_set_t rank;
+  DPU_RANK_FOREACH(pool_set, rank) {
+    uint32_t nr_dpus = 0;
+    DPU_ASSERT(dpu_get_nr_dpus(rank, &nr_dpus));
+    slots.push_back(RankSlot{.rank = rank.list.ranks[0], .nr_dpus = nr_dpus, .leased = false, .program = ""});
+  }
+  reserved = true;
+
+  show_info("dpu_pool: Reserved nr_ranks=[{}]", slots.size());
+  return true;
+}
+
+void DPUPool::reserve_from_env() {
+  const char *env = std::getenv("PIMBLAS_POOL_RANKS");
+  if (env == nullptr) {
+    return;
+  }
+
+  uint32_t nr_ranks = DPU_ALLOCATE_ALL;
+  if (strcmp(env, "all") != 0) {
+    nr_ranks = static_cast<uint32_t>(strtoul(env, nullptr, 10));
+  }
+
+  if (nr_ranks == 0) {
+    return;
+  }
+  reserve(nr_ranks);
+}
+
+void DPUPool::shutdown() {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (!reserved) {
+    return;
+  }
+
+  if (!leases.empty()) {
+    show_warn("dpu_pool: Freeing pool with {} outstanding leases", leases.size());
+  }
+
+  for (auto &l : leases) {
+    delete[] l.ranks;
+  }
+  leases.clear();
+  slots.clear();
+  dpu_free(pool_set);
+  pool_set = dpu_set_t{};
+  reserved = false;
+}
+
+bool DPUPool::enabled() {
+  std::lock_guard<std::mutex> lock(mtx);
+  return reserved;
+}
+
+uint32_t DPUPool::get_nr_free_dpus() {
+  std::lock_guard<std::mutex> lock(mtx);
+  uint32_t nr_free = 0;
+  for (auto &slot : slots) {
+    if (!slot.leased) {
+      nr_free += slot.nr_dpus;
+    }
+  }
+  return nr_free;
+}
+
+uint32_t DPUPool::get_min_rank_dpus() {
+  std::lock_guard<std::mutex> lock(mtx);
+  uint32_t min_dpus = 0;
+  for (auto &slot : slots) {
+    if (min_dpus == 0 || slot.nr_dpus < min_dpus) {
+      min_dpus = slot.nr_dpus;
+    }
+  }
+  return min_dpus;
+}
+
+bool DPUPool::lease(uint32_t nr_dpus, dpu_set_t &set) {
+  std::lock_guard<std::mutex> lock(mtx);
+  if (!reserved) {
+    return false;
+  }
+
+  Lease l;
+  uint32_t nr_leased = 0;
+  for (size_t i = 0; i < slots.size() && nr_leased < nr_dpus; i++) {
+    if (!slots[i].leased) {
+      l.slots.push_back(i);
+      nr_leased += slots[i].nr_dpus;
+    }
+  }
+
+  if (nr_leased < nr_dpus) {
+    show_debug("dpu_pool: Not enough free ranks for nr_dpus=[{}] free=[{}]", nr_dpus, nr_leased);
+    return false;
+  }
+
+  l.ranks = new dpu_rank_t *[l.slots.size()];
+  for (size_t i = 0; i < l.slots.size(); i++) {
+    slots[l.slots[i]].leased = true;
+    l.ranks[i] = slots[l.slots[i]].rank;
+  }
+
+  set = dpu_set_t{};
+  set.kind = DPU_SET_RANKS;
+  set.list.nr_ranks = static_cast<uint32_t>(l.slots.size());
+  set.list.ranks = l.ranks;
+  leases.push_back(std::move(l));
+
+  show_trace("dpu_pool: Leased nr_ranks=[{}] for nr_dpus=[{}]", set.list.nr_ranks, nr_dpus);
+  return true;
+}
+
+bool DPUPool::release(dpu_set_t &set) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto it = find_lease(set);
+  if (it == leases.end()) {
+    return false;
+  }
+
+  for (auto slot : it->slots) {
+    slots[slot].leased = false;
+  }
+  delete[] it->ranks;
+  leases.erase(it);
+  set = dpu_set_t{};
+  return true;
+}
+
+bool DPUPool::has_program(const dpu_set_t &set, const char *name) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto it = find_lease(set);
+  if (it == leases.end()) {
+    return false;
+  }
+
+  for (auto slot : it->slots) {
+    if (slots[slot].program != name) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DPUPool::set_program(const dpu_set_t &set, const char *name) {
+  std::lock_guard<std::mutex> lock(mtx);
+  auto it = find_lease(set);
+  if (it == leases.end()) {
+    return;
+  }
+
+  for (auto slot : it->slots) {
+    slots[slot].program = name;
+  }
+}
+
+std::vector<DPUPool::Lease>::iterator DPUPool::find_lease(const dpu_set_t &set) {
+  if (set.kind != DPU_SET_RANKS || set.list.ranks == nullptr) {
+    return leases.end();
+  }
+  return std::find_if(leases.begin(), leases.end(), [&set](const Lease &l) { return l.ranks == set.list.ranks; });
+}
+
+extern "C" {
+int pimblas_dpu_alloc(uint32_t nr_dpus, dpu_set_t *set) {
+  if (DPUPool::instance().lease(nr_dpus, *set)) {
+    return 0;
+  }
+  return dpu_alloc(nr_dpus, nullptr, set) == DPU_OK ? 0 : -1;
+}
+
+void pimblas_dpu_free(dpu_set_t set) {
+  // Programs loaded outside of Kernel::load_program aren't tracked, the next lease has to load its own
+  DPUPool::instance().set_program(set, "");
+  if (false == DPUPool::instance().release(set)) {
+    DPU_ASSERT(dpu_free(set));
+  }
+}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+
+// Process wide pool of DPU ranks.
+// Ranks are reserved once (see PIMBLAS_POOL_RANKS) and leased to kernels in whole rank units.
+// A leased set can hold more DPUs than requested, users must only touch the first nr_dpus DPUs of it.
+// Launches still run every DPU of the set, Kernel::launch sets dpu_idle on the spares (see dpu_idle.h).
+class DPUPool {
+ public:
+  static DPUPool &instance();
+
+  ~DPUPool();
+
+  DPUPool(const DPUPool &) = delete;
+  DPUPool &operator=(const DPUPool &) = delete;
+
+  // Reserve nr_ranks ranks (DPU_ALLOCATE_ALL for every free rank in the system)
+  bool reserve(uint32_t nr_ranks);
+  void reserve_from_env();
+  void shutdown();
+
+  bool enabled();
+  uint32_t get_nr_free_dpus();
+  // Fewest functional DPUs of a reserved rank, 0 if no ranks are reserved
+  uint32_t get_min_rank_dpus();
+
+  // Lease ranks holding at least nr_dpus DPUs, returns false if the pool can't serve the request.
+  bool lease(uint32_t nr_dpus, dpu_set_t &set);
+  // Give leased ranks back, returns false if set is not a lease of this pool.
+  bool release(dpu_set_t &set);
+
+  // Leased ranks keep their program between leases, so a kernel can skip dpu_load
+  // when every rank of its lease already holds the right program.
+  bool has_program(const dpu_set_t &set, const char *name);
+  void set_program(const dpu_set_t &set, const char *name);
+
+ private:
+  DPUPool() = default;
+
+  struct RankSlot {
+    dpu_rank_t *rank;
+    uint32_t nr_dpus;
+    bool leased;
+    std::string program;
+  };
+
+  struct Lease {
+    dpu_rank_t **ranks;
+    std::vector<size_t> slots;
+  };
+
+  std::mutex mtx;
+  bool reserved = false;
+  dpu_set_t pool_set{};
+  std::vector<RankSlot> slots;
+  std::vector<Lease> leases;
+
+  std::vector<Lease>::iterator find_lease(const dpu_set_t &set);
+};
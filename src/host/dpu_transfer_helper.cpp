@@ -1,29 +1,53 @@
 #include "dpu_transfer_helper.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 #include "common.hpp"
+#include "dpu_pool.hpp"
+#include "staging_pool.hpp"
+
+uint32_t get_dpus_per_rank() {
+  static const uint32_t dpus_per_rank = []() -> uint32_t {
+    uint32_t nr_dpus = DPUPool::instance().get_min_rank_dpus();
+    if (nr_dpus != 0) {
+      return nr_dpus;
+    }
+
+    dpu_set_t rank;
+    if (dpu_alloc_ranks(1, nullptr, &rank) != DPU_OK) {
+      show_warn("Couldn't allocate a rank to count its DPUs, assuming {}", DPUS_PER_RANK);
+      return DPUS_PER_RANK;
+    }
+    DPU_ASSERT(dpu_get_nr_dpus(rank, &nr_dpus));
+    DPU_ASSERT(dpu_free(rank));
+    show_debug("Measured dpus_per_rank=[{}]", nr_dpus);
+    return nr_dpus;
+  }();
+  return dpus_per_rank;
+}
 
 template <typename T>
-void gemv_launch_statistics(uint32_t m, uint32_t n, uint32_t &numDPUs, uint32_t &rowsPerDPU) {
+uint32_t gemv_launch_statistics(uint32_t m, uint32_t n, uint32_t &numDPUs, uint32_t &rowsPerDPU, uint32_t dpus_per_rank,
+                                uint32_t min_tasklets) {
   // Assumptions:
   // MRAM size of each DPU is 64MB
   // part of A needs to be copied to each DPU - n * rows_per_dpu
   // x vector needs to be copied to each DPU - n
   // part of y vector needs to be copied to each DPU - rows_per_dpu
   // Total ints per DPU: n * (rows_per_dpu + 1) + rows_per_dpu
-  // Threads per DPU: 16
+  // Threads per DPU: at least min_tasklets
   // At minimum two rows per tasklet when sizeof(T) == 4 (because the output needs to be 8B aligned)
-  constexpr size_t minRowsPerDPU = 16 * 8 / sizeof(T);
+  const uint32_t minRowsPerDPU = min_tasklets * 8 / sizeof(T);
 
   rowsPerDPU = alignUp((m - 1) / numDPUs + 1, minRowsPerDPU);
-  size_t memory_requirement = (n * (rowsPerDPU + 1) + rowsPerDPU) * sizeof(T);
+  size_t memory_requirement = (static_cast<size_t>(n) * (rowsPerDPU + 1) + rowsPerDPU) * sizeof(T);
 
   // Let's leave 1 MB
   constexpr size_t mem_cap = 63 * 1024 * 1024;
   while (memory_requirement > mem_cap) {
     rowsPerDPU -= minRowsPerDPU;
-    memory_requirement = n * (rowsPerDPU + 1) + rowsPerDPU;
+    memory_requirement = (static_cast<size_t>(n) * (rowsPerDPU + 1) + rowsPerDPU) * sizeof(T);
   }
 
   if (rowsPerDPU < minRowsPerDPU) {
@@ -31,43 +55,175 @@ void gemv_launch_statistics(uint32_t m, uint32_t n, uint32_t &numDPUs, uint32_t
   }
 
   numDPUs = (m - 1) / rowsPerDPU + 1;
+
+  // Transfers are issued rank by rank, so a partially used rank costs as much as a full one.
+  // Spread the rows over every DPU of the ranks we are going to use anyway.
+  uint32_t nr_ranks = (numDPUs - 1) / dpus_per_rank + 1;
+  uint32_t rankRowsPerDPU = alignUp((m - 1) / (nr_ranks * dpus_per_rank) + 1, minRowsPerDPU);
+  if (rankRowsPerDPU < rowsPerDPU) {
+    rowsPerDPU = rankRowsPerDPU;
+    numDPUs = (m - 1) / rowsPerDPU + 1;
+  }
+  return minRowsPerDPU;
 }
 
 // Instantiation
-template void gemv_launch_statistics<int8_t>(uint32_t m, uint32_t n, uint32_t &numDPUs, uint32_t &rowsPerDPU);
-template void gemv_launch_statistics<int>(uint32_t m, uint32_t n, uint32_t &numDPUs, uint32_t &rowsPerDPU);
-template void gemv_launch_statistics<float>(uint32_t m, uint32_t n, uint32_t &numDPUs, uint32_t &rowsPerDPU);
+template uint32_t gemv_launch_statistics<int8_t>(uint32_t m, uint32_t n, uint32_t &numDPUs, uint32_t &rowsPerDPU,
+                                                 uint32_t dpus_per_rank, uint32_t min_tasklets);
+template uint32_t gemv_launch_statistics<int>(uint32_t m, uint32_t n, uint32_t &numDPUs, uint32_t &rowsPerDPU,
+                                              uint32_t dpus_per_rank, uint32_t min_tasklets);
+template uint32_t gemv_launch_statistics<float>(uint32_t m, uint32_t n, uint32_t &numDPUs, uint32_t &rowsPerDPU,
+                                                uint32_t dpus_per_rank, uint32_t min_tasklets);
+
+RowPartition balance_rows(uint32_t m, uint32_t nr_dpus, uint32_t row_alignment) {
+  uint32_t nr_units = (m - 1) / row_alignment + 1;
+  nr_dpus = std::min(nr_dpus, nr_units);
+  uint32_t max_units = (nr_units - 1) / nr_dpus + 1;
+  return RowPartition{
+      .m = m, .nr_dpus = nr_dpus, .rows_per_dpu = max_units * row_alignment, .row_alignment = row_alignment};
+}
+
+uint32_t RowPartition::first_row(uint32_t dpu_idx) const {
+  uint32_t nr_units = (m - 1) / row_alignment + 1;
+  uint32_t extra_units = nr_units % nr_dpus;
+  return (dpu_idx * (nr_units / nr_dpus) + std::min(dpu_idx, extra_units)) * row_alignment;
+}
+
+uint32_t RowPartition::nr_rows(uint32_t dpu_idx) const {
+  uint32_t nr_units = (m - 1) / row_alignment + 1;
+  uint32_t extra_units = nr_units % nr_dpus;
+  return (nr_units / nr_dpus + (dpu_idx < extra_units ? 1 : 0)) * row_alignment;
+}
+
+template <typename T>
+GEMVPartition plan_gemv_partition(uint32_t m, uint32_t n, uint32_t max_dpus, uint32_t dpus_per_rank) {
+  GEMVPartition part{.grid_rows = max_dpus, .grid_cols = 1, .rows_per_dpu = 0, .cols_per_dpu = n};
+  gemv_launch_statistics<T>(m, n, part.grid_rows, part.rows_per_dpu, dpus_per_rank);
+
+  // Rows keep at least half of the DPUs busy (or don't even fit), columns stay whole
+  uint32_t grid_cols = std::min(max_dpus / part.grid_rows, n / GEMV_MIN_COLS_PER_DPU);
+  if (part.grid_rows * 2 > max_dpus || grid_cols < 2) {
+    // Plain row split, short shares of rows run on fewer tasklets instead of being padded for all of them
+    part.grid_rows = max_dpus;
+    gemv_launch_statistics<T>(m, n, part.grid_rows, part.rows_per_dpu, dpus_per_rank, 1);
+    return part;
+  }
+  part.cols_per_dpu = alignUp((n - 1) / grid_cols + 1, 8);
+  part.grid_cols = (n - 1) / part.cols_per_dpu + 1;
+  return part;
+}
+
+template GEMVPartition plan_gemv_partition<int8_t>(uint32_t m, uint32_t n, uint32_t max_dpus, uint32_t dpus_per_rank);
+template GEMVPartition plan_gemv_partition<int>(uint32_t m, uint32_t n, uint32_t max_dpus, uint32_t dpus_per_rank);
+template GEMVPartition plan_gemv_partition<float>(uint32_t m, uint32_t n, uint32_t max_dpus, uint32_t dpus_per_rank);
 
 size_t safe_gather(dpu_set_t set, uint32_t nr_dpus, const char *symbol_name, size_t symbol_offset, uint8_t *data,
-                   size_t chunk_size, size_t size) {
-  bool has_remainder = (size < chunk_size) || (size % chunk_size != 0);
-
-  dpu_set_t dpu;
-  uint32_t dpu_idx;
-  DPU_FOREACH(set, dpu, dpu_idx) {
-    auto offset = dpu_idx * chunk_size;
-    if (false == (has_remainder && dpu_idx + 1 == nr_dpus)) {
-      DPU_ASSERT(dpu_prepare_xfer(dpu, (void *)&data[offset]));
+                   size_t chunk_size, size_t size, RankTimer *timer) {
+  // Whole 8B aligned chunks go straight into data, the rest (a short last chunk, or every chunk
+  // when a window would spill into the next one) is gathered into pooled staging by the same push.
+  size_t window_size = alignUp(chunk_size, 8);
+  uint32_t nr_parts = std::min<size_t>(nr_dpus, (size - 1) / chunk_size + 1);
+  uint32_t first_staged = (chunk_size == window_size) ? size / chunk_size : 0;
+  first_staged = std::min(first_staged, nr_parts);
+  auto staging = StagingPool::instance().acquire((nr_parts - first_staged) * window_size);
+
+  dpu_set_t rank, dpu;
+  uint32_t rank_idx;
+  uint32_t dpu_idx = 0;
+  DPU_RANK_FOREACH(set, rank, rank_idx) {
+    if (dpu_idx >= nr_parts) {
+      break;
+    }
+    uint32_t rank_dpus = 0;
+    DPU_FOREACH(rank, dpu) {
+      if (dpu_idx >= nr_parts) {
+        break;
+      }
+      uint8_t *dst = dpu_idx < first_staged ? &data[dpu_idx * chunk_size]
+                                            : staging.data() + (dpu_idx - first_staged) * window_size;
+      DPU_ASSERT(dpu_prepare_xfer(dpu, (void *)dst));
+      rank_dpus++;
+      dpu_idx++;
+    }
+
+    if (timer) {
+      timer->start(rank, rank_idx);
+    }
+    DPU_ASSERT(dpu_push_xfer(rank, DPU_XFER_FROM_DPU, symbol_name, symbol_offset, window_size, DPU_XFER_ASYNC));
+    if (timer) {
+      timer->stop(rank, rank_idx, rank_dpus, rank_dpus * window_size);
     }
   }
-  DPU_ASSERT(dpu_push_xfer(set, DPU_XFER_FROM_DPU, symbol_name, symbol_offset, chunk_size, DPU_XFER_DEFAULT));
-
-  if (has_remainder) {
-    auto offset = (nr_dpus - 1) * chunk_size;
-    auto remainder = size - offset;
-    auto transfer_size = alignDown(remainder, 8);
-    auto missing_size = remainder - transfer_size;
-
-    DPU_ASSERT(dpu_prepare_xfer(dpu, (void *)&data[offset]));
-    DPU_ASSERT(dpu_push_xfer(dpu, DPU_XFER_FROM_DPU, symbol_name, symbol_offset, transfer_size, DPU_XFER_DEFAULT));
-
-    if (missing_size > 0) {
-      uint8_t tmp_buffer[8];
-      auto last_read = &data[offset + transfer_size];
-      DPU_ASSERT(dpu_copy_from(dpu, symbol_name, symbol_offset + transfer_size, (void *)tmp_buffer, 8));
-      memcpy(last_read, tmp_buffer, missing_size);
+  DPU_ASSERT(dpu_sync(set));
+
+  if (first_staged < nr_parts) {
+    size_t offset = first_staged * chunk_size;
+    if (chunk_size == window_size) {
+      // Staged chunks are contiguous, a single copy fills the tail
+      memcpy(&data[offset], staging.data(), size - offset);
+    } else {
+      for (uint32_t i = first_staged; i < nr_parts; i++) {
+        size_t begin = i * chunk_size;
+        memcpy(&data[begin], staging.data() + (i - first_staged) * window_size, std::min(chunk_size, size - begin));
+      }
     }
   }
 
-  return symbol_offset + alignUp(chunk_size, 8);
+  return symbol_offset + window_size;
+}
+
+void RankTimer::start(dpu_set_t rank, uint32_t rank_idx) {
+  auto *ctx = new Context{.timer = this, .rank_idx = rank_idx, .nr_dpus = 0, .bytes = 0};
+  DPU_ASSERT(dpu_callback(rank, on_start, ctx, DPU_CALLBACK_ASYNC));
+}
+
+void RankTimer::stop(dpu_set_t rank, uint32_t rank_idx, uint32_t nr_dpus, size_t bytes) {
+  auto *ctx = new Context{.timer = this, .rank_idx = rank_idx, .nr_dpus = nr_dpus, .bytes = bytes};
+  DPU_ASSERT(dpu_callback(rank, on_stop, ctx, DPU_CALLBACK_ASYNC));
+}
+
+dpu_error_t RankTimer::on_start(dpu_set_t /*rank*/, uint32_t /*rank_id*/, void *arg) {
+  auto *ctx = reinterpret_cast<Context *>(arg);
+  {
+    std::lock_guard<std::mutex> lock(ctx->timer->mtx);
+    ctx->timer->get_slot(ctx->rank_idx).started = std::chrono::steady_clock::now();
+  }
+  delete ctx;
+  return DPU_OK;
+}
+
+dpu_error_t RankTimer::on_stop(dpu_set_t /*rank*/, uint32_t /*rank_id*/, void *arg) {
+  auto *ctx = reinterpret_cast<Context *>(arg);
+  auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(ctx->timer->mtx);
+    auto &slot = ctx->timer->get_slot(ctx->rank_idx);
+    slot.stats.nr_dpus = std::max(slot.stats.nr_dpus, ctx->nr_dpus);
+    slot.stats.nr_transfers++;
+    slot.stats.bytes += ctx->bytes;
+    slot.stats.seconds += std::chrono::duration<double>(now - slot.started).count();
+  }
+  delete ctx;
+  return DPU_OK;
+}
+
+RankTimer::Slot &RankTimer::get_slot(uint32_t rank_idx) {
+  if (rank_idx >= slots.size()) {
+    slots.resize(rank_idx + 1, Slot{.started = {}, .stats = {}});
+  }
+  return slots[rank_idx];
+}
+
+std::vector<RankTransferStats> RankTimer::get_stats() {
+  std::lock_guard<std::mutex> lock(mtx);
+  std::vector<RankTransferStats> stats;
+  for (auto &slot : slots) {
+    stats.push_back(slot.stats);
+  }
+  return stats;
+}
+
+void RankTimer::reset() {
+  std::lock_guard<std::mutex> lock(mtx);
+  slots.clear();
 }
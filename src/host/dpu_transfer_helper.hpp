@@ -1,9 +1,59 @@
 #pragma once
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 
 #include "common.hpp"
 
+// Number of DPUs in a fully functional rank, used when no rank can be measured
+constexpr uint32_t DPUS_PER_RANK = 64;
+
+// Functional DPUs per rank, work is assigned in these units. Measured once, on the ranks reserved by
+// DPUPool or, without a pool, on a rank allocated just for that. Ranks with disabled DPUs count the
+// fewest of them, so a planned rank never needs more DPUs than the system has in one.
+uint32_t get_dpus_per_rank();
+
+struct RankTransferStats {
+  uint32_t nr_dpus;
+  uint32_t nr_transfers;
+  size_t bytes;
+  double seconds;
+};
+
+// Measures transfers rank by rank. Every rank executes its queue on its own thread, so
+// start/stop are stamped by callbacks queued around the transfer on that rank.
+class RankTimer {
+ public:
+  void start(dpu_set_t rank, uint32_t rank_idx);
+  void stop(dpu_set_t rank, uint32_t rank_idx, uint32_t nr_dpus, size_t bytes);
+
+  // Results are complete once the DPU set is synchronized
+  std::vector<RankTransferStats> get_stats();
+  void reset();
+
+ private:
+  struct Slot {
+    std::chrono::steady_clock::time_point started;
+    RankTransferStats stats;
+  };
+
+  struct Context {
+    RankTimer *timer;
+    uint32_t rank_idx;
+    uint32_t nr_dpus;
+    size_t bytes;
+  };
+
+  static dpu_error_t on_start(dpu_set_t rank, uint32_t rank_id, void *arg);
+  static dpu_error_t on_stop(dpu_set_t rank, uint32_t rank_id, void *arg);
+
+  Slot &get_slot(uint32_t rank_idx);
+
+  std::mutex mtx;
+  std::vector<Slot> slots;
+};
+
 template <typename T>
 T alignUp(T value, size_t alignment) {
   return (value + alignment - 1) & ~(alignment - 1);
@@ -14,39 +64,107 @@ T alignDown(T value, size_t alignment) {
   return value & ~(alignment - 1);
 }
 
+// Chunks are pushed rank by rank with DPU_XFER_ASYNC, so every rank moves its part of data
+// on its own thread and a partially used rank doesn't gate the others.
 template <typename T>
 size_t transfer_chunks(dpu_set_t set, uint32_t nr_dpus, dpu_xfer_t xfer, dpu_xfer_flags_t flags,
-                       const char *symbol_name, size_t sym_offset, T *data, size_t chunk_size, size_t size) {
+                       const char *symbol_name, size_t sym_offset, T *data, size_t chunk_size, size_t size,
+                       RankTimer *timer = nullptr) {
   bool has_remainder = size % chunk_size != 0;
 
-  dpu_set_t dpu;
-  uint32_t dpu_idx;
-  DPU_FOREACH(set, dpu, dpu_idx) {
-    auto offset = dpu_idx * chunk_size;
-    if (false == (has_remainder && dpu_idx + 1 == nr_dpus)) {
-      DPU_ASSERT(dpu_prepare_xfer(dpu, (void *)&data[offset]));
+  // Leased sets can hold more DPUs than nr_dpus, the rest is left untouched
+  dpu_set_t rank, dpu, last_dpu;
+  uint32_t rank_idx;
+  uint32_t dpu_idx = 0;
+  DPU_RANK_FOREACH(set, rank, rank_idx) {
+    if (dpu_idx == nr_dpus) {
+      break;
+    }
+    uint32_t rank_dpus = 0;
+    DPU_FOREACH(rank, dpu) {
+      if (dpu_idx == nr_dpus) {
+        break;
+      }
+      last_dpu = dpu;
+      auto offset = dpu_idx * chunk_size;
+      if (false == (has_remainder && dpu_idx + 1 == nr_dpus)) {
+        DPU_ASSERT(dpu_prepare_xfer(dpu, (void *)&data[offset]));
+        rank_dpus++;
+      }
+      dpu_idx++;
+    }
+
+    if (rank_dpus == 0) {
+      continue;
+    }
+    if (timer) {
+      timer->start(rank, rank_idx);
+    }
+    DPU_ASSERT(dpu_push_xfer(rank, xfer, symbol_name, sym_offset, chunk_size * sizeof(T), DPU_XFER_ASYNC));
+    if (timer) {
+      timer->stop(rank, rank_idx, rank_dpus, rank_dpus * chunk_size * sizeof(T));
     }
   }
-  DPU_ASSERT(dpu_push_xfer(set, xfer, symbol_name, sym_offset, chunk_size * sizeof(T), flags));
 
   if (has_remainder) {
     auto offset = (nr_dpus - 1) * chunk_size;
     auto remainder = size - offset;
-    DPU_ASSERT(dpu_prepare_xfer(dpu, (void *)&data[offset]));
-    DPU_ASSERT(dpu_push_xfer(dpu, xfer, symbol_name, sym_offset, alignUp(remainder * sizeof(T), 8), flags));
+    DPU_ASSERT(dpu_prepare_xfer(last_dpu, (void *)&data[offset]));
+    DPU_ASSERT(
+        dpu_push_xfer(last_dpu, xfer, symbol_name, sym_offset, alignUp(remainder * sizeof(T), 8), DPU_XFER_ASYNC));
+  }
+
+  if (flags != DPU_XFER_ASYNC) {
+    DPU_ASSERT(dpu_sync(set));
   }
 
   return sym_offset + alignUp(chunk_size * sizeof(T), 8);
 }
 
+// Row split where shares of DPUs differ by at most row_alignment rows, the first DPUs take the extra rows.
+// rows_per_dpu is reserved in MRAM of every DPU, so offsets are the same everywhere; it's at least the largest share.
+struct RowPartition {
+  uint32_t m;
+  uint32_t nr_dpus;
+  uint32_t rows_per_dpu;
+  uint32_t row_alignment;
+
+  uint32_t first_row(uint32_t dpu_idx) const;
+  // Rows computed by the DPU, padded to row_alignment - the last DPU can run past m
+  uint32_t nr_rows(uint32_t dpu_idx) const;
+};
+
+// Spreads m rows over at most nr_dpus DPUs in units of row_alignment rows
+RowPartition balance_rows(uint32_t m, uint32_t nr_dpus, uint32_t row_alignment);
+
+// Gathers chunk_size bytes from every DPU into data (size bytes) with a single push per rank and never
+// writes past data. Aligned chunks land in place, unaligned or short ones go through a StagingPool
+// buffer and are copied out after dpu_sync. Always synchronous.
 size_t safe_gather(dpu_set_t set, uint32_t nr_dpus, const char *symbol_name, size_t symbol_offset, uint8_t *data,
-                   size_t chunk_size, size_t size);
+                   size_t chunk_size, size_t size, RankTimer *timer = nullptr);
 
+// Broadcast is issued per rank for the same reason as in transfer_chunks
 template <typename T>
 size_t transfer_full(dpu_set_t set, dpu_xfer_flags_t flags, const char *symbol_name, size_t sym_offset, T *data,
-                     size_t size) {
+                     size_t size, RankTimer *timer = nullptr) {
   size_t copySize = alignUp(size * sizeof(T), 8);
-  DPU_ASSERT(dpu_broadcast_to(set, symbol_name, sym_offset, data, copySize, flags));
+  dpu_set_t rank;
+  uint32_t rank_idx;
+  DPU_RANK_FOREACH(set, rank, rank_idx) {
+    if (timer) {
+      timer->start(rank, rank_idx);
+    }
+    DPU_ASSERT(dpu_broadcast_to(rank, symbol_name, sym_offset, data, copySize, DPU_XFER_ASYNC));
+    if (timer) {
+      uint32_t rank_dpus = 0;
+      DPU_ASSERT(dpu_get_nr_dpus(rank, &rank_dpus));
+      timer->stop(rank, rank_idx, rank_dpus, rank_dpus * copySize);
+    }
+  }
+
+  if (flags != DPU_XFER_ASYNC) {
+    DPU_ASSERT(dpu_sync(set));
+  }
   return sym_offset + copySize;
 }
 
@@ -57,5 +175,32 @@ size_t transfer_full_exact(dpu_set_t set, dpu_xfer_flags_t flags, const char *sy
   return sym_offset + size;
 }
 
+// numDPUs is rounded up to whole ranks (dpus_per_rank DPUs each) and rows are spread evenly over them.
+// rowsPerDPU is bounded by MRAM size, numDPUs is not - see gemv_streaming for matrices that don't fit.
+// rowsPerDPU is a multiple of min_tasklets 8B outputs. Kernels with a fixed tasklet count keep the default,
+// GEMV variants pick their tasklets from the share (see select_gemv_program) and pass 1, so short matrices
+// spread over more DPUs instead of being padded for 16 tasklets.
+// n is the row size in T words. Returns that alignment of rowsPerDPU, in rows.
+template <typename T>
+uint32_t gemv_launch_statistics(uint32_t m, uint32_t n, uint32_t &numDPUs, uint32_t &rowsPerDPU, uint32_t dpus_per_rank,
+                                uint32_t min_tasklets = 16);
+
+// Split of GEMV work over a grid_rows x grid_cols grid of DPUs, DPU (r, c) is r * grid_cols + c.
+// grid_cols == 1 is the plain row split, grid_cols > 1 leaves partial sums of y to be reduced.
+struct GEMVPartition {
+  uint32_t grid_rows;
+  uint32_t grid_cols;
+  uint32_t rows_per_dpu;
+  uint32_t cols_per_dpu;
+
+  uint32_t nr_dpus() const { return grid_rows * grid_cols; }
+};
+
+// Column slices are never shorter than this, below it the reduction costs more than the split saves
+constexpr uint32_t GEMV_MIN_COLS_PER_DPU = 1024;
+
+// Picks row split, column split or a 2D grid for m x n GEMV on at most max_dpus DPUs.
+// Rows are split as in gemv_launch_statistics, DPUs left idle by short matrices split the columns.
+// cols_per_dpu is a multiple of 8, so a row of any element type is 8B aligned in MRAM.
 template <typename T>
-void gemv_launch_statistics(uint32_t m, uint32_t n, uint32_t &numDPUs, uint32_t &rowsPerDPU);
\ No newline at end of file
+GEMVPartition plan_gemv_partition(uint32_t m, uint32_t n, uint32_t max_dpus, uint32_t dpus_per_rank);
\ No newline at end of file
@@ -1,12 +1,19 @@
-#include <cassert>
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 #include <iomanip>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 
 #include "dpu_transfer_helper.hpp"
-#include "gemv_kernel.hpp"
+#include "gemm_kernel.hpp"
+#include "gemv_multi_kernel.hpp"
 #include "matrix_transpose.hpp"
+#include "worker_pool.hpp"
 
 template <typename T>
 void print_matrix_row_major(const T *mat, size_t rows, size_t cols) {
@@ -49,48 +56,85 @@ struct SCS {  // Single Column Solver
   SCS() : column(-1) { kernel = std::unique_ptr<Kernel>(new Kernel()); }
   std::unique_ptr<Kernel> kernel;
   int column = -1;
+  uint32_t nr_columns = 0;
 };
 
 template <class Kernel>
 class MCS {  // Multi Column Solver
   using SCSVecT = std::vector<SCS<Kernel>>;
-  using iter = typename SCSVecT::iterator;
 
  public:
-  MCS(size_t nr_solvers) : solvers(nr_solvers) { it = solvers.begin(); }
+  MCS(size_t nr_solvers) : solvers(nr_solvers) {}
 
   SCSVecT &get_solvers() { return solvers; }
 
+  // Every solver is free, call after solvers are resized
+  void reset() {
+    std::lock_guard<std::mutex> lock(mtx);
+    done.clear();
+    for (size_t i = 0; i < solvers.size(); i++) {
+      done.push_back(i);
+    }
+  }
+
+  // Sleeps until some solver finishes, solvers are handed out in completion order
   SCS<Kernel> &get_free_kernel() {
-    while (true) {
-      if (it->kernel->get_status().done) {
-        return *it;
-      }
-      if (std::next(it) == solvers.end()) {
-        it = solvers.begin();
-      } else {
-        it++;
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [this] { return !done.empty(); });
+    auto idx = done.front();
+    done.pop_front();
+    return solvers[idx];
+  }
+
+  void launch(SCS<Kernel> &scs) {
+    size_t idx = &scs - solvers.data();
+    scs.kernel->launch(true);
+    scs.kernel->notify_when_done([this, idx]() {
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        done.push_back(idx);
       }
-    }
+      cv.notify_one();
+    });
   }
 
  private:
   SCSVecT solvers;
-  iter it;
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<size_t> done;
 };
 
+// Called with a range of columns [col, col + nr_cols)
+using ColumnHook = std::function<void(uint32_t col, uint32_t nr_cols)>;
+
 // Assumption A is in row order, B and C are in column order
-// A is of size rowsA x rowsB
-// B rowsB x colsB
-// C rowsA x colsB
+// A is of size rowsA x rowsB with row stride lda
+// B rowsB x colsB with column stride ldb
+// C rowsA x colsB with column stride ldc
+// If b_row_major is set B is in row order with row stride ldb, columns are gathered straight into the x buffer
+// of the kernel.
+// wait_columns is called before columns of B (and C) are pushed to DPUs,
+// columns_done once these columns of C are back on the host.
 template <typename inType, typename outType, class Kernel>
-void sgemm(uint32_t rowsA, uint32_t rowsB, uint32_t colsB, const inType *A, const inType *B, outType *C,
-           const outType *alpha, const outType *beta) {
+void sgemm(uint32_t rowsA, uint32_t rowsB, uint32_t colsB, const inType *A, uint32_t lda, const inType *B,
+           uint32_t ldb, outType *C, uint32_t ldc, const outType *alpha, const outType *beta, bool b_row_major = false,
+           const ColumnHook &wait_columns = nullptr, const ColumnHook &columns_done = nullptr) {
   uint32_t nr_dpus = 512;
   uint32_t rows_per_dpu = 0;
-  gemv_launch_statistics<outType>(rowsA, rowsB, nr_dpus, rows_per_dpu);
+  gemv_launch_statistics<outType>(rowsA, rowsB, nr_dpus, rows_per_dpu, get_dpus_per_rank());
+
+  // Every launch handles nr_vectors columns of B, A is streamed from MRAM once for all of them.
+  // Multi vector kernels have no variants, they run with the tasklet count of the plain kernels.
+  uint32_t nr_vectors = Kernel::fit_nr_vectors(rowsB, rows_per_dpu, Kernel::max_vectors, Kernel::base_nr_tasklets);
+  if (nr_vectors == 0) {
+    show_error("sgemm: A and x vectors don't fit into MRAM for rowsB=[{}] rows_per_dpu=[{}]", rowsB, rows_per_dpu);
+    return;
+  }
+  nr_vectors = std::max(1u, std::min(nr_vectors, colsB));
+  uint32_t nr_batches = (colsB - 1) / nr_vectors + 1;
 
-  auto nr_solvers = std::min(8 * 8 * 2 * 20 / nr_dpus, (colsB + 1) / 2);
+  auto nr_solvers = std::min(8 * 8 * 2 * 20 / nr_dpus, (nr_batches + 1) / 2);
   bool has_beta = (*beta != 0);
   MCS<Kernel> mcs(nr_solvers);
 
@@ -103,41 +147,177 @@ void sgemm(uint32_t rowsA, uint32_t rowsB, uint32_t colsB, const inType *A, cons
     }
   }
   solvers.resize(kernel_it);
+  if (solvers.empty()) {
+    show_error("sgemm: Couldn't initialize any kernel for rowsA=[{}] rowsB=[{}]", rowsA, rowsB);
+    return;
+  }
+  mcs.reset();
 
   for (auto &scs : solvers) {
     auto &kernel = scs.kernel;
-    kernel->set_params(alpha, beta, false);
-    kernel->set_A(A, true);
+    kernel->set_params(alpha, beta, nr_vectors, false);
+    kernel->set_A(A, lda, true);
   }
 
-  show_trace("Running {} kernels. Each kernel with {} DPUs.\n", solvers.size(), nr_dpus);
+  show_trace("Running {} kernels. Each kernel with {} DPUs and {} columns per launch.\n", solvers.size(), nr_dpus,
+             nr_vectors);
 
-  size_t cur_kernel = 0;
-  for (uint32_t i = 0; i < colsB; i++) {
+  for (uint32_t i = 0; i < colsB; i += nr_vectors) {
+    uint32_t nr_columns = std::min(nr_vectors, colsB - i);
     auto &scs = mcs.get_free_kernel();
     auto &kernel = scs.kernel;
     if (scs.column != -1) {
-      kernel->get_y_safe(C + rowsA * scs.column);
+      kernel->get_y_safe(C + static_cast<size_t>(ldc) * scs.column, ldc, scs.nr_columns);
+      if (columns_done) {
+        columns_done(scs.column, scs.nr_columns);
+      }
       scs.column = -1;
     }
-    kernel->set_x(B + rowsB * i, true);
+    if (wait_columns) {
+      wait_columns(i, nr_columns);
+    }
+    if (nr_columns != nr_vectors) {
+      // Last, smaller batch
+      kernel->set_params(alpha, beta, nr_columns, false);
+    }
+    if (b_row_major) {
+      kernel->set_x_strided(B + i, ldb, nr_columns, true);
+    } else {
+      kernel->set_x(B + static_cast<size_t>(ldb) * i, ldb, nr_columns, true);
+    }
     if (has_beta) {
-      kernel->set_y(C + rowsA * i, true);
+      kernel->set_y(C + static_cast<size_t>(ldc) * i, ldc, nr_columns, true);
     }
-    kernel->launch(true);
+    mcs.launch(scs);
     scs.column = i;
+    scs.nr_columns = nr_columns;
   }
 
   for (auto &scs : solvers) {
     auto &kernel = scs.kernel;
     if (scs.column != -1) {
       kernel->sync();
-      kernel->get_y_safe(C + rowsA * scs.column);
+      kernel->get_y_safe(C + static_cast<size_t>(ldc) * scs.column, ldc, scs.nr_columns);
+      if (columns_done) {
+        columns_done(scs.column, scs.nr_columns);
+      }
       scs.column = -1;
     }
   }
 }
 
+// GEMV based sgemm reads whole A for every column of B, tiled kernel reuses
+// both A and B from WRAM, so it wins once C is not too thin in either direction
+bool use_tiled_gemm(uint32_t m, uint32_t n, uint32_t k) {
+  constexpr uint32_t min_dim = 256;
+  constexpr uint32_t max_aspect_ratio = 16;
+  uint32_t lo = std::min(m, n);
+  uint32_t hi = std::max(m, n);
+  return lo >= min_dim && hi <= max_aspect_ratio * lo && k > 0;
+}
+
+// All matrices are row major, A is m x k, B is k x n, C is m x n
+template <typename inType, typename outType, class Kernel>
+bool tiled_gemm(uint32_t m, uint32_t n, uint32_t k, const inType *A, const inType *B, outType *C,
+                const outType *alpha, const outType *beta) {
+  Kernel kernel;
+  if (kernel.init(m, n, k, 512) == false) {
+    return false;
+  }
+
+  kernel.set_params(alpha, beta);
+  kernel.set_A(A);
+  kernel.set_B_row_major(B);
+  if (*beta != 0) {
+    kernel.set_C(C);
+  }
+  kernel.launch(false);
+  kernel.get_C(C);
+  return true;
+}
+
+// Runs sgemm on row major B and C. Columns of B are gathered straight into x buffers of kernels, so there's
+// no copy of B. If beta != 0, column blocks of C are transposed on the host worker pool while earlier
+// blocks already run on DPUs. Finished blocks of C are transposed back while later columns are computed.
+// Latency gets close to max(host transposes, DPU compute) instead of the sum.
+template <typename inType, typename outType, class Kernel>
+void sgemm_row_major_pipelined(uint32_t m, uint32_t n, uint32_t k, const inType *A, const inType *B, outType *C,
+                               const outType *alpha, const outType *beta) {
+  constexpr uint32_t block_cols = 64;
+  if (m == 0 || n == 0) {
+    return;
+  }
+  auto &pool = WorkerPool::instance();
+  bool has_beta = (*beta != 0);
+
+  outType *tmp_c = reinterpret_cast<outType *>(malloc(alignUp(static_cast<size_t>(m) * n * sizeof(outType), 16)));
+
+  // Blocks are queued in column order, so the first ones are ready first
+  uint32_t nr_blocks = (n - 1) / block_cols + 1;
+  std::vector<std::future<void>> ready;
+  if (has_beta) {
+    for (uint32_t block = 0; block < nr_blocks; block++) {
+      uint32_t col = block * block_cols;
+      uint32_t nr_cols = std::min(block_cols, n - col);
+      ready.push_back(pool.submit([=]() {
+        transpose_matrix_row_major(C + col, tmp_c + static_cast<size_t>(col) * m, m, nr_cols, n, m);
+      }));
+    }
+  }
+
+  auto wait_columns = [&](uint32_t col, uint32_t nr_cols) {
+    if (ready.empty()) {
+      return;
+    }
+    for (uint32_t block = col / block_cols; block <= (col + nr_cols - 1) / block_cols; block++) {
+      ready[block].wait();
+    }
+  };
+
+  // Once every column of a block is back on the host, the block is written to C
+  std::vector<uint32_t> nr_done(nr_blocks, 0);
+  std::vector<std::future<void>> written;
+  auto columns_done = [&](uint32_t col, uint32_t nr_cols) {
+    uint32_t end = col + nr_cols;
+    while (col < end) {
+      uint32_t block = col / block_cols;
+      uint32_t first = block * block_cols;
+      uint32_t width = std::min(block_cols, n - first);
+      uint32_t count = std::min(first + width, end) - col;
+      col += count;
+      nr_done[block] += count;
+      if (nr_done[block] == width) {
+        written.push_back(pool.submit([=]() {
+          transpose_matrix_column_major(tmp_c + static_cast<size_t>(first) * m, C + first, m, width, m, n);
+        }));
+      }
+    }
+  };
+
+  sgemm<inType, outType, Kernel>(m, k, n, A, k, B, n, tmp_c, m, alpha, beta, true, wait_columns, columns_done);
+
+  // Workers still reference C and the temporary buffer
+  for (auto &f : ready) {
+    f.wait();
+  }
+  for (auto &f : written) {
+    f.wait();
+  }
+
+  free(tmp_c);
+}
+
+// Shapes the tiled kernel doesn't take go through the multi-vector GEMV, A and B stay 16-bit
+template <class Kernel, class MultiKernel>
+void gemm_row_major_half(uint32_t m, uint32_t n, uint32_t k, const uint16_t *A, const uint16_t *B, float *C,
+                         const float *alpha, const float *beta) {
+  if (use_tiled_gemm(m, n, k) && tiled_gemm<uint16_t, float, Kernel>(m, n, k, A, B, C, alpha, beta)) {
+    return;
+  }
+
+  sgemm_row_major_pipelined<uint16_t, float, MultiKernel>(m, n, k, A, B, C, alpha, beta);
+}
+
 bool is_transpose(char trans) {
   if (trans == 'N' || trans == 'n') {
     return false;
@@ -161,49 +341,34 @@ void sgemm_wrapper(const char *transa, const char *transb, const int *m, const i
                    const int *ldc) {
   const float *a_buffer = nullptr;
   float *a_tmp_buffer = nullptr;
+  uint32_t a_ld = *k;
 
   if (false == is_transpose(*transa)) {
     // Matrix is in colum major order
     // And is treated as is that means
     // we need to change it into row major in order to use
-    // it with our algorithm.
-    assert(*lda == *m && "Unexpected padding in matrix A - UNHANDLED");
-    a_tmp_buffer = reinterpret_cast<float *>(malloc(alignUp(*m * *k * sizeof(float), 16)));
-    transpose_matrix_column_major(a, a_tmp_buffer, *m, *k);
+    // it with our algorithm. The transpose also drops the padding.
+    a_tmp_buffer = reinterpret_cast<float *>(malloc(alignUp(static_cast<size_t>(*m) * *k * sizeof(float), 16)));
+    transpose_matrix_column_major(a, a_tmp_buffer, *m, *k, *lda, *k);
     a_buffer = a_tmp_buffer;
   } else {
     // Matrix is in column major order
     // And is treated as transposed
-    // that means we can treat it as is already
-    // assuming there's no padding
-    // Just switch the dimensions
-    assert(*lda == *k && "Unexpected padding in matrix A - UNHANDLED");
+    // that means we can treat it as a row major matrix
+    // with row stride lda. Just switch the dimensions
     a_buffer = a;
+    a_ld = *lda;
   }
 
-  const float *b_buffer = nullptr;
-  float *b_tmp_buffer = nullptr;
-  if (false == is_transpose(*transb)) {
-    // No need to do anything
-    assert(*ldb == *k && "Unexpected padding in matrix B - UNHANDLED");
-    b_buffer = b;
-  } else {
-    // Matrix is in col major ordering and is treated as transposed
-    // That means if we convert it then it's all good
-    // we got B (LDB/n, k) and we need it to be B**T (k, n)
-    assert(*ldb == *n && "Unexpected padding in matrix B - UNHANDLED");
-    b_tmp_buffer = reinterpret_cast<float *>(malloc(alignUp(*n * *k * sizeof(float), 16)));
-    transpose_matrix_column_major(b, b_tmp_buffer, *n, *k);
-    b_buffer = b_tmp_buffer;
-  }
-
-  // C is already in column major order no need to do anything
-  assert(*ldc == *m && "Unexpected padding in matrix C - UNHANDLED");
+  // Not transposed B is in column major order, columns are read with stride ldb.
+  // Transposed B (n x k in column major order) is op(B) in row major order with row stride ldb,
+  // columns are gathered straight into x buffers of kernels.
+  bool b_row_major = is_transpose(*transb);
 
-  sgemm<float, float, GEMVF_Kernel>(*m, *k, *n, a_buffer, b_buffer, c, alpha, beta);
+  // C is already in column major order, columns are read and written with stride ldc
+  sgemm<float, float, GEMVF_Multi_Kernel>(*m, *k, *n, a_buffer, a_ld, b, *ldb, c, *ldc, alpha, beta, b_row_major);
 
   free(a_tmp_buffer);
-  free(b_tmp_buffer);
 }
 
 /*
@@ -220,23 +385,12 @@ void gemm_row_maj_f(const int *m, const int *n, const int *k, const float *alpha
       *m, *n, *k, *alpha, reinterpret_cast<const uintptr_t>(a), reinterpret_cast<const uintptr_t>(b), *beta,
       reinterpret_cast<const uintptr_t>(c));
 
-  // Get B to column major format
-  float *tmp_b = reinterpret_cast<float *>(malloc(alignUp(*k * *n * sizeof(float), 16)));
-  transpose_matrix_row_major(b, tmp_b, *k, *n);
-
-  // If Beta is not zero we need to change C to column major format
-  float *tmp_c = reinterpret_cast<float *>(malloc(alignUp(*m * *n * sizeof(float), 16)));
-  if (*beta != 0.0f) {
-    transpose_matrix_row_major(c, tmp_c, *m, *n);
+  // Tiled kernel works on row major B and C directly
+  if (use_tiled_gemm(*m, *n, *k) && tiled_gemm<float, float, GEMMF_Kernel>(*m, *n, *k, a, b, c, alpha, beta)) {
+    return;
   }
 
-  sgemm<float, float, GEMVF_Kernel>(*m, *k, *n, a, tmp_b, tmp_c, alpha, beta);
-
-  // Get C from col major to row major
-  transpose_matrix_column_major(tmp_c, c, *m, *n);
-
-  free(tmp_b);
-  free(tmp_c);
+  sgemm_row_major_pipelined<float, float, GEMVF_Multi_Kernel>(*m, *n, *k, a, b, c, alpha, beta);
 }
 
 /*
@@ -253,23 +407,36 @@ void gemm_row_maj_int8(const int *m, const int *n, const int *k, const int *alph
       *m, *n, *k, *alpha, reinterpret_cast<const uintptr_t>(a), reinterpret_cast<const uintptr_t>(b), *beta,
       reinterpret_cast<const uintptr_t>(c));
 
-  // Get B to column major format
-  int8_t *tmp_b = reinterpret_cast<int8_t *>(malloc(alignUp(*k * *n * sizeof(int8_t), 16)));
-  transpose_matrix_row_major(b, tmp_b, *k, *n);
-
-  // If Beta is not zero we need to change C to column major format
-  int *tmp_c = reinterpret_cast<int *>(malloc(alignUp(*m * *n * sizeof(int), 16)));
-  if (*beta != 0) {
-    transpose_matrix_row_major(c, tmp_c, *m, *n);
+  // Tiled kernel works on row major B and C directly
+  if (use_tiled_gemm(*m, *n, *k) &&
+      tiled_gemm<int8_t, int32_t, GEMM_INT8_Kernel>(*m, *n, *k, a, b, c, alpha, beta)) {
+    return;
   }
 
-  sgemm<int8_t, int32_t, GEMV_INT8_Kernel>(*m, *k, *n, a, tmp_b, tmp_c, alpha, beta);
+  sgemm_row_major_pipelined<int8_t, int32_t, GEMV_INT8_Multi_Kernel>(*m, *n, *k, a, b, c, alpha, beta);
+}
+
+/*
+A is an m by k matrix
+B is an k by n matrix
+C is an m by n matrix
+All matricies are in row major format. Memory is contiguous
+*/
+void gemm_row_maj_int16(const int *m, const int *n, const int *k, const int *alpha, const int16_t *a, const int16_t *b,
+                        const int *beta, int *c) {
+  show_trace(
+      "gemm_row_int16 m=[{}] n=[{}] k=[{}] alpha=[{}] a=[{:#018x}] b=[{:#018x}] "
+      "beta=[{}] c=[{:#018x}]",
+      *m, *n, *k, *alpha, reinterpret_cast<const uintptr_t>(a), reinterpret_cast<const uintptr_t>(b), *beta,
+      reinterpret_cast<const uintptr_t>(c));
 
-  // Get C from col major to row major
-  transpose_matrix_column_major(tmp_c, c, *m, *n);
+  // Tiled kernel works on row major B and C directly
+  if (use_tiled_gemm(*m, *n, *k) &&
+      tiled_gemm<int16_t, int32_t, GEMM_INT16_Kernel>(*m, *n, *k, a, b, c, alpha, beta)) {
+    return;
+  }
 
-  free(tmp_b);
-  free(tmp_c);
+  sgemm_row_major_pipelined<int16_t, int32_t, GEMV_INT16_Multi_Kernel>(*m, *n, *k, a, b, c, alpha, beta);
 }
 
 /*
@@ -286,22 +453,44 @@ void gemm_row_maj_int32(const int *m, const int *n, const int *k, const int *alp
       *m, *n, *k, *alpha, reinterpret_cast<const uintptr_t>(a), reinterpret_cast<const uintptr_t>(b), *beta,
       reinterpret_cast<const uintptr_t>(c));
 
-  // Get B to column major format
-  int32_t *tmp_b = reinterpret_cast<int32_t *>(malloc(alignUp(*k * *n * sizeof(int32_t), 16)));
-  transpose_matrix_row_major(b, tmp_b, *k, *n);
-
-  // If Beta is not zero we need to change C to column major format
-  int *tmp_c = reinterpret_cast<int *>(malloc(alignUp(*m * *n * sizeof(int32_t), 16)));
-  if (*beta != 0) {
-    transpose_matrix_row_major(c, tmp_c, *m, *n);
+  // Tiled kernel works on row major B and C directly
+  if (use_tiled_gemm(*m, *n, *k) &&
+      tiled_gemm<int32_t, int32_t, GEMM_INT32_Kernel>(*m, *n, *k, a, b, c, alpha, beta)) {
+    return;
   }
 
-  sgemm<int32_t, int32_t, GEMV_INT32_Kernel>(*m, *k, *n, a, tmp_b, tmp_c, alpha, beta);
+  sgemm_row_major_pipelined<int32_t, int32_t, GEMV_INT32_Multi_Kernel>(*m, *n, *k, a, b, c, alpha, beta);
+}
 
-  // Get C from col major to row major
-  transpose_matrix_column_major(tmp_c, c, *m, *n);
+/*
+A is an m by k matrix
+B is an k by n matrix
+C is an m by n matrix
+All matricies are in row major format. Memory is contiguous
+A and B are IEEE half precision, C is float
+*/
+void gemm_row_maj_f16(const int *m, const int *n, const int *k, const float *alpha, const uint16_t *a,
+                      const uint16_t *b, const float *beta, float *c) {
+  show_trace(
+      "gemm_row_f16 m=[{}] n=[{}] k=[{}] alpha=[{}] a=[{:#018x}] b=[{:#018x}] "
+      "beta=[{}] c=[{:#018x}]",
+      *m, *n, *k, *alpha, reinterpret_cast<const uintptr_t>(a), reinterpret_cast<const uintptr_t>(b), *beta,
+      reinterpret_cast<const uintptr_t>(c));
 
-  free(tmp_b);
-  free(tmp_c);
+  gemm_row_major_half<GEMM_F16_Kernel, GEMV_F16_Multi_Kernel>(*m, *n, *k, a, b, c, alpha, beta);
+}
+
+/*
+Same as gemm_row_maj_f16 with bfloat16 A and B
+*/
+void gemm_row_maj_bf16(const int *m, const int *n, const int *k, const float *alpha, const uint16_t *a,
+                       const uint16_t *b, const float *beta, float *c) {
+  show_trace(
+      "gemm_row_bf16 m=[{}] n=[{}] k=[{}] alpha=[{}] a=[{:#018x}] b=[{:#018x}] "
+      "beta=[{}] c=[{:#018x}]",
+      *m, *n, *k, *alpha, reinterpret_cast<const uintptr_t>(a), reinterpret_cast<const uintptr_t>(b), *beta,
+      reinterpret_cast<const uintptr_t>(c));
+
+  gemm_row_major_half<GEMM_BF16_Kernel, GEMV_BF16_Multi_Kernel>(*m, *n, *k, a, b, c, alpha, beta);
 }
 }
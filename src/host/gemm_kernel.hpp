@@ -0,0 +1,108 @@
+#pragma once
+#include <vector>
+
+#include "kernel.hpp"
+
+// Tiled GEMM: C = alpha * A * B + beta * C
+// A is m x k row major, B is passed transposed (n x k row major), C is m x n row major.
+// C is split into a grid_rows x grid_cols grid of tiles, every DPU computes a single tile.
+// DPU (r, c) gets rows block r of A and columns block c of B.
+template <typename inType, typename outType>
+class GEMM_Kernel : public Kernel {
+  struct params {
+    uint32_t rows_per_dpu;
+    uint32_t cols_per_dpu;
+    uint32_t row_size;
+    outType alpha;
+    outType beta;
+  };
+
+ public:
+  // Both tile dimensions are multiples of tile_size, same as TILE_SIZE in the kernel
+  static constexpr uint32_t tile_size = 8;
+
+  GEMM_Kernel() = delete;
+  // mac_cycles - DPU cycles the kernel spends on a single multiply-accumulate, weighs work against transfers
+  GEMM_Kernel(const std::string &program_name, uint32_t mac_cycles)
+      : program_name(program_name), mac_cycles(mac_cycles) {}
+
+  void set_A(const inType *data);
+
+  // data is B in column major order, that is B**T in row major order
+  void set_B(const inType *data);
+
+  // data is B in row major order. Column blocks are gathered one at a time, so only
+  // a single block of B is staged on the host.
+  void set_B_row_major(const inType *data);
+
+  void set_C(const outType *data);
+
+  void get_C(outType *data);
+
+  void set_params(const outType *alpha, const outType *beta);
+
+  bool init(uint32_t m, uint32_t n, uint32_t k, uint32_t max_dpus);
+
+  // Picks the 2D grid of at most max_dpus DPUs with the lowest estimated time: work of a single tile plus
+  // transfers, blocks of A go to grid_cols DPUs each and blocks of B to grid_rows DPUs each.
+  // Returns false if no grid fits in MRAM
+  static bool partition(uint32_t m, uint32_t n, uint32_t k, uint32_t max_dpus, uint32_t mac_cycles,
+                        uint32_t &rows_per_dpu, uint32_t &cols_per_dpu);
+
+ private:
+  // Returns block of rows of row major matrix, the last block is copied and padded with zeros
+  const inType *get_block(const inType *data, uint32_t nr_rows, uint32_t block_rows, uint32_t block,
+                          std::vector<inType> &tail);
+
+  void transfer_tiles(dpu_xfer_t xfer);
+
+  std::string program_name;
+  uint32_t mac_cycles;
+  uint32_t m;
+  uint32_t n;
+  uint32_t k;
+  uint32_t rows_per_dpu;
+  uint32_t cols_per_dpu;
+  uint32_t grid_rows;
+  uint32_t grid_cols;
+
+  size_t A_offset;
+  size_t B_offset;
+  size_t C_offset;
+
+  // Tiles of C in DPU order
+  std::vector<outType> C_tiles;
+};
+
+#include "gemm_kernel_impl.tpp"
+
+class GEMMF_Kernel : public GEMM_Kernel<float, float> {
+ public:
+  GEMMF_Kernel() : GEMM_Kernel("gemm_f.kernel", 80) {}
+};
+
+class GEMM_INT8_Kernel : public GEMM_Kernel<int8_t, int> {
+ public:
+  GEMM_INT8_Kernel() : GEMM_Kernel("gemm_int8.kernel", 3) {}
+};
+
+class GEMM_INT16_Kernel : public GEMM_Kernel<int16_t, int> {
+ public:
+  GEMM_INT16_Kernel() : GEMM_Kernel("gemm_int16.kernel", 10) {}
+};
+
+class GEMM_INT32_Kernel : public GEMM_Kernel<int, int> {
+ public:
+  GEMM_INT32_Kernel() : GEMM_Kernel("gemm_int32.kernel", 32) {}
+};
+
+// 16-bit floating point A and B (bit patterns in uint16_t), float C
+class GEMM_F16_Kernel : public GEMM_Kernel<uint16_t, float> {
+ public:
+  GEMM_F16_Kernel() : GEMM_Kernel("gemm_f16.kernel", 80) {}
+};
+
+class GEMM_BF16_Kernel : public GEMM_Kernel<uint16_t, float> {
+ public:
+  GEMM_BF16_Kernel() : GEMM_Kernel("gemm_bf16.kernel", 80) {}
+};
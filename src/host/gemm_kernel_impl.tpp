@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cstring>
+
+#include "dpu_transfer_helper.hpp"
+#include "matrix_transpose.hpp"
+
+template <typename inType, typename outType>
+const inType *GEMM_Kernel<inType, outType>::get_block(const inType *data, uint32_t nr_rows, uint32_t block_rows,
+                                                      uint32_t block, std::vector<inType> &tail) {
+  size_t first_row = static_cast<size_t>(block) * block_rows;
+  if (first_row + block_rows <= nr_rows) {
+    return data + first_row * k;
+  }
+
+  // Every DPU of the last block shares the same copy
+  if (false == tail.empty()) {
+    return tail.data();
+  }
+  tail.assign(static_cast<size_t>(block_rows) * k, 0);
+  std::memcpy(tail.data(), data + first_row * k, (nr_rows - first_row) * k * sizeof(inType));
+  return tail.data();
+}
+
+template <typename inType, typename outType>
+void GEMM_Kernel<inType, outType>::set_A(const inType *data) {
+  std::vector<inType> tail;
+  dpu_set_t dpu;
+  uint32_t dpu_idx;
+  DPU_FOREACH(dpu_set, dpu, dpu_idx) {
+    if (dpu_idx == nr_dpus) {
+      break;
+    }
+    auto block = get_block(data, m, rows_per_dpu, dpu_idx / grid_cols, tail);
+    DPU_ASSERT(dpu_prepare_xfer(dpu, const_cast<inType *>(block)));
+  }
+  // rows_per_dpu is a multiple of 8, so the size is 8B aligned
+  DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, A_offset,
+                           rows_per_dpu * k * sizeof(inType), DPU_XFER_DEFAULT));
+}
+
+template <typename inType, typename outType>
+void GEMM_Kernel<inType, outType>::set_B(const inType *data) {
+  std::vector<inType> tail;
+  dpu_set_t dpu;
+  uint32_t dpu_idx;
+  DPU_FOREACH(dpu_set, dpu, dpu_idx) {
+    if (dpu_idx == nr_dpus) {
+      break;
+    }
+    auto block = get_block(data, n, cols_per_dpu, dpu_idx % grid_cols, tail);
+    DPU_ASSERT(dpu_prepare_xfer(dpu, const_cast<inType *>(block)));
+  }
+  DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, B_offset,
+                           cols_per_dpu * k * sizeof(inType), DPU_XFER_DEFAULT));
+}
+
+template <typename inType, typename outType>
+void GEMM_Kernel<inType, outType>::set_B_row_major(const inType *data) {
+  // Padding columns of the last block hold leftovers of the previous block, results for them are dropped
+  std::vector<inType> block(static_cast<size_t>(cols_per_dpu) * k, 0);
+  for (uint32_t grid_col = 0; grid_col < grid_cols; grid_col++) {
+    uint32_t col = grid_col * cols_per_dpu;
+    uint32_t nr_cols = std::min(cols_per_dpu, n - col);
+    transpose_matrix_row_major(data + col, block.data(), k, nr_cols, n, k);
+
+    dpu_set_t dpu;
+    uint32_t dpu_idx;
+    DPU_FOREACH(dpu_set, dpu, dpu_idx) {
+      if (dpu_idx == nr_dpus) {
+        break;
+      }
+      if (dpu_idx % grid_cols == grid_col) {
+        DPU_ASSERT(dpu_prepare_xfer(dpu, block.data()));
+      }
+    }
+    DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, B_offset,
+                             cols_per_dpu * k * sizeof(inType), DPU_XFER_DEFAULT));
+  }
+}
+
+template <typename inType, typename outType>
+void GEMM_Kernel<inType, outType>::transfer_tiles(dpu_xfer_t xfer) {
+  size_t tile_elems = static_cast<size_t>(rows_per_dpu) * cols_per_dpu;
+  dpu_set_t dpu;
+  uint32_t dpu_idx;
+  DPU_FOREACH(dpu_set, dpu, dpu_idx) {
+    if (dpu_idx == nr_dpus) {
+      break;
+    }
+    DPU_ASSERT(dpu_prepare_xfer(dpu, C_tiles.data() + dpu_idx * tile_elems));
+  }
+  DPU_ASSERT(dpu_push_xfer(dpu_set, xfer, DPU_MRAM_HEAP_POINTER_NAME, C_offset, tile_elems * sizeof(outType),
+                           DPU_XFER_DEFAULT));
+}
+
+template <typename inType, typename outType>
+void GEMM_Kernel<inType, outType>::set_C(const outType *data) {
+  for (uint32_t dpu_idx = 0; dpu_idx < nr_dpus; dpu_idx++) {
+    uint32_t row = (dpu_idx / grid_cols) * rows_per_dpu;
+    uint32_t col = (dpu_idx % grid_cols) * cols_per_dpu;
+    uint32_t nr_rows = std::min(rows_per_dpu, m - row);
+    uint32_t nr_cols = std::min(cols_per_dpu, n - col);
+    outType *tile = C_tiles.data() + static_cast<size_t>(dpu_idx) * rows_per_dpu * cols_per_dpu;
+    for (uint32_t i = 0; i < nr_rows; i++) {
+      std::memcpy(tile + i * cols_per_dpu, data + static_cast<size_t>(row + i) * n + col, nr_cols * sizeof(outType));
+    }
+  }
+  transfer_tiles(DPU_XFER_TO_DPU);
+}
+
+template <typename inType, typename outType>
+void GEMM_Kernel<inType, outType>::get_C(outType *data) {
+  transfer_tiles(DPU_XFER_FROM_DPU);
+  for (uint32_t dpu_idx = 0; dpu_idx < nr_dpus; dpu_idx++) {
+    uint32_t row = (dpu_idx / grid_cols) * rows_per_dpu;
+    uint32_t col = (dpu_idx % grid_cols) * cols_per_dpu;
+    uint32_t nr_rows = std::min(rows_per_dpu, m - row);
+    uint32_t nr_cols = std::min(cols_per_dpu, n - col);
+    const outType *tile = C_tiles.data() + static_cast<size_t>(dpu_idx) * rows_per_dpu * cols_per_dpu;
+    for (uint32_t i = 0; i < nr_rows; i++) {
+      std::memcpy(data + static_cast<size_t>(row + i) * n + col, tile + i * cols_per_dpu, nr_cols * sizeof(outType));
+    }
+  }
+}
+
+template <typename inType, typename outType>
+void GEMM_Kernel<inType, outType>::set_params(const outType *alpha, const outType *beta) {
+  params args{.rows_per_dpu = rows_per_dpu,
+              .cols_per_dpu = cols_per_dpu,
+              .row_size = k,
+              .alpha = *alpha,
+              .beta = *beta};
+  this->set_arg_broadcast_exact("args", 0, reinterpret_cast<uint8_t *>(&args), sizeof(params), false);
+}
+
+template <typename inType, typename outType>
+bool GEMM_Kernel<inType, outType>::partition(uint32_t m, uint32_t n, uint32_t k, uint32_t max_dpus, uint32_t mac_cycles,
+                                             uint32_t &rows_per_dpu, uint32_t &cols_per_dpu) {
+  // Let's leave 1 MB
+  constexpr size_t mem_cap = 63 * 1024 * 1024;
+  // Rough rates: DPUs run at 350 MHz, pushes to and gathers from all ranks move about 6 and 4 GB/s
+  constexpr double dpu_hz = 350e6;
+  constexpr double push_bytes_per_s = 6e9;
+  constexpr double gather_bytes_per_s = 4e9;
+
+  bool found = false;
+  double best_cost = 0;
+  for (uint32_t grid_rows = 1; grid_rows <= max_dpus; grid_rows++) {
+    for (uint32_t grid_cols = 1; grid_rows * grid_cols <= max_dpus; grid_cols++) {
+      size_t rows = alignUp((m - 1) / grid_rows + 1, tile_size);
+      size_t cols = alignUp((n - 1) / grid_cols + 1, tile_size);
+      // Padded tiles can leave the last blocks empty, the smaller grid holding the same tiles is tried as well
+      if ((m - 1) / rows + 1 != grid_rows || (n - 1) / cols + 1 != grid_cols) {
+        continue;
+      }
+
+      size_t memory_requirement = (rows + cols) * k * sizeof(inType) + rows * cols * sizeof(outType);
+      if (memory_requirement > mem_cap) {
+        continue;
+      }
+
+      // Every DPU works on its tile (padding included) at the same time,
+      // while pushed blocks of A and B and gathered tiles of C add up over the grid
+      double nr_dpus = static_cast<double>(grid_rows) * grid_cols;
+      double work = static_cast<double>(rows) * cols * k * mac_cycles / dpu_hz;
+      double push = nr_dpus * (rows + cols) * k * sizeof(inType) / push_bytes_per_s;
+      double gather = nr_dpus * rows * cols * sizeof(outType) / gather_bytes_per_s;
+      double cost = work + push + gather;
+      if (false == found || cost < best_cost) {
+        found = true;
+        best_cost = cost;
+        rows_per_dpu = rows;
+        cols_per_dpu = cols;
+      }
+    }
+  }
+  return found;
+}
+
+template <typename inType, typename outType>
+bool GEMM_Kernel<inType, outType>::init(uint32_t m, uint32_t n, uint32_t k, uint32_t max_dpus) {
+  this->m = m;
+  this->n = n;
+  this->k = k;
+
+  if (false == partition(m, n, k, max_dpus, mac_cycles, rows_per_dpu, cols_per_dpu)) {
+    show_error("GEMM_Kernel: Couldn't partition m=[{}] n=[{}] k=[{}]", m, n, k);
+    return false;
+  }
+  grid_rows = (m - 1) / rows_per_dpu + 1;
+  grid_cols = (n - 1) / cols_per_dpu + 1;
+
+  if (this->allocate_n(grid_rows * grid_cols) == false) {
+    return false;
+  }
+
+  this->load_program(this->program_name.c_str());
+
+  A_offset = 0;
+  B_offset = alignUp(rows_per_dpu * k * sizeof(inType), 8);
+  C_offset = B_offset + alignUp(cols_per_dpu * k * sizeof(inType), 8);
+  C_tiles.resize(static_cast<size_t>(nr_dpus) * rows_per_dpu * cols_per_dpu);
+
+  show_debug("GEMM_Kernel: grid=[{}x{}] rows_per_dpu=[{}] cols_per_dpu=[{}]", grid_rows, grid_cols, rows_per_dpu,
+             cols_per_dpu);
+  return true;
+}
@@ -1,11 +1,34 @@
+#include <algorithm>
+#include <type_traits>
+
 #include "common.hpp"
+#include "gemv_grid_kernel.hpp"
 #include "gemv_kernel.hpp"
+#include "gemv_q4_kernel.hpp"
+#include "zero_blocks.hpp"
+
+template <typename inType, typename outType, class GridKernel>
+int gemv_grid(uint32_t m, uint32_t n, const GEMVPartition &part, const inType *mat, const inType *vec, outType *out,
+              const outType *alpha, const outType *beta) {
+  GridKernel kernel;
+  if (kernel.init(m, n, part) == false) {
+    show_error("gemv: Couldn't initialize grid kernel for m=[{}] n=[{}]", m, n);
+    return -1;
+  }
+  kernel.set_params(alpha, false);
+  kernel.set_A(mat, true);
+  kernel.set_x(vec, true);
+  kernel.launch(true);
+  kernel.sync();
+  kernel.get_y(out, beta);
+  return 0;
+}
 
 template <typename inType, typename outType, class Kernel>
-int gemv(uint32_t m, uint32_t n, const inType *mat, const inType *vec, outType *out, const outType *alpha,
-         const outType *beta) {
+int gemv_rows(uint32_t m, uint32_t n, const GEMVPartition &part, const inType *mat, const inType *vec, outType *out,
+              const outType *alpha, const outType *beta) {
   Kernel kernel;
-  if (kernel.init(m, n) == false) {
+  if (kernel.init(m, n, part.grid_rows, part.rows_per_dpu) == false) {
     show_error("gemv: Couldn't initialize kernel for m=[{}] n=[{}]", m, n);
     return -1;
   }
@@ -21,22 +44,122 @@ int gemv(uint32_t m, uint32_t n, const inType *mat, const inType *vec, outType *
   return 0;
 }
 
+// Compressed A pays off only if it's noticeably smaller, decoding isn't free
+template <typename inType>
+bool use_compressed_A(uint32_t m, uint32_t n, const inType *mat) {
+  constexpr size_t nr_samples = 64;
+  if (false == zb_enabled()) {
+    return false;
+  }
+  size_t row_bytes = n * sizeof(inType);
+  size_t step = std::max<size_t>(1, m / nr_samples);
+  size_t size = zb_estimate_size(reinterpret_cast<const uint8_t *>(mat), m, row_bytes, step);
+  return 4 * size < 3 * static_cast<size_t>(m) * row_bytes;
+}
+
+template <typename inType, typename outType, class Kernel, class GridKernel, class CompressedKernel = void>
+int gemv(uint32_t m, uint32_t n, const inType *mat, const inType *vec, outType *out, const outType *alpha,
+         const outType *beta) {
+  // A single GEMV runs on one rank
+  uint32_t dpus_per_rank = get_dpus_per_rank();
+  auto part = plan_gemv_partition<outType>(m, n, dpus_per_rank, dpus_per_rank);
+  if (part.grid_cols > 1) {
+    return gemv_grid<inType, outType, GridKernel>(m, n, part, mat, vec, out, alpha, beta);
+  }
+
+  if constexpr (false == std::is_void<CompressedKernel>::value) {
+    if (use_compressed_A(m, n, mat)) {
+      return gemv_rows<inType, outType, CompressedKernel>(m, n, part, mat, vec, out, alpha, beta);
+    }
+  }
+  return gemv_rows<inType, outType, Kernel>(m, n, part, mat, vec, out, alpha, beta);
+}
+
+template <typename xType>
+int gemv_q4(uint32_t m, uint32_t n, const uint8_t *A, uint32_t group_size, bool zero_points, const xType *x,
+            float x_scale, float *y, const float *alpha, const float *beta) {
+  GEMV_Q4_Kernel kernel;
+  if (kernel.init(m, n, group_size, zero_points) == false) {
+    show_error("gemv_q4: Couldn't initialize kernel for m=[{}] n=[{}] group_size=[{}]", m, n, group_size);
+    return -1;
+  }
+  kernel.set_params(alpha, beta, false);
+  kernel.set_A(A, true);
+  if constexpr (std::is_same<xType, float>::value) {
+    kernel.set_x(x, true);
+  } else {
+    kernel.set_x(x, x_scale, true);
+  }
+  if (*beta != 0) {
+    kernel.set_y(y, true);
+  }
+  kernel.launch(true);
+  kernel.get_y(y, true);
+  kernel.sync();
+  return 0;
+}
+
+// 16-bit floating point A and x, only the plain row split has kernels for them
+template <class Kernel>
+int gemv_half(uint32_t m, uint32_t n, const uint16_t *A, const uint16_t *x, float *y, const float *alpha,
+              const float *beta) {
+  Kernel kernel;
+  if (kernel.init(m, n) == false) {
+    show_error("gemv_half: Couldn't initialize kernel for m=[{}] n=[{}]", m, n);
+    return -1;
+  }
+  kernel.set_params(alpha, beta, false);
+  kernel.set_A(A, true);
+  kernel.set_x(x, true);
+  if (*beta != 0) {
+    kernel.set_y(y, true);
+  }
+  kernel.launch(true);
+  kernel.get_y(y, true);
+  kernel.sync();
+  return 0;
+}
+
 extern "C" {
 int gemv_int8(uint32_t m, uint32_t n, const int8_t *A, const int8_t *x, int *y, const int *alpha, const int *beta) {
-  return gemv<int8_t, int, GEMV_INT8_Kernel>(m, n, A, x, y, alpha, beta);
+  return gemv<int8_t, int, GEMV_INT8_Kernel, GEMV_INT8_Grid_Kernel, GEMV_INT8_ZB_Kernel>(m, n, A, x, y, alpha, beta);
+}
+
+int gemv_int16(uint32_t m, uint32_t n, const int16_t *A, const int16_t *x, int *y, const int *alpha, const int *beta) {
+  return gemv<int16_t, int, GEMV_INT16_Kernel, GEMV_INT16_Grid_Kernel>(m, n, A, x, y, alpha, beta);
 }
 
 int gemv_int32(uint32_t m, uint32_t n, const int *A, const int *x, int *y, const int *alpha, const int *beta) {
-  return gemv<int, int, GEMV_INT32_Kernel>(m, n, A, x, y, alpha, beta);
+  return gemv<int, int, GEMV_INT32_Kernel, GEMV_INT32_Grid_Kernel>(m, n, A, x, y, alpha, beta);
 }
 
 int gemv_f_basic(uint32_t m, uint32_t n, const float *mat, const float *vec, float *out) {
   float alpha = 1.0f;
   float beta = 0.0f;
-  return gemv<float, float, GEMVF_Kernel>(m, n, mat, vec, out, &alpha, &beta);
+  return gemv<float, float, GEMVF_Kernel, GEMVF_Grid_Kernel, GEMVF_ZB_Kernel>(m, n, mat, vec, out, &alpha, &beta);
 }
 
 int gemv_f(uint32_t m, uint32_t n, const float *A, const float *x, float *y, const float *alpha, const float *beta) {
-  return gemv<float, float, GEMVF_Kernel>(m, n, A, x, y, alpha, beta);
+  return gemv<float, float, GEMVF_Kernel, GEMVF_Grid_Kernel, GEMVF_ZB_Kernel>(m, n, A, x, y, alpha, beta);
+}
+
+int gemv_bf16(uint32_t m, uint32_t n, const uint16_t *A, const uint16_t *x, float *y, const float *alpha,
+              const float *beta) {
+  return gemv_half<GEMV_BF16_Kernel>(m, n, A, x, y, alpha, beta);
+}
+
+int hgemv(uint32_t m, uint32_t n, const uint16_t *A, const uint16_t *x, float *y, const float *alpha,
+          const float *beta) {
+  return gemv_half<GEMV_F16_Kernel>(m, n, A, x, y, alpha, beta);
+}
+
+int gemv_q4_f(uint32_t m, uint32_t n, const uint8_t *A, uint32_t group_size, int zero_points, const float *x, float *y,
+              const float *alpha, const float *beta) {
+  return gemv_q4(m, n, A, group_size, zero_points != 0, x, 1.0f, y, alpha, beta);
+}
+
+int gemv_q4_int8(uint32_t m, uint32_t n, const uint8_t *A, uint32_t group_size, int zero_points, const int8_t *x,
+                 float x_scale, float *y, const float *alpha, const float *beta) {
+  return gemv_q4(m, n, A, group_size, zero_points != 0, x, x_scale, y, alpha, beta);
 }
 }
@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+
+#include "kernel.hpp"
+
+// GEMV on a grid_rows x grid_cols grid of DPUs: y = alpha * A * x + beta * y
+// DPU (r, c) gets a rows_per_dpu x cols_per_dpu block of A and the matching slice of x and
+// computes alpha * A_rc * x_c with the plain GEMV kernels. Partial sums of a row block are
+// added on the host together with beta * y. See plan_gemv_partition for the grid.
+template <typename inType, typename outType>
+class GEMV_Grid_Kernel : public Kernel {
+  struct params {
+    uint32_t rows_per_dpu;
+    uint32_t nr_rows;
+    uint32_t row_size;
+    outType alpha;
+    outType beta;
+  };
+
+ public:
+  GEMV_Grid_Kernel() = delete;
+  GEMV_Grid_Kernel(const std::string &program_name) : program_name(program_name) {}
+
+  // Blocks are pushed a row at a time straight from data, only the last column block is padded on the host
+  void set_A(const inType *data, bool async);
+
+  void set_x(const inType *data, bool async);
+
+  void set_params(const outType *alpha, bool async);
+
+  // Gathers partial sums and reduces them into y, y = sum of partials + beta * y
+  void get_y(outType *data, const outType *beta);
+
+  bool init(uint32_t m, uint32_t n, const GEMVPartition &partition);
+
+ private:
+  std::string program_name;
+  uint32_t m;
+  uint32_t n;
+  GEMVPartition part;
+
+  size_t A_offset;
+  size_t x_offset;
+  size_t y_offset;
+
+  // Last column block of A and x, zero padded to cols_per_dpu
+  std::vector<inType> A_tail;
+  std::vector<inType> x_padded;
+  // Partial sums in DPU order
+  std::vector<outType> partials;
+};
+
+#include "gemv_grid_kernel_impl.tpp"
+
+class GEMVF_Grid_Kernel : public GEMV_Grid_Kernel<float, float> {
+ public:
+  GEMVF_Grid_Kernel() : GEMV_Grid_Kernel("gemv_f.kernel") {}
+};
+
+class GEMV_INT8_Grid_Kernel : public GEMV_Grid_Kernel<int8_t, int> {
+ public:
+  GEMV_INT8_Grid_Kernel() : GEMV_Grid_Kernel("gemv_int8.kernel") {}
+};
+
+class GEMV_INT16_Grid_Kernel : public GEMV_Grid_Kernel<int16_t, int> {
+ public:
+  GEMV_INT16_Grid_Kernel() : GEMV_Grid_Kernel("gemv_int16.kernel") {}
+};
+
+class GEMV_INT32_Grid_Kernel : public GEMV_Grid_Kernel<int, int> {
+ public:
+  GEMV_INT32_Grid_Kernel() : GEMV_Grid_Kernel("gemv_int32.kernel") {}
+};
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <cstring>
+
+#include "dpu_transfer_helper.hpp"
+#include "gemv_variants.hpp"
+
+template <typename inType, typename outType>
+void GEMV_Grid_Kernel<inType, outType>::set_A(const inType *data, bool async) {
+  uint32_t last_col = (part.grid_cols - 1) * part.cols_per_dpu;
+  uint32_t last_cols = n - last_col;
+  bool has_tail = last_cols != part.cols_per_dpu;
+  if (has_tail) {
+    A_tail.assign(static_cast<size_t>(m) * part.cols_per_dpu, 0);
+    for (size_t row = 0; row < m; row++) {
+      std::memcpy(&A_tail[row * part.cols_per_dpu], data + row * n + last_col, last_cols * sizeof(inType));
+    }
+  }
+
+  // Row i of every block goes in a single push, DPUs whose block has no row i are skipped
+  // cols_per_dpu is a multiple of 8, so the size is 8B aligned
+  size_t row_bytes = part.cols_per_dpu * sizeof(inType);
+  uint32_t nr_rows = std::min(part.rows_per_dpu, m);
+  for (uint32_t i = 0; i < nr_rows; i++) {
+    dpu_set_t dpu;
+    uint32_t dpu_idx;
+    DPU_FOREACH(dpu_set, dpu, dpu_idx) {
+      if (dpu_idx == nr_dpus) {
+        break;
+      }
+      size_t row = static_cast<size_t>(dpu_idx / part.grid_cols) * part.rows_per_dpu + i;
+      uint32_t grid_col = dpu_idx % part.grid_cols;
+      if (row >= m) {
+        continue;
+      }
+      const inType *src = (has_tail && grid_col + 1 == part.grid_cols)
+                              ? &A_tail[row * part.cols_per_dpu]
+                              : data + row * n + static_cast<size_t>(grid_col) * part.cols_per_dpu;
+      DPU_ASSERT(dpu_prepare_xfer(dpu, const_cast<inType *>(src)));
+    }
+    DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, A_offset + i * row_bytes, row_bytes,
+                             DPU_XFER_ASYNC));
+  }
+
+  if (false == async) {
+    this->sync();
+  }
+}
+
+template <typename inType, typename outType>
+void GEMV_Grid_Kernel<inType, outType>::set_x(const inType *data, bool async) {
+  std::memcpy(x_padded.data(), data, n * sizeof(inType));
+
+  dpu_set_t dpu;
+  uint32_t dpu_idx;
+  DPU_FOREACH(dpu_set, dpu, dpu_idx) {
+    if (dpu_idx == nr_dpus) {
+      break;
+    }
+    DPU_ASSERT(dpu_prepare_xfer(dpu, &x_padded[static_cast<size_t>(dpu_idx % part.grid_cols) * part.cols_per_dpu]));
+  }
+  DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, x_offset,
+                           part.cols_per_dpu * sizeof(inType), async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT));
+}
+
+template <typename inType, typename outType>
+void GEMV_Grid_Kernel<inType, outType>::set_params(const outType *alpha, bool async) {
+  // beta is applied by the reduction, DPUs only produce alpha * A_rc * x_c
+  params args{.rows_per_dpu = part.rows_per_dpu,
+              .nr_rows = part.rows_per_dpu,
+              .row_size = part.cols_per_dpu,
+              .alpha = *alpha,
+              .beta = 0};
+  this->set_arg_broadcast_exact("args", 0, reinterpret_cast<uint8_t *>(&args), sizeof(params), async);
+}
+
+template <typename inType, typename outType>
+void GEMV_Grid_Kernel<inType, outType>::get_y(outType *data, const outType *beta) {
+  dpu_set_t dpu;
+  uint32_t dpu_idx;
+  DPU_FOREACH(dpu_set, dpu, dpu_idx) {
+    if (dpu_idx == nr_dpus) {
+      break;
+    }
+    DPU_ASSERT(dpu_prepare_xfer(dpu, &partials[static_cast<size_t>(dpu_idx) * part.rows_per_dpu]));
+  }
+  DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, y_offset,
+                           part.rows_per_dpu * sizeof(outType), DPU_XFER_DEFAULT));
+
+  // Partials of a row block are next to each other, DPU (r, c) is r * grid_cols + c
+  for (uint32_t grid_row = 0; grid_row < part.grid_rows; grid_row++) {
+    uint32_t first_row = grid_row * part.rows_per_dpu;
+    uint32_t nr_rows = std::min(part.rows_per_dpu, m - first_row);
+    const outType *block = &partials[static_cast<size_t>(grid_row) * part.grid_cols * part.rows_per_dpu];
+    for (uint32_t i = 0; i < nr_rows; i++) {
+      outType sum = (*beta != 0) ? *beta * data[first_row + i] : 0;
+      for (uint32_t grid_col = 0; grid_col < part.grid_cols; grid_col++) {
+        sum += block[grid_col * part.rows_per_dpu + i];
+      }
+      data[first_row + i] = sum;
+    }
+  }
+}
+
+template <typename inType, typename outType>
+bool GEMV_Grid_Kernel<inType, outType>::init(uint32_t m, uint32_t n, const GEMVPartition &partition) {
+  this->m = m;
+  this->n = n;
+  this->part = partition;
+
+  if (this->allocate_n(part.nr_dpus()) == false) {
+    return false;
+  }
+
+  // Every DPU multiplies rows of cols_per_dpu elements
+  auto program =
+      select_gemv_program(program_name, part.rows_per_dpu, part.cols_per_dpu, sizeof(inType), this->nr_tasklets);
+  this->load_program(program.c_str());
+
+  A_offset = 0;
+  x_offset = alignUp(static_cast<size_t>(part.rows_per_dpu) * part.cols_per_dpu * sizeof(inType), 8);
+  y_offset = x_offset + alignUp(part.cols_per_dpu * sizeof(inType), 8);
+
+  x_padded.assign(static_cast<size_t>(part.grid_cols) * part.cols_per_dpu, 0);
+  partials.resize(static_cast<size_t>(part.nr_dpus()) * part.rows_per_dpu);
+
+  show_debug("GEMV_Grid_Kernel: grid=[{}x{}] rows_per_dpu=[{}] cols_per_dpu=[{}]", part.grid_rows, part.grid_cols,
+             part.rows_per_dpu, part.cols_per_dpu);
+  return true;
+}
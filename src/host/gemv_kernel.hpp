@@ -1,18 +1,31 @@
 #pragma once
+#include <vector>
+
 #include "kernel.hpp"
 
+// Row split GEMV, rows are spread over DPUs as evenly as pairs of rows allow (see balance_rows).
+// Every DPU gets its own nr_rows in params, A and y windows are moved with row transfer plans.
+// Kernels built with compressed_A take A zero word compressed (see share_zero_blocks.h), every DPU's rows
+// are packed on host workers and pushed as one region, the program decodes them while streaming.
+// Kernels built with padded_rows get rows that aren't 8B aligned zero padded to 8B the same way, so the program
+// only sees aligned rows of row_stride elements. Zeros only mask the tail when x can't hold NaN, integer A only.
 template <typename inType, typename outType>
 class GEMV_Kernel : public Kernel {
   struct params {
     uint32_t rows_per_dpu;
+    uint32_t nr_rows;
     uint32_t row_size;
     outType alpha;
     outType beta;
   };
 
  public:
+  // Outputs of a tasklet have to be 8B aligned, so rows go in pairs
+  static constexpr uint32_t row_alignment = 8 / sizeof(outType);
+
   GEMV_Kernel() = delete;
-  GEMV_Kernel(const std::string &program_name) : program_name(program_name) {}
+  GEMV_Kernel(const std::string &program_name, bool compressed_A = false, bool padded_rows = false)
+      : program_name(program_name), compressed_A(compressed_A), padded_rows(padded_rows) {}
 
   void set_A(const inType *data, bool async);
 
@@ -22,22 +35,46 @@ class GEMV_Kernel : public Kernel {
 
   void get_y(outType *data, bool async);
 
+  // Same as synchronous get_y, tails are always staged now
   void get_y_safe(outType *data);
 
   void set_params(const outType *alpha, const outType *beta, bool async);
 
   bool init(uint32_t m, uint32_t n);
+  // m rows are balanced over nr_dpus DPUs, rows_per_dpu only bounds the share of a DPU (MRAM size)
   bool init(uint32_t m, uint32_t n, uint32_t nr_dpus, uint32_t rows_per_dpu);
 
+  // Change number of rows of A handled by next transfers, at most nr_dpus * rows_per_dpu of init.
+  // Rows are rebalanced over the DPUs needed for m rows and params pushed again if already set.
+  void set_nr_rows(uint32_t m);
+
  private:
+  void push_params(bool async);
+  void build_plans();
+  void set_A_compressed(const inType *data, bool async);
+  void set_A_padded(const inType *data, bool async);
+  void push_A_packed(size_t nr_words, bool async);
+
   std::string program_name;
+  bool compressed_A;
+  bool padded_rows;
   uint32_t m;
   uint32_t n;
-  uint32_t rows_per_dpu;
+  // Elements between rows of A in MRAM, n unless rows are padded
+  uint32_t row_stride;
+  RowPartition part;
 
   size_t A_offset;
   size_t x_offset;
   size_t y_offset;
+
+  // Per DPU params, kept alive for async pushes
+  std::vector<params> dpu_args;
+  TransferPlan A_plan;
+  TransferPlan y_plan;
+  TransferPlan y_gather_plan;
+  // Compressed or padded A region of every DPU, kept alive for async pushes
+  std::vector<std::vector<uint64_t>> A_packed;
 };
 
 #include "gemv_kernel_impl.tpp"
@@ -49,10 +86,38 @@ class GEMVF_Kernel : public GEMV_Kernel<float, float> {
 
 class GEMV_INT8_Kernel : public GEMV_Kernel<int8_t, int> {
  public:
-  GEMV_INT8_Kernel() : GEMV_Kernel("gemv_int8.kernel") {}
+  // Padded rows keep every row on the DOT_8 path, n = 4095 runs like n = 4096
+  GEMV_INT8_Kernel(bool padded_rows = true) : GEMV_Kernel("gemv_int8.kernel", false, padded_rows) {}
+};
+
+class GEMV_INT16_Kernel : public GEMV_Kernel<int16_t, int> {
+ public:
+  // Padded rows keep every row on the DOT_4 path, same as GEMV_INT8_Kernel
+  GEMV_INT16_Kernel(bool padded_rows = true) : GEMV_Kernel("gemv_int16.kernel", false, padded_rows) {}
 };
 
 class GEMV_INT32_Kernel : public GEMV_Kernel<int, int> {
  public:
   GEMV_INT32_Kernel() : GEMV_Kernel("gemv_int32.kernel") {}
 };
+
+// 16-bit floating point A and x (bit patterns in uint16_t), float y, expanded and accumulated in float on DPUs
+class GEMV_F16_Kernel : public GEMV_Kernel<uint16_t, float> {
+ public:
+  GEMV_F16_Kernel() : GEMV_Kernel("gemv_f16.kernel") {}
+};
+
+class GEMV_BF16_Kernel : public GEMV_Kernel<uint16_t, float> {
+ public:
+  GEMV_BF16_Kernel() : GEMV_Kernel("gemv_bf16.kernel") {}
+};
+
+class GEMVF_ZB_Kernel : public GEMV_Kernel<float, float> {
+ public:
+  GEMVF_ZB_Kernel() : GEMV_Kernel("gemv_zb_f.kernel", true) {}
+};
+
+class GEMV_INT8_ZB_Kernel : public GEMV_Kernel<int8_t, int> {
+ public:
+  GEMV_INT8_ZB_Kernel() : GEMV_Kernel("gemv_zb_int8.kernel", true) {}
+};
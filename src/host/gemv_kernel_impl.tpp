@@ -1,9 +1,106 @@
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <type_traits>
+
 #include "dpu_transfer_helper.hpp"
+#include "gemv_variants.hpp"
+#include "worker_pool.hpp"
+#include "zero_blocks.hpp"
 
 template <typename inType, typename outType>
 void GEMV_Kernel<inType, outType>::set_A(const inType *data, bool async) {
-  set_arg_scatter(DPU_MRAM_HEAP_POINTER_NAME, A_offset, data, rows_per_dpu * n * sizeof(inType), m * n * sizeof(inType),
-                  async);
+  if (compressed_A) {
+    set_A_compressed(data, async);
+    return;
+  }
+  if (row_stride != n) {
+    set_A_padded(data, async);
+    return;
+  }
+  A_plan.execute(data, async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT, rank_timer.get());
+}
+
+template <typename inType, typename outType>
+void GEMV_Kernel<inType, outType>::set_A_compressed(const inType *data, bool async) {
+  size_t row_bytes = n * sizeof(inType);
+  auto &pool = WorkerPool::instance();
+  A_packed.resize(part.nr_dpus);
+  std::vector<std::future<void>> packed;
+  for (uint32_t dpu_idx = 0; dpu_idx < part.nr_dpus; dpu_idx++) {
+    packed.push_back(pool.submit([this, dpu_idx, data, row_bytes]() {
+      auto &buf = A_packed[dpu_idx];
+      buf.assign(ZB_TABLE_BYTES(part.rows_per_dpu) / 8, 0);
+      std::vector<uint32_t> row_offsets(part.rows_per_dpu, 0);
+      for (uint32_t i = 0; i < part.nr_rows(dpu_idx); i++) {
+        size_t row = part.first_row(dpu_idx) + i;
+        row_offsets[i] = static_cast<uint32_t>(buf.size() * 8);
+        if (row < m) {
+          zb_compress_row(reinterpret_cast<const uint8_t *>(data + row * n), row_bytes, buf);
+        } else {
+          // Padding row, every block is empty
+          buf.resize(buf.size() + ZB_NR_BLOCKS(row_bytes) * ZB_HEADER_BYTES / 8, 0);
+        }
+      }
+      std::memcpy(buf.data(), row_offsets.data(), row_offsets.size() * sizeof(uint32_t));
+    }));
+  }
+
+  size_t nr_words = 0;
+  for (uint32_t dpu_idx = 0; dpu_idx < part.nr_dpus; dpu_idx++) {
+    packed[dpu_idx].wait();
+    nr_words = std::max(nr_words, A_packed[dpu_idx].size());
+  }
+  show_debug("GEMV_Kernel: Compressed A to [{}] of [{}] bytes per DPU", nr_words * 8,
+             static_cast<size_t>(part.rows_per_dpu) * row_bytes);
+  push_A_packed(nr_words, async);
+}
+
+template <typename inType, typename outType>
+void GEMV_Kernel<inType, outType>::set_A_padded(const inType *data, bool async) {
+  size_t row_bytes = n * sizeof(inType);
+  size_t stride_bytes = row_stride * sizeof(inType);
+  size_t nr_words = part.rows_per_dpu * stride_bytes / 8;
+  auto &pool = WorkerPool::instance();
+  A_packed.resize(part.nr_dpus);
+  std::vector<std::future<void>> packed;
+  for (uint32_t dpu_idx = 0; dpu_idx < part.nr_dpus; dpu_idx++) {
+    packed.push_back(pool.submit([this, dpu_idx, data, row_bytes, stride_bytes, nr_words]() {
+      // Tails of the rows are never written, they stay zero from the first resize
+      auto &buf = A_packed[dpu_idx];
+      buf.resize(nr_words, 0);
+      auto *dst = reinterpret_cast<uint8_t *>(buf.data());
+      uint32_t first_row = part.first_row(dpu_idx);
+      uint32_t nr_rows = std::min(part.nr_rows(dpu_idx), m - std::min(m, first_row));
+      for (uint32_t i = 0; i < nr_rows; i++) {
+        std::memcpy(dst + i * stride_bytes, data + static_cast<size_t>(first_row + i) * n, row_bytes);
+      }
+    }));
+  }
+  for (auto &done : packed) {
+    done.wait();
+  }
+  push_A_packed(nr_words, async);
+}
+
+template <typename inType, typename outType>
+void GEMV_Kernel<inType, outType>::push_A_packed(size_t nr_words, bool async) {
+  // A single push moves the same size to every DPU
+  dpu_set_t dpu;
+  uint32_t dpu_idx;
+  DPU_FOREACH(dpu_set, dpu, dpu_idx) {
+    if (dpu_idx == part.nr_dpus) {
+      break;
+    }
+    A_packed[dpu_idx].resize(nr_words, 0);
+    DPU_ASSERT(dpu_prepare_xfer(dpu, A_packed[dpu_idx].data()));
+  }
+  DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, A_offset, nr_words * 8,
+                           async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT));
+  if (false == async) {
+    // Nothing in flight, resident A (e.g. gemv plans) doesn't keep a second copy on the host
+    A_packed.clear();
+  }
 }
 
 template <typename inType, typename outType>
@@ -13,29 +110,78 @@ void GEMV_Kernel<inType, outType>::set_x(const inType *data, bool async) {
 
 template <typename inType, typename outType>
 void GEMV_Kernel<inType, outType>::set_y(const outType *data, bool async) {
-  set_arg_scatter(DPU_MRAM_HEAP_POINTER_NAME, y_offset, data, rows_per_dpu * sizeof(outType), m * sizeof(outType), async);
+  y_plan.execute(data, async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT, rank_timer.get());
 }
 
 template <typename inType, typename outType>
 void GEMV_Kernel<inType, outType>::get_y(outType *data, bool async) {
-  get_arg_gather(DPU_MRAM_HEAP_POINTER_NAME, y_offset, data, rows_per_dpu * sizeof(outType), m * sizeof(outType), async);
+  y_gather_plan.execute(data, async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT, rank_timer.get());
 }
 
 template <typename inType, typename outType>
 void GEMV_Kernel<inType, outType>::get_y_safe(outType *data) {
-  get_arg_gather_safe(DPU_MRAM_HEAP_POINTER_NAME, y_offset, data, rows_per_dpu * sizeof(outType), m * sizeof(outType));
+  get_y(data, false);
 }
 
 template <typename inType, typename outType>
 void GEMV_Kernel<inType, outType>::set_params(const outType *alpha, const outType *beta, bool async) {
-  params args{.rows_per_dpu = this->rows_per_dpu, .row_size = n, .alpha = *alpha, .beta = *beta};
-  this->set_arg_broadcast_exact("args", 0, reinterpret_cast<uint8_t *>(&args), sizeof(params), async);
+  dpu_args.assign(1, params{.rows_per_dpu = part.rows_per_dpu, .nr_rows = 0, .row_size = row_stride, .alpha = *alpha,
+                            .beta = *beta});
+  push_params(async);
+}
+
+template <typename inType, typename outType>
+void GEMV_Kernel<inType, outType>::push_params(bool async) {
+  params args = dpu_args[0];
+  dpu_args.resize(part.nr_dpus);
+  dpu_set_t dpu;
+  uint32_t dpu_idx;
+  DPU_FOREACH(dpu_set, dpu, dpu_idx) {
+    if (dpu_idx == part.nr_dpus) {
+      break;
+    }
+    dpu_args[dpu_idx] = args;
+    dpu_args[dpu_idx].nr_rows = part.nr_rows(dpu_idx);
+    DPU_ASSERT(dpu_prepare_xfer(dpu, &dpu_args[dpu_idx]));
+  }
+  DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, "args", 0, sizeof(params),
+                           async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT));
+}
+
+template <typename inType, typename outType>
+void GEMV_Kernel<inType, outType>::build_plans() {
+  if (false == compressed_A && row_stride == n) {
+    A_plan =
+        TransferPlan::rows(dpu_set, part, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, A_offset, n * sizeof(inType));
+  }
+  y_plan = TransferPlan::rows(dpu_set, part, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, y_offset, sizeof(outType));
+  y_gather_plan =
+      TransferPlan::rows(dpu_set, part, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, y_offset, sizeof(outType));
+}
+
+template <typename inType, typename outType>
+void GEMV_Kernel<inType, outType>::set_nr_rows(uint32_t m) {
+  // MRAM layout stays as init made it
+  uint32_t rows_per_dpu = part.rows_per_dpu;
+  part = balance_rows(m, (m - 1) / rows_per_dpu + 1, row_alignment);
+  part.rows_per_dpu = rows_per_dpu;
+  this->m = m;
+  this->nr_dpus = part.nr_dpus;
+  build_plans();
+
+  if (false == dpu_args.empty()) {
+    push_params(true);
+  }
 }
 
 template <typename inType, typename outType>
 bool GEMV_Kernel<inType, outType>::init(uint32_t m, uint32_t n) {
   this->nr_dpus = 64;
-  gemv_launch_statistics<outType>(m, n, this->nr_dpus, this->rows_per_dpu);
+  uint32_t rows_per_dpu = 0;
+  // The program is picked for the share, so rows only have to come in pairs.
+  // Rows are sized in outType words, so narrower A fits more rows in MRAM.
+  uint32_t row_words = alignUp(n * sizeof(inType), 8) / sizeof(outType);
+  gemv_launch_statistics<outType>(m, row_words, this->nr_dpus, rows_per_dpu, get_dpus_per_rank(), 1);
   return this->init(m, n, nr_dpus, rows_per_dpu);
 }
 
@@ -43,18 +189,35 @@ template <typename inType, typename outType>
 bool GEMV_Kernel<inType, outType>::init(uint32_t m, uint32_t n, uint32_t nr_dpus, uint32_t rows_per_dpu) {
   this->m = m;
   this->n = n;
-  this->nr_dpus = nr_dpus;
-  this->rows_per_dpu = rows_per_dpu;
+  part = balance_rows(m, nr_dpus, row_alignment);
+  if (part.rows_per_dpu > rows_per_dpu) {
+    show_error("GEMV_Kernel: nr_dpus=[{}] x rows_per_dpu=[{}] can't hold m=[{}]", nr_dpus, rows_per_dpu, m);
+    return false;
+  }
+  this->nr_dpus = part.nr_dpus;
+  dpu_args.clear();
 
-  if (dpu_alloc(this->nr_dpus, nullptr, &this->dpu_set) != DPU_OK) {
+  if (this->allocate_n(this->nr_dpus) == false) {
     return false;
   }
 
-  this->load_program(this->program_name.c_str());
+  // Packed regions of an earlier shape would leave stale row tails
+  A_packed.clear();
+  row_stride = n;
+  if (padded_rows && false == compressed_A && std::is_integral<inType>::value) {
+    row_stride = alignUp(n * sizeof(inType), 8) / sizeof(inType);
+  }
+  auto program = select_gemv_program(program_name, part.rows_per_dpu, row_stride, sizeof(inType), this->nr_tasklets);
+  this->load_program(program.c_str());
 
   A_offset = 0;
-  x_offset = alignUp(rows_per_dpu * n * sizeof(inType), 8);
+  if (compressed_A) {
+    x_offset = ZB_REGION_BOUND(static_cast<size_t>(part.rows_per_dpu), n * sizeof(inType));
+  } else {
+    x_offset = alignUp(static_cast<size_t>(part.rows_per_dpu) * row_stride * sizeof(inType), 8);
+  }
   y_offset = x_offset + alignUp(n * sizeof(inType), 8);
+  build_plans();
 
   return true;
 }
@@ -0,0 +1,114 @@
+#pragma once
+#include <vector>
+
+#include "kernel.hpp"
+
+// GEMV over several x vectors at once: Y = alpha * A * X + beta * Y
+// X holds nr_vectors columns of size n, Y holds nr_vectors columns of size m.
+// Each block of A is read from MRAM once for every x vector, so GEMM can push several
+// columns of B per launch instead of one.
+template <typename inType, typename outType>
+class GEMV_Multi_Kernel : public Kernel {
+  struct params {
+    uint32_t rows_per_dpu;
+    uint32_t row_size;
+    uint32_t nr_vectors;
+    outType alpha;
+    outType beta;
+  };
+
+ public:
+  GEMV_Multi_Kernel() = delete;
+  GEMV_Multi_Kernel(const std::string &program_name, uint32_t max_vectors)
+      : program_name(program_name), max_vectors(max_vectors) {}
+
+  void set_A(const inType *data, bool async);
+
+  // Row major A with row stride lda. Rows are read straight from data with one push per row of the blocks,
+  // rows that aren't 8B aligned in MRAM can't be pushed one by one and go through a compact copy instead.
+  void set_A(const inType *data, uint32_t lda, bool async);
+
+  // data holds nr_vectors vectors of size n one after another
+  void set_x(const inType *data, uint32_t nr_vectors, bool async);
+
+  // Vector v starts at data + v * ld
+  void set_x(const inType *data, uint32_t ld, uint32_t nr_vectors, bool async);
+
+  // x vectors are nr_vectors consecutive columns of a row major n x ld matrix, data points to the first one.
+  // Columns are gathered into a staging buffer laid out like MRAM and pushed with a single broadcast,
+  // the buffer is reused by the next call, so the previous transfer has to be finished by then.
+  void set_x_strided(const inType *data, uint32_t ld, uint32_t nr_vectors, bool async);
+
+  // data holds nr_vectors vectors of size m one after another
+  void set_y(const outType *data, uint32_t nr_vectors, bool async);
+  void set_y(const outType *data, uint32_t ld, uint32_t nr_vectors, bool async);
+
+  void get_y_safe(outType *data, uint32_t nr_vectors);
+  void get_y_safe(outType *data, uint32_t ld, uint32_t nr_vectors);
+
+  void set_params(const outType *alpha, const outType *beta, uint32_t nr_vectors, bool async);
+
+  bool init(uint32_t m, uint32_t n, uint32_t nr_dpus, uint32_t rows_per_dpu);
+
+  uint32_t get_max_vectors() const { return max_vectors; }
+
+  // Number of vectors that fit into a single launch for given shape,
+  // 0 if the MRAM layout (always max_vectors x vectors) doesn't fit even with one.
+  // nr_tasklets is the tasklet count the kernel was built with, Kernel::nr_tasklets of an instance.
+  static uint32_t fit_nr_vectors(uint32_t n, uint32_t rows_per_dpu, uint32_t max_vectors, uint32_t nr_tasklets);
+
+ private:
+  size_t get_y_offset(uint32_t vector) const;
+
+  std::string program_name;
+  uint32_t max_vectors;
+  uint32_t m;
+  uint32_t n;
+  uint32_t rows_per_dpu;
+
+  size_t A_offset;
+  size_t x_offset;
+  size_t x_stride;
+
+  std::vector<inType> x_staging;
+  std::vector<inType> A_staging;
+};
+
+#include "gemv_multi_kernel_impl.tpp"
+
+class GEMVF_Multi_Kernel : public GEMV_Multi_Kernel<float, float> {
+ public:
+  static constexpr uint32_t max_vectors = 4;
+  GEMVF_Multi_Kernel() : GEMV_Multi_Kernel("gemv_multi_f.kernel", max_vectors) {}
+};
+
+class GEMV_INT8_Multi_Kernel : public GEMV_Multi_Kernel<int8_t, int> {
+ public:
+  static constexpr uint32_t max_vectors = 4;
+  GEMV_INT8_Multi_Kernel() : GEMV_Multi_Kernel("gemv_multi_int8.kernel", max_vectors) {}
+};
+
+class GEMV_INT16_Multi_Kernel : public GEMV_Multi_Kernel<int16_t, int> {
+ public:
+  static constexpr uint32_t max_vectors = 4;
+  GEMV_INT16_Multi_Kernel() : GEMV_Multi_Kernel("gemv_multi_int16.kernel", max_vectors) {}
+};
+
+class GEMV_INT32_Multi_Kernel : public GEMV_Multi_Kernel<int, int> {
+ public:
+  static constexpr uint32_t max_vectors = 4;
+  GEMV_INT32_Multi_Kernel() : GEMV_Multi_Kernel("gemv_multi_int32.kernel", max_vectors) {}
+};
+
+// 16-bit floating point A and X (bit patterns in uint16_t), float Y
+class GEMV_F16_Multi_Kernel : public GEMV_Multi_Kernel<uint16_t, float> {
+ public:
+  static constexpr uint32_t max_vectors = 4;
+  GEMV_F16_Multi_Kernel() : GEMV_Multi_Kernel("gemv_multi_f16.kernel", max_vectors) {}
+};
+
+class GEMV_BF16_Multi_Kernel : public GEMV_Multi_Kernel<uint16_t, float> {
+ public:
+  static constexpr uint32_t max_vectors = 4;
+  GEMV_BF16_Multi_Kernel() : GEMV_Multi_Kernel("gemv_multi_bf16.kernel", max_vectors) {}
+};
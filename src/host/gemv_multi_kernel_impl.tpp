@@ -0,0 +1,164 @@
+#include <cstring>
+
+#include "dpu_transfer_helper.hpp"
+#include "matrix_transpose.hpp"
+
+template <typename inType, typename outType>
+void GEMV_Multi_Kernel<inType, outType>::set_A(const inType *data, bool async) {
+  set_arg_scatter(DPU_MRAM_HEAP_POINTER_NAME, A_offset, data, rows_per_dpu * n * sizeof(inType), m * n * sizeof(inType),
+                  async);
+}
+
+template <typename inType, typename outType>
+void GEMV_Multi_Kernel<inType, outType>::set_A(const inType *data, uint32_t lda, bool async) {
+  if (lda == n) {
+    set_A(data, async);
+    return;
+  }
+
+  size_t row_bytes = n * sizeof(inType);
+  if (row_bytes % 8 != 0) {
+    A_staging.resize(static_cast<size_t>(m) * n);
+    for (size_t row = 0; row < m; row++) {
+      std::memcpy(&A_staging[row * n], data + row * lda, row_bytes);
+    }
+    set_A(A_staging.data(), async);
+    return;
+  }
+
+  // Row i of every block goes in a single push, DPUs whose block has no row i are skipped
+  for (uint32_t i = 0; i < rows_per_dpu; i++) {
+    dpu_set_t dpu;
+    uint32_t dpu_idx;
+    DPU_FOREACH(dpu_set, dpu, dpu_idx) {
+      if (dpu_idx == nr_dpus) {
+        break;
+      }
+      size_t row = static_cast<size_t>(dpu_idx) * rows_per_dpu + i;
+      if (row >= m) {
+        continue;
+      }
+      DPU_ASSERT(dpu_prepare_xfer(dpu, const_cast<inType *>(data + row * lda)));
+    }
+    DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, A_offset + i * row_bytes, row_bytes,
+                             DPU_XFER_ASYNC));
+  }
+
+  if (false == async) {
+    this->sync();
+  }
+}
+
+template <typename inType, typename outType>
+void GEMV_Multi_Kernel<inType, outType>::set_x(const inType *data, uint32_t nr_vectors, bool async) {
+  set_x(data, n, nr_vectors, async);
+}
+
+template <typename inType, typename outType>
+void GEMV_Multi_Kernel<inType, outType>::set_x(const inType *data, uint32_t ld, uint32_t nr_vectors, bool async) {
+  if (ld == n && n * sizeof(inType) == x_stride) {
+    // Vectors are already laid out the same way as in MRAM
+    set_arg_broadcast(DPU_MRAM_HEAP_POINTER_NAME, x_offset, data, nr_vectors * x_stride, async);
+    return;
+  }
+
+  for (uint32_t v = 0; v < nr_vectors; v++) {
+    set_arg_broadcast(DPU_MRAM_HEAP_POINTER_NAME, x_offset + v * x_stride, data + v * ld, n * sizeof(inType), async);
+  }
+}
+
+template <typename inType, typename outType>
+void GEMV_Multi_Kernel<inType, outType>::set_x_strided(const inType *data, uint32_t ld, uint32_t nr_vectors,
+                                                       bool async) {
+  size_t stride = x_stride / sizeof(inType);
+  x_staging.resize(max_vectors * stride);
+  transpose_matrix_row_major(data, x_staging.data(), n, nr_vectors, ld, stride);
+  set_arg_broadcast(DPU_MRAM_HEAP_POINTER_NAME, x_offset, x_staging.data(), nr_vectors * x_stride, async);
+}
+
+template <typename inType, typename outType>
+void GEMV_Multi_Kernel<inType, outType>::set_y(const outType *data, uint32_t nr_vectors, bool async) {
+  set_y(data, m, nr_vectors, async);
+}
+
+template <typename inType, typename outType>
+void GEMV_Multi_Kernel<inType, outType>::set_y(const outType *data, uint32_t ld, uint32_t nr_vectors, bool async) {
+  for (uint32_t v = 0; v < nr_vectors; v++) {
+    set_arg_scatter(DPU_MRAM_HEAP_POINTER_NAME, get_y_offset(v), data + v * ld, rows_per_dpu * sizeof(outType),
+                    m * sizeof(outType), async);
+  }
+}
+
+template <typename inType, typename outType>
+void GEMV_Multi_Kernel<inType, outType>::get_y_safe(outType *data, uint32_t nr_vectors) {
+  get_y_safe(data, m, nr_vectors);
+}
+
+template <typename inType, typename outType>
+void GEMV_Multi_Kernel<inType, outType>::get_y_safe(outType *data, uint32_t ld, uint32_t nr_vectors) {
+  for (uint32_t v = 0; v < nr_vectors; v++) {
+    get_arg_gather_safe(DPU_MRAM_HEAP_POINTER_NAME, get_y_offset(v), data + v * ld, rows_per_dpu * sizeof(outType),
+                        m * sizeof(outType));
+  }
+}
+
+template <typename inType, typename outType>
+void GEMV_Multi_Kernel<inType, outType>::set_params(const outType *alpha, const outType *beta, uint32_t nr_vectors,
+                                                    bool async) {
+  params args{.rows_per_dpu = this->rows_per_dpu,
+              .row_size = n,
+              .nr_vectors = nr_vectors,
+              .alpha = *alpha,
+              .beta = *beta};
+  this->set_arg_broadcast_exact("args", 0, reinterpret_cast<uint8_t *>(&args), sizeof(params), async);
+}
+
+template <typename inType, typename outType>
+bool GEMV_Multi_Kernel<inType, outType>::init(uint32_t m, uint32_t n, uint32_t nr_dpus, uint32_t rows_per_dpu) {
+  this->m = m;
+  this->n = n;
+  this->nr_dpus = nr_dpus;
+  this->rows_per_dpu = rows_per_dpu;
+
+  if (this->allocate_n(nr_dpus) == false) {
+    return false;
+  }
+
+  this->load_program(this->program_name.c_str());
+
+  A_offset = 0;
+  x_offset = alignUp(rows_per_dpu * n * sizeof(inType), 8);
+  x_stride = alignUp(n * sizeof(inType), 8);
+
+  return true;
+}
+
+template <typename inType, typename outType>
+size_t GEMV_Multi_Kernel<inType, outType>::get_y_offset(uint32_t vector) const {
+  // Y starts after max_vectors x vectors, so the layout doesn't depend on nr_vectors of a launch
+  return x_offset + max_vectors * x_stride + vector * rows_per_dpu * sizeof(outType);
+}
+
+template <typename inType, typename outType>
+uint32_t GEMV_Multi_Kernel<inType, outType>::fit_nr_vectors(uint32_t n, uint32_t rows_per_dpu, uint32_t max_vectors,
+                                                            uint32_t nr_tasklets) {
+  // Every tasklet keeps rows_per_tasklet * nr_vectors accumulators and rows_per_tasklet results in WRAM,
+  // keep them under 2KB, past 16 tasklets under the same share of WRAM the kernels leave for them
+  uint32_t wram_acc_cap = std::min(2048u, 32 * 1024 / nr_tasklets) / sizeof(outType);
+  // Rows go to tasklets in pairs, the first tasklets get one more pair
+  uint32_t rows_per_tasklet = 2 * ((rows_per_dpu / 2 + nr_tasklets - 1) / nr_tasklets);
+  rows_per_tasklet = std::max(1u, rows_per_tasklet);
+
+  uint32_t nr_vectors = std::min(max_vectors, std::max(2u, wram_acc_cap / rows_per_tasklet) - 1);
+
+  // Let's leave 1 MB, same as gemv_launch_statistics
+  constexpr size_t mem_cap = 63 * 1024 * 1024;
+  auto memory_requirement = [&](uint32_t k) {
+    return alignUp(static_cast<size_t>(rows_per_dpu) * n * sizeof(inType), 8) +
+           max_vectors * alignUp(n * sizeof(inType), 8) + k * rows_per_dpu * sizeof(outType);
+  };
+  while (nr_vectors > 0 && memory_requirement(nr_vectors) > mem_cap) {
+    nr_vectors--;
+  }
+  return nr_vectors;
+}
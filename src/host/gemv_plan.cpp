@@ -0,0 +1,77 @@
+#include "gemv_plan.hpp"
+
+#include "common.hpp"
+#include "gemv_kernel.hpp"
+
+// Keeps its kernel (and the DPUs) alive for the plan lifetime, so A stays resident in MRAM
+template <typename inType, typename outType, class Kernel>
+class GEMVPlan : public pimblas_gemv_plan {
+ public:
+  bool init(uint32_t m, uint32_t n, const inType *A) {
+    if (kernel.init(m, n) == false) {
+      return false;
+    }
+    kernel.set_A(A, false);
+    return true;
+  }
+
+  int execute(const void *x, void *y, const void *alpha, const void *beta) override {
+    auto *out = reinterpret_cast<outType *>(y);
+    auto *b = reinterpret_cast<const outType *>(beta);
+    kernel.set_params(reinterpret_cast<const outType *>(alpha), b, false);
+    kernel.set_x(reinterpret_cast<const inType *>(x), true);
+    if (*b != 0) {
+      kernel.set_y(out, true);
+    }
+    kernel.launch(true);
+    kernel.get_y(out, true);
+    kernel.sync();
+    return 0;
+  }
+
+  std::function<int()> bind(const void *x, void *y, const void *alpha, const void *beta) override {
+    outType alpha_v = *reinterpret_cast<const outType *>(alpha);
+    outType beta_v = *reinterpret_cast<const outType *>(beta);
+    return [=]() { return execute(x, y, &alpha_v, &beta_v); };
+  }
+
+ private:
+  Kernel kernel;
+};
+
+template <typename inType, typename outType, class Kernel>
+pimblas_gemv_plan *create_plan(uint32_t m, uint32_t n, const void *A) {
+  auto *plan = new GEMVPlan<inType, outType, Kernel>();
+  if (plan->init(m, n, reinterpret_cast<const inType *>(A)) == false) {
+    show_error("gemv_plan: Couldn't initialize kernel for m=[{}] n=[{}]", m, n);
+    delete plan;
+    return nullptr;
+  }
+  return plan;
+}
+
+extern "C" {
+pimblas_gemv_plan *pimblas_gemv_plan_create(uint32_t m, uint32_t n, const void *A, pimblas_dtype dtype) {
+  show_trace("pimblas_gemv_plan_create m=[{}] n=[{}] A=[{:#018x}] dtype=[{}]", m, n,
+             reinterpret_cast<const uintptr_t>(A), static_cast<int>(dtype));
+  switch (dtype) {
+    case PIMBLAS_DTYPE_FLOAT:
+      return create_plan<float, float, GEMVF_Kernel>(m, n, A);
+    case PIMBLAS_DTYPE_INT8:
+      return create_plan<int8_t, int, GEMV_INT8_Kernel>(m, n, A);
+    case PIMBLAS_DTYPE_INT32:
+      return create_plan<int, int, GEMV_INT32_Kernel>(m, n, A);
+  }
+  show_error("gemv_plan: Unsupported dtype=[{}]", static_cast<int>(dtype));
+  return nullptr;
+}
+
+int pimblas_gemv_plan_execute(pimblas_gemv_plan *plan, const void *x, void *y, const void *alpha, const void *beta) {
+  if (plan == nullptr) {
+    return -1;
+  }
+  return plan->execute(x, y, alpha, beta);
+}
+
+void pimblas_gemv_plan_destroy(pimblas_gemv_plan *plan) { delete plan; }
+}
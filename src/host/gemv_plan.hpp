@@ -0,0 +1,12 @@
+#pragma once
+
+#include <functional>
+
+#include "common.hpp"
+
+struct pimblas_gemv_plan {
+  virtual ~pimblas_gemv_plan() = default;
+  virtual int execute(const void *x, void *y, const void *alpha, const void *beta) = 0;
+  // Op running execute later, alpha and beta are copied with the element type of the plan
+  virtual std::function<int()> bind(const void *x, void *y, const void *alpha, const void *beta) = 0;
+};
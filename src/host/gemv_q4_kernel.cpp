@@ -0,0 +1,98 @@
+#include "gemv_q4_kernel.hpp"
+
+#include "dpu_transfer_helper.hpp"
+
+void GEMV_Q4_Kernel::set_A(const uint8_t *packed, bool async) {
+  A_plan.execute(packed, async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT, rank_timer.get());
+}
+
+void GEMV_Q4_Kernel::set_x(const int8_t *data, float scale, bool async) {
+  x_region.resize(Q4_X_REGION_BYTES(n, group_size));
+  q4_pack_x(data, scale, n, group_size, x_region.data());
+  set_arg_broadcast(DPU_MRAM_HEAP_POINTER_NAME, x_offset, x_region.data(), x_region.size(), async);
+}
+
+void GEMV_Q4_Kernel::set_x(const float *data, bool async) {
+  x_quantized.resize(n);
+  float scale = q4_quantize_x(data, n, x_quantized.data());
+  set_x(x_quantized.data(), scale, async);
+}
+
+void GEMV_Q4_Kernel::set_y(const float *data, bool async) {
+  y_plan.execute(data, async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT, rank_timer.get());
+}
+
+void GEMV_Q4_Kernel::get_y(float *data, bool async) {
+  y_gather_plan.execute(data, async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT, rank_timer.get());
+}
+
+void GEMV_Q4_Kernel::set_params(const float *alpha, const float *beta, bool async) {
+  dpu_args.assign(1, params{.rows_per_dpu = part.rows_per_dpu,
+                            .nr_rows = 0,
+                            .row_size = n,
+                            .group_size = group_size,
+                            .zero_points = zero_points ? 1u : 0u,
+                            .alpha = *alpha,
+                            .beta = *beta});
+  push_params(async);
+}
+
+void GEMV_Q4_Kernel::push_params(bool async) {
+  params args = dpu_args[0];
+  dpu_args.resize(part.nr_dpus);
+  dpu_set_t dpu;
+  uint32_t dpu_idx;
+  DPU_FOREACH(dpu_set, dpu, dpu_idx) {
+    if (dpu_idx == part.nr_dpus) {
+      break;
+    }
+    dpu_args[dpu_idx] = args;
+    dpu_args[dpu_idx].nr_rows = part.nr_rows(dpu_idx);
+    DPU_ASSERT(dpu_prepare_xfer(dpu, &dpu_args[dpu_idx]));
+  }
+  DPU_ASSERT(
+      dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, "args", 0, sizeof(params), async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT));
+}
+
+bool GEMV_Q4_Kernel::init(uint32_t m, uint32_t n, uint32_t group_size, bool zero_points) {
+  this->nr_dpus = 64;
+  uint32_t rows_per_dpu = 0;
+  // Sized as float rows of the same number of bytes, rows only have to come in pairs
+  uint32_t row_words = Q4_ROW_BYTES(n, group_size, zero_points) / sizeof(float);
+  gemv_launch_statistics<float>(m, row_words, this->nr_dpus, rows_per_dpu, get_dpus_per_rank(), 1);
+  return init(m, n, group_size, zero_points, this->nr_dpus, rows_per_dpu);
+}
+
+bool GEMV_Q4_Kernel::init(uint32_t m, uint32_t n, uint32_t group_size, bool zero_points, uint32_t nr_dpus,
+                          uint32_t rows_per_dpu) {
+  if (false == q4_valid_group(group_size)) {
+    show_error("GEMV_Q4_Kernel: Unsupported group_size=[{}]", group_size);
+    return false;
+  }
+  this->m = m;
+  this->n = n;
+  this->group_size = group_size;
+  this->zero_points = zero_points;
+  row_bytes = Q4_ROW_BYTES(n, group_size, zero_points);
+  part = balance_rows(m, nr_dpus, row_alignment);
+  if (part.rows_per_dpu > rows_per_dpu) {
+    show_error("GEMV_Q4_Kernel: nr_dpus=[{}] x rows_per_dpu=[{}] can't hold m=[{}]", nr_dpus, rows_per_dpu, m);
+    return false;
+  }
+  this->nr_dpus = part.nr_dpus;
+  dpu_args.clear();
+
+  if (this->allocate_n(this->nr_dpus) == false) {
+    return false;
+  }
+  this->load_program("gemv_q4.kernel");
+
+  A_offset = 0;
+  x_offset = static_cast<size_t>(part.rows_per_dpu) * row_bytes;
+  y_offset = x_offset + Q4_X_REGION_BYTES(n, group_size);
+  A_plan = TransferPlan::rows(dpu_set, part, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, A_offset, row_bytes);
+  y_plan = TransferPlan::rows(dpu_set, part, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, y_offset, sizeof(float));
+  y_gather_plan =
+      TransferPlan::rows(dpu_set, part, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, y_offset, sizeof(float));
+  return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+
+#include "kernel.hpp"
+#include "q4.hpp"
+
+// GEMV with 4-bit grouped quantized A (see share_q4.h): y = alpha * A * x + beta * y, y is float.
+// Rows are split over DPUs as in GEMV_Kernel, A rows come packed by q4_pack_row (pimblas_q4_pack).
+// x goes to the DPUs as int8 with a scale, float x is quantized on the host (absmax over the vector),
+// group sums of x are computed on the host as well, so zero points cost the kernel one multiply per group.
+class GEMV_Q4_Kernel : public Kernel {
+  struct params {
+    uint32_t rows_per_dpu;
+    uint32_t nr_rows;
+    uint32_t row_size;
+    uint32_t group_size;
+    uint32_t zero_points;
+    float alpha;
+    float beta;
+  };
+
+ public:
+  // Outputs of a tasklet have to be 8B aligned, so rows go in pairs
+  static constexpr uint32_t row_alignment = 2;
+
+  // packed holds m rows of Q4_ROW_BYTES(n, group_size, zero_points) bytes
+  void set_A(const uint8_t *packed, bool async);
+
+  // x already quantized, x[i] stands for scale * x[i]
+  void set_x(const int8_t *data, float scale, bool async);
+
+  void set_x(const float *data, bool async);
+
+  void set_y(const float *data, bool async);
+
+  void get_y(float *data, bool async);
+
+  void set_params(const float *alpha, const float *beta, bool async);
+
+  bool init(uint32_t m, uint32_t n, uint32_t group_size, bool zero_points);
+  // m rows are balanced over nr_dpus DPUs, rows_per_dpu only bounds the share of a DPU (MRAM size)
+  bool init(uint32_t m, uint32_t n, uint32_t group_size, bool zero_points, uint32_t nr_dpus, uint32_t rows_per_dpu);
+
+ private:
+  void push_params(bool async);
+
+  uint32_t m;
+  uint32_t n;
+  uint32_t group_size;
+  bool zero_points;
+  size_t row_bytes;
+  RowPartition part;
+
+  size_t A_offset;
+  size_t x_offset;
+  size_t y_offset;
+
+  // Per DPU params, kept alive for async pushes
+  std::vector<params> dpu_args;
+  TransferPlan A_plan;
+  TransferPlan y_plan;
+  TransferPlan y_gather_plan;
+  // x region as laid out in MRAM and quantized float x, kept alive for async pushes
+  std::vector<uint8_t> x_region;
+  std::vector<int8_t> x_quantized;
+};
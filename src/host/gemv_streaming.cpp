@@ -0,0 +1,23 @@
+#include "gemv_streaming.hpp"
+
+#include "common.hpp"
+
+extern "C" {
+int gemv_f_streaming(uint32_t m, uint32_t n, const float *A, const float *x, float *y, const float *alpha,
+                     const float *beta, uint32_t max_dpus) {
+  show_trace("gemv_f_streaming m=[{}] n=[{}] max_dpus=[{}]", m, n, max_dpus);
+  return gemv_streaming<float, float, GEMVF_Kernel>(m, n, A, x, y, alpha, beta, max_dpus);
+}
+
+int gemv_int8_streaming(uint32_t m, uint32_t n, const int8_t *A, const int8_t *x, int *y, const int *alpha,
+                        const int *beta, uint32_t max_dpus) {
+  show_trace("gemv_int8_streaming m=[{}] n=[{}] max_dpus=[{}]", m, n, max_dpus);
+  return gemv_streaming<int8_t, int, GEMV_INT8_Kernel>(m, n, A, x, y, alpha, beta, max_dpus);
+}
+
+int gemv_int32_streaming(uint32_t m, uint32_t n, const int *A, const int *x, int *y, const int *alpha,
+                         const int *beta, uint32_t max_dpus) {
+  show_trace("gemv_int32_streaming m=[{}] n=[{}] max_dpus=[{}]", m, n, max_dpus);
+  return gemv_streaming<int, int, GEMV_INT32_Kernel>(m, n, A, x, y, alpha, beta, max_dpus);
+}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <memory>
+
+#include "dpu_pool.hpp"
+#include "dpu_transfer_helper.hpp"
+#include "gemv_kernel.hpp"
+
+// Number of DPUs streaming GEMV uses when the caller doesn't limit it and there is no rank pool
+constexpr uint32_t STREAMING_DEFAULT_DPUS = 512;
+
+// GEMV for matrices bigger than MRAM of the DPUs we can get.
+// A is split into row slabs, every slab fits into MRAM of half of max_dpus DPUs.
+// Two kernels on disjoint halves take turns, so slab s + 1 uploads while slab s computes.
+// max_slab_rows limits slab size below what MRAM allows (0 - no limit).
+template <typename inType, typename outType, class Kernel>
+int gemv_streaming(uint32_t m, uint32_t n, const inType *A, const inType *x, outType *y, const outType *alpha,
+                   const outType *beta, uint32_t max_dpus, uint32_t max_slab_rows = 0) {
+  if (max_dpus == 0) {
+    auto &pool = DPUPool::instance();
+    max_dpus = pool.enabled() ? pool.get_nr_free_dpus() : STREAMING_DEFAULT_DPUS;
+  }
+  if (max_dpus < 2) {
+    show_error("gemv_streaming: At least two DPUs are required, max_dpus=[{}]", max_dpus);
+    return -1;
+  }
+
+  uint32_t half_dpus = max_dpus / 2;
+  uint32_t nr_dpus = half_dpus;
+  uint32_t rows_per_dpu = 0;
+  // Rows are sized in outType words, the same way as in GEMV_Kernel::init, so narrower A fits more rows.
+  // No rank rounding here, rows_per_dpu should stay as big as MRAM allows when A doesn't fit.
+  uint32_t row_words = alignUp(n * sizeof(inType), 8) / sizeof(outType);
+  uint32_t alignment = gemv_launch_statistics<outType>(m, row_words, nr_dpus, rows_per_dpu, 1);
+
+  uint64_t slab_rows = static_cast<uint64_t>(half_dpus) * rows_per_dpu;
+  if (max_slab_rows != 0 && slab_rows > max_slab_rows) {
+    // Keep rows_per_dpu a multiple of what gemv_launch_statistics aligned it to
+    rows_per_dpu = std::max(alignment, alignDown(max_slab_rows / half_dpus, alignment));
+    slab_rows = static_cast<uint64_t>(half_dpus) * rows_per_dpu;
+  }
+  slab_rows = std::min<uint64_t>(slab_rows, m);
+  uint32_t nr_slabs = (m - 1) / slab_rows + 1;
+  uint32_t slab_dpus = (slab_rows - 1) / rows_per_dpu + 1;
+
+  show_debug("gemv_streaming: m=[{}] n=[{}] nr_slabs=[{}] slab_rows=[{}] rows_per_dpu=[{}]", m, n, nr_slabs, slab_rows,
+             rows_per_dpu);
+
+  std::array<std::unique_ptr<Kernel>, 2> kernels;
+  uint32_t nr_kernels = std::min(2u, nr_slabs);
+  for (uint32_t i = 0; i < nr_kernels; i++) {
+    kernels[i] = std::unique_ptr<Kernel>(new Kernel());
+    if (kernels[i]->init(slab_rows, n, slab_dpus, rows_per_dpu) == false) {
+      show_error("gemv_streaming: Couldn't initialize kernel for slab_rows=[{}] n=[{}]", slab_rows, n);
+      return -1;
+    }
+    kernels[i]->set_params(alpha, beta, false);
+    kernels[i]->set_x(x, true);
+  }
+
+  bool has_beta = (*beta != 0);
+  for (uint32_t slab = 0; slab < nr_slabs; slab++) {
+    auto &kernel = kernels[slab % 2];
+    if (slab >= 2) {
+      // Results of the slab this kernel computed before
+      kernel->sync();
+      kernel->get_y_safe(y + (slab - 2) * slab_rows);
+    }
+
+    uint64_t first_row = slab * slab_rows;
+    uint32_t nr_rows = std::min<uint64_t>(slab_rows, m - first_row);
+    if (nr_rows != slab_rows) {
+      kernel->set_nr_rows(nr_rows);
+    }
+
+    kernel->set_A(A + first_row * n, true);
+    if (has_beta) {
+      kernel->set_y(y + first_row, true);
+    }
+    kernel->launch(true);
+  }
+
+  // Last slab of every kernel
+  for (uint32_t slab = nr_slabs - nr_kernels; slab < nr_slabs; slab++) {
+    auto &kernel = kernels[slab % 2];
+    kernel->sync();
+    kernel->get_y_safe(y + slab * slab_rows);
+  }
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include "gemv_variants.hpp"
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iterator>
+#include <vector>
+
+#include "common.hpp"
+#include "gemv_variants_table.h"
+#include "kernel.hpp"
+#include "kernel_images.hpp"
+
+namespace {
+struct VariantTable {
+  const char *program;
+  const char *base_name;
+  // Ascending
+  std::vector<uint32_t> block_sizes;
+};
+
+// Both lists come from cmake/kernel_variants.cmake, the same ones the variant binaries are built from
+const VariantTable variant_tables[] = {_PIMBLAS_GEMV_VARIANT_TABLES_};
+
+constexpr uint32_t variant_tasklets[] = {_PIMBLAS_GEMV_VARIANT_TASKLETS_};
+
+const VariantTable *find_table(const std::string &program) {
+  for (auto &table : variant_tables) {
+    if (program == table.program) {
+      return &table;
+    }
+  }
+  return nullptr;
+}
+
+std::string variant_name(const VariantTable &table, const GEMVVariant &variant) {
+  return std::string(table.base_name) + "_b" + std::to_string(variant.block_size) + "_t" +
+         std::to_string(variant.nr_tasklets) + (variant.aligned_rows ? "_a" : "_u") + ".kernel";
+}
+
+// Same lookup order as Kernel::load_program
+bool kernel_available(const std::string &name) {
+  if (find_kernel_image(name.c_str()) != nullptr && std::getenv("PIMBLAS_KERNEL_DIR") == nullptr) {
+    return true;
+  }
+  char *path = pimblas_get_kernel_dir_concat_free(name.c_str());
+  bool exists = access(path, R_OK) == 0;
+  free(path);
+  return exists;
+}
+}  // namespace
+
+GEMVVariant select_gemv_variant(const std::string &program, uint32_t rows_per_dpu, uint32_t n, size_t elem_size) {
+  GEMVVariant variant{
+      .block_size = 0, .nr_tasklets = Kernel::base_nr_tasklets, .aligned_rows = (n * elem_size) % 8 == 0};
+  const VariantTable *table = find_table(program);
+  if (table == nullptr) {
+    return variant;
+  }
+
+  // Rows go to tasklets in pairs, tasklets past the last pair would only wait at the barriers
+  uint32_t nr_pairs = (rows_per_dpu + 1) / 2;
+  variant.nr_tasklets = variant_tasklets[sizeof(variant_tasklets) / sizeof(variant_tasklets[0]) - 1];
+  for (auto tasklets : variant_tasklets) {
+    if (tasklets >= nr_pairs) {
+      variant.nr_tasklets = tasklets;
+      break;
+    }
+  }
+
+  // Every row reads a whole block of A, so short rows take the smallest block holding them,
+  // long ones the largest block WRAM allows
+  variant.block_size = table->block_sizes.back();
+  for (auto block_size : table->block_sizes) {
+    if (block_size >= n) {
+      variant.block_size = block_size;
+      break;
+    }
+  }
+  return variant;
+}
+
+std::string select_gemv_program(const std::string &program, uint32_t rows_per_dpu, uint32_t n, size_t elem_size,
+                                uint32_t &nr_tasklets) {
+  nr_tasklets = Kernel::base_nr_tasklets;
+  const VariantTable *table = find_table(program);
+  if (table == nullptr) {
+    return program;
+  }
+
+  auto variant = select_gemv_variant(program, rows_per_dpu, n, elem_size);
+  auto name = variant_name(*table, variant);
+  if (false == kernel_available(name)) {
+    show_debug("gemv_variants: {} is missing, using {}", name, program);
+    return program;
+  }
+  nr_tasklets = variant.nr_tasklets;
+  return name;
+}
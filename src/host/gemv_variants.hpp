@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Compile time variants of the GEMV kernels, built from cmake/kernel_variants.cmake
+struct GEMVVariant {
+  // Elements of A per block
+  uint32_t block_size;
+  uint32_t nr_tasklets;
+  // Rows start 8B aligned in MRAM, the unaligned read path is compiled out
+  bool aligned_rows;
+};
+
+// Picks the variant of program (e.g. "gemv_f.kernel") for a DPU share of rows_per_dpu rows of n elements,
+// elem_size bytes per element of A: the smallest block holding a whole row, or the largest one for long rows,
+// the aligned row path whenever rows allow it and the fewest tasklets that still give every pair of rows its own
+// tasklet. Returns program itself if it has no variants or the variant binary is missing, nr_tasklets is set to
+// the tasklet count of the returned program.
+std::string select_gemv_program(const std::string &program, uint32_t rows_per_dpu, uint32_t n, size_t elem_size,
+                                uint32_t &nr_tasklets);
+
+// Variant select_gemv_program would pick, without checking the binary exists
+GEMVVariant select_gemv_variant(const std::string &program, uint32_t rows_per_dpu, uint32_t n, size_t elem_size);
@@ -1,27 +1,60 @@
 #include "kernel.hpp"
 
-#include <array>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
+#include "dpu_pool.hpp"
 #include "dpu_transfer_helper.hpp"
+#include "kernel_images.hpp"
+
+namespace {
+struct CompletionContext {
+  CompletionContext(uint32_t nr_ranks, std::function<void()> on_done)
+      : remaining(nr_ranks), on_done(std::move(on_done)) {}
+  std::atomic<uint32_t> remaining;
+  std::function<void()> on_done;
+};
+
+// Called once per rank, the last rank to finish fires on_done
+dpu_error_t completion_callback(dpu_set_t /*rank*/, uint32_t /*rank_id*/, void *arg) {
+  auto *ctx = reinterpret_cast<CompletionContext *>(arg);
+  if (--ctx->remaining == 0) {
+    ctx->on_done();
+    delete ctx;
+  }
+  return DPU_OK;
+}
+}  // namespace
+
+#ifndef KERNEL_NR_TASKLETS
+#define KERNEL_NR_TASKLETS 16
+#endif
+const uint32_t Kernel::base_nr_tasklets = KERNEL_NR_TASKLETS;
 
-Kernel::~Kernel() { free_dpus(); }
+Kernel::~Kernel() {
+  if (rank_timer && nr_dpus != 0) {
+    sync();
+  }
+  // Leased ranks go back to the pool and keep their state, everything else is freed.
+  if (false == DPUPool::instance().release(dpu_set)) {
+    free_dpus();
+  }
+}
 
 void Kernel::set_arg_scatter(const char *sym_name, size_t sym_offset, const void *data, size_t chunk_size, size_t size,
                              bool async) {
-  if (async) {
-    transfer_chunks(dpu_set, nr_dpus, DPU_XFER_TO_DPU, DPU_XFER_ASYNC, sym_name, sym_offset,
-                    reinterpret_cast<const uint8_t *>(data), chunk_size, size);
-  } else {
-    transfer_chunks(dpu_set, nr_dpus, DPU_XFER_TO_DPU, DPU_XFER_DEFAULT, sym_name, sym_offset,
-                    reinterpret_cast<const uint8_t *>(data), chunk_size, size);
-  }
+  get_chunk_plan(DPU_XFER_TO_DPU, sym_name, sym_offset, chunk_size, size)
+      .execute(data, async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT, rank_timer.get());
 }
 
 void Kernel::set_arg_broadcast(const char *sym_name, size_t sym_offset, const void *data, size_t size, bool async) {
   if (async) {
-    transfer_full(dpu_set, DPU_XFER_ASYNC, sym_name, sym_offset, reinterpret_cast<const uint8_t *>(data), size);
+    transfer_full(dpu_set, DPU_XFER_ASYNC, sym_name, sym_offset, reinterpret_cast<const uint8_t *>(data), size,
+                  rank_timer.get());
   } else {
-    transfer_full(dpu_set, DPU_XFER_DEFAULT, sym_name, sym_offset, reinterpret_cast<const uint8_t *>(data), size);
+    transfer_full(dpu_set, DPU_XFER_DEFAULT, sym_name, sym_offset, reinterpret_cast<const uint8_t *>(data), size,
+                  rank_timer.get());
   }
 }
 
@@ -36,28 +69,61 @@ void Kernel::set_arg_broadcast_exact(const char *sym_name, size_t sym_offset, co
 
 void Kernel::get_arg_gather(const char *sym_name, size_t sym_offset, void *data, size_t chunk_size, size_t size,
                             bool async) {
-  if (async) {
-    transfer_chunks(dpu_set, nr_dpus, DPU_XFER_FROM_DPU, DPU_XFER_ASYNC, sym_name, sym_offset,
-                    reinterpret_cast<uint8_t *>(data), chunk_size, size);
-  } else {
-    transfer_chunks(dpu_set, nr_dpus, DPU_XFER_FROM_DPU, DPU_XFER_DEFAULT, sym_name, sym_offset,
-                    reinterpret_cast<uint8_t *>(data), chunk_size, size);
-  }
+  get_chunk_plan(DPU_XFER_FROM_DPU, sym_name, sym_offset, chunk_size, size)
+      .execute(data, async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT, rank_timer.get());
 }
 
 void Kernel::get_arg_copy_each(const char *sym_name, size_t sym_offset, void *data, size_t size) {
   dpu_set_t dpu;
   uint32_t idx;
   DPU_FOREACH(dpu_set, dpu, idx) {
+    if (idx == nr_dpus) {
+      break;
+    }
     DPU_ASSERT(dpu_copy_from(dpu, sym_name, sym_offset, reinterpret_cast<uint8_t *>(data) + idx * size, size));
   }
 }
 
 void Kernel::get_arg_gather_safe(const char *sym_name, size_t sym_offset, void *data, size_t chunk_size, size_t size) {
-  safe_gather(dpu_set, nr_dpus, sym_name, sym_offset, reinterpret_cast<uint8_t *>(data), chunk_size, size);
+  get_arg_gather(sym_name, sym_offset, data, chunk_size, size, false);
+}
+
+TransferPlan &Kernel::get_chunk_plan(dpu_xfer_t xfer, const char *sym_name, size_t sym_offset, size_t chunk_size,
+                                     size_t size) {
+  PlanKey key{xfer, sym_name, sym_offset, chunk_size, size, nr_dpus};
+  auto it = chunk_plans.find(key);
+  if (it == chunk_plans.end()) {
+    it = chunk_plans
+             .emplace(key, TransferPlan::chunks(dpu_set, nr_dpus, xfer, sym_name, sym_offset, chunk_size, size))
+             .first;
+  }
+  return it->second;
+}
+
+void Kernel::idle_spare_dpus(bool async) {
+  if (idle_flags_set) {
+    return;
+  }
+  idle_flags_set = true;
+
+  uint32_t nr_set_dpus = 0;
+  DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &nr_set_dpus));
+  // Freshly loaded programs start with dpu_idle clear everywhere
+  if (nr_set_dpus <= nr_dpus && false == program_reused) {
+    return;
+  }
+
+  idle_flags.assign(nr_set_dpus, 0);
+  std::fill(idle_flags.begin() + std::min(nr_dpus, nr_set_dpus), idle_flags.end(), 1);
+  dpu_set_t dpu;
+  uint32_t idx;
+  DPU_FOREACH(dpu_set, dpu, idx) { DPU_ASSERT(dpu_prepare_xfer(dpu, &idle_flags[idx])); }
+  DPU_ASSERT(dpu_push_xfer(dpu_set, DPU_XFER_TO_DPU, "dpu_idle", 0, sizeof(uint32_t),
+                           async ? DPU_XFER_ASYNC : DPU_XFER_DEFAULT));
 }
 
 void Kernel::launch(bool async) {
+  idle_spare_dpus(async);
   if (async) {
     DPU_ASSERT(dpu_launch(dpu_set, DPU_ASYNCHRONOUS));
   } else {
@@ -66,22 +132,41 @@ void Kernel::launch(bool async) {
 }
 
 void Kernel::load_program(const char *name) {
-  char *kernel_path = pimblas_get_kernel_dir_concat_free(name);
-  show_debug("kern_path = {}", kernel_path);
-  DPU_ASSERT(dpu_load(dpu_set, kernel_path, &program));
-  free(kernel_path);
+  auto &pool = DPUPool::instance();
+  idle_flags_set = false;
+  program_reused = pool.has_program(dpu_set, name);
+  if (program_reused) {
+    show_trace("Program {} already loaded", name);
+    return;
+  }
+
+  DPU_ASSERT(pimblas_dpu_load(dpu_set, name, &program));
+  pool.set_program(dpu_set, name);
 }
 
-void Kernel::load_program(uint8_t *data, size_t size) {
-  DPU_ASSERT(dpu_load_from_memory(dpu_set, data, size, &program));
+void Kernel::load_program(const uint8_t *data, size_t size) {
+  DPU_ASSERT(dpu_load_from_memory(dpu_set, const_cast<uint8_t *>(data), size, &program));
+  idle_flags_set = false;
+  program_reused = false;
+  // Unnamed program, make sure the next named load doesn't get skipped
+  DPUPool::instance().set_program(dpu_set, "");
 }
 
 void Kernel::set_dpu_set(dpu_set_t dpu_set, uint32_t nr_dpus) {
+  chunk_plans.clear();
+  idle_flags_set = false;
   this->dpu_set = dpu_set;
   this->nr_dpus = nr_dpus;
 }
 
 bool Kernel::allocate_n(uint32_t nr_dpus) {
+  chunk_plans.clear();
+  idle_flags_set = false;
+  if (DPUPool::instance().lease(nr_dpus, this->dpu_set)) {
+    this->nr_dpus = nr_dpus;
+    return true;
+  }
+
   if (dpu_alloc(nr_dpus, nullptr, &this->dpu_set) != DPU_OK) {
     return false;
   }
@@ -97,9 +182,22 @@ const KernelStatus &Kernel::get_status() {
   return status;
 }
 
+void Kernel::notify_when_done(std::function<void()> on_done) {
+  uint32_t nr_ranks = 0;
+  DPU_ASSERT(dpu_get_nr_ranks(dpu_set, &nr_ranks));
+  auto *ctx = new CompletionContext(nr_ranks, std::move(on_done));
+  DPU_ASSERT(dpu_callback(dpu_set, completion_callback, ctx, DPU_CALLBACK_ASYNC));
+}
+
 void Kernel::read_log(FILE *stream) {
   dpu_set_t dpu;
-  DPU_FOREACH(dpu_set, dpu) { dpu_log_read(dpu, stream); }
+  uint32_t idx;
+  DPU_FOREACH(dpu_set, dpu, idx) {
+    if (idx == nr_dpus) {
+      break;
+    }
+    dpu_log_read(dpu, stream);
+  }
 }
 
 void Kernel::free_dpus() {
@@ -113,11 +211,21 @@ std::vector<PerfResults> Kernel::get_perf_results() {
   std::vector<PerfResults> results;
 
   dpu_set_t dpu;
-  DPU_FOREACH(dpu_set, dpu) {
-    std::array<uint32_t, 16> nb_cycles;
-    std::array<uint32_t, 16> nb_instr;
-    DPU_ASSERT(dpu_copy_from(dpu, "nb_cycles", 0, nb_cycles.data(), sizeof(uint32_t) * 16));
-    DPU_ASSERT(dpu_copy_from(dpu, "nb_instructions", 0, nb_instr.data(), sizeof(uint32_t) * 16));
+  uint32_t idx;
+  DPU_FOREACH(dpu_set, dpu, idx) {
+    if (idx == nr_dpus) {
+      break;
+    }
+    std::vector<uint32_t> nb_cycles(nr_tasklets);
+    std::vector<uint32_t> nb_instr(nr_tasklets);
+    dpu_error_t status = dpu_copy_from(dpu, "nb_cycles", 0, nb_cycles.data(), sizeof(uint32_t) * nr_tasklets);
+    if (status != DPU_OK && idx == 0) {
+      // Counters are only there with KERNEL_PERF_COUNTERS
+      show_warn("Kernel: Program has no perf counters");
+      return {};
+    }
+    DPU_ASSERT(status);
+    DPU_ASSERT(dpu_copy_from(dpu, "nb_instructions", 0, nb_instr.data(), sizeof(uint32_t) * nr_tasklets));
 
     results.push_back(PerfResults{.nb_cycles = *std::max_element(nb_cycles.begin(), nb_cycles.end()),
                                   .nb_instr = *std::max_element(nb_instr.begin(), nb_instr.end())});
@@ -125,3 +233,20 @@ std::vector<PerfResults> Kernel::get_perf_results() {
 
   return results;
 }
+
+void Kernel::enable_rank_timing(bool enable) {
+  if (enable && rank_timer == nullptr) {
+    rank_timer = std::unique_ptr<RankTimer>(new RankTimer());
+  } else if (false == enable && rank_timer) {
+    // Callbacks still queued on the ranks point to the timer
+    sync();
+    rank_timer.reset();
+  }
+}
+
+std::vector<RankTransferStats> Kernel::get_rank_transfer_stats() {
+  if (rank_timer == nullptr) {
+    return {};
+  }
+  return rank_timer->get_stats();
+}
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "common.hpp"
+#include "dpu_transfer_helper.hpp"
+#include "transfer_plan.hpp"
 
 struct KernelStatus {
   bool done;
@@ -25,6 +31,9 @@ class Kernel {
   Kernel(Kernel &&) = delete;
   Kernel &operator=(Kernel &&) = delete;
 
+  // NR_TASKLETS the plain kernels are built with
+  static const uint32_t base_nr_tasklets;
+
   void set_arg_scatter(const char *sym_name, size_t sym_offset, const void *data, size_t chunk_size, size_t size,
                        bool async);
   void set_arg_broadcast(const char *sym_name, size_t sym_offset, const void *data, size_t size, bool async);
@@ -36,7 +45,7 @@ class Kernel {
   void launch(bool async);
 
   void load_program(const char *name);
-  void load_program(uint8_t *data, size_t size);
+  void load_program(const uint8_t *data, size_t size);
 
   dpu_set_t &get_dpu_set() { return dpu_set; }
   uint32_t get_nr_dpus() { return nr_dpus; }
@@ -45,16 +54,41 @@ class Kernel {
 
   void sync();
   const KernelStatus &get_status();
+  // Calls on_done (from a runtime thread) once all async work queued so far has finished
+  void notify_when_done(std::function<void()> on_done);
 
   void read_log(FILE *stream = stdout);
 
+  // Max over the nr_tasklets tasklets of every DPU, empty if the program was built without perf counters
   std::vector<PerfResults> get_perf_results();
 
+  // Per rank timing of transfers issued by this kernel, stats are complete after sync()
+  void enable_rank_timing(bool enable);
+  std::vector<RankTransferStats> get_rank_transfer_stats();
+
  protected:
   void free_dpus();
 
-  dpu_set_t dpu_set;
-  uint32_t nr_dpus;
-  dpu_program_t *program;
-  KernelStatus status;
+  // Plans of set_arg_scatter/get_arg_gather are built on first use and reused while the DPU set stays the same
+  TransferPlan &get_chunk_plan(dpu_xfer_t xfer, const char *sym_name, size_t sym_offset, size_t chunk_size,
+                               size_t size);
+  // Leased ranks can hold more DPUs than nr_dpus, sets dpu_idle of the spares before the first launch
+  void idle_spare_dpus(bool async);
+
+  dpu_set_t dpu_set{};
+  uint32_t nr_dpus = 0;
+  dpu_program_t *program = nullptr;
+  // Tasklets of the loaded program, kernels running variants built with other counts set it
+  uint32_t nr_tasklets = base_nr_tasklets;
+  KernelStatus status{};
+  std::unique_ptr<RankTimer> rank_timer;
+
+ private:
+  using PlanKey = std::tuple<dpu_xfer_t, std::string, size_t, size_t, size_t, uint32_t>;
+  std::map<PlanKey, TransferPlan> chunk_plans;
+  // dpu_idle of every DPU of the set, kept alive for async pushes
+  std::vector<uint32_t> idle_flags;
+  bool idle_flags_set = false;
+  // Program was already on the leased ranks, their dpu_idle flags are left from the last lease
+  bool program_reused = false;
 };
\ No newline at end of file
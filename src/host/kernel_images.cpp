@@ -0,0 +1,39 @@
+#include "kernel_images.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "common.hpp"
+
+#ifdef EMBED_KERNELS
+#include "pimblas_kernels.h"
+#else
+#define _PIMBLAS_EMBEDDED_KERNELS_
+#endif
+
+namespace {
+const KernelImage kernel_images[] = {_PIMBLAS_EMBEDDED_KERNELS_{nullptr, nullptr, 0}};
+}
+
+const KernelImage *find_kernel_image(const char *name) {
+  for (const KernelImage *image = kernel_images; image->name != nullptr; image++) {
+    if (strcmp(image->name, name) == 0) {
+      return image;
+    }
+  }
+  return nullptr;
+}
+
+dpu_error_t pimblas_dpu_load(dpu_set_t set, const char *name, dpu_program_t **program) {
+  // Custom kernel dir always wins over the embedded images
+  const KernelImage *image = find_kernel_image(name);
+  if (image != nullptr && std::getenv("PIMBLAS_KERNEL_DIR") == nullptr) {
+    show_debug("Loading embedded kernel {}", name);
+    return dpu_load_from_memory(set, const_cast<uint8_t *>(image->data), image->size, program);
+  }
+  char *kernel_path = pimblas_get_kernel_dir_concat_free(name);
+  show_debug("kern_path = {}", kernel_path);
+  dpu_error_t status = dpu_load(set, kernel_path, program);
+  free(kernel_path);
+  return status;
+}
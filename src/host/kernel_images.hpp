@@ -0,0 +1,19 @@
+#pragma once
+#include <dpu.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// DPU kernel binaries embedded into libpimblas at build time (EMBED_KERNELS)
+struct KernelImage {
+  const char *name;
+  const uint8_t *data;
+  size_t size;
+};
+
+// Returns nullptr if there's no embedded image for the given kernel name
+const KernelImage *find_kernel_image(const char *name);
+
+// Loads a kernel from its embedded image, or from the kernel dir when PIMBLAS_KERNEL_DIR is set or there's
+// no image. Shared by Kernel::load_program and the C entry points (declared in common.h as well).
+extern "C" dpu_error_t pimblas_dpu_load(dpu_set_t set, const char *name, dpu_program_t **program);
@@ -54,7 +54,8 @@ void transpose8x8_block(const int32_t *src, int32_t *dst, size_t src_stride, siz
   _mm256_storeu_si256(reinterpret_cast<__m256i *>(&dst[7 * dst_stride]), o7);
 }
 
-void transpose_matrix_column_major(const int32_t *src, int32_t *dst, size_t rows, size_t cols) {
+void transpose_matrix_column_major(const int32_t *src, int32_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                   size_t dst_ld) {
   constexpr size_t block_size = 8;
 
   for (size_t i = 0; i < cols; i += block_size) {
@@ -63,11 +64,11 @@ void transpose_matrix_column_major(const int32_t *src, int32_t *dst, size_t rows
       size_t block_cols = std::min(block_size, cols - i);
 
       if (block_rows == 8 && block_cols == 8) {
-        transpose8x8_block(&src[i * rows + j], &dst[j * cols + i], rows, cols);
+        transpose8x8_block(&src[i * src_ld + j], &dst[j * dst_ld + i], src_ld, dst_ld);
       } else {
         for (size_t ii = 0; ii < block_cols; ii++) {
           for (size_t jj = 0; jj < block_rows; jj++) {
-            dst[(j + jj) * cols + (i + ii)] = src[(i + ii) * rows + (j + jj)];
+            dst[(j + jj) * dst_ld + (i + ii)] = src[(i + ii) * src_ld + (j + jj)];
           }
         }
       }
@@ -75,7 +76,12 @@ void transpose_matrix_column_major(const int32_t *src, int32_t *dst, size_t rows
   }
 }
 
-void transpose_matrix_row_major(const int32_t *src, int32_t *dst, size_t rows, size_t cols) {
+void transpose_matrix_column_major(const int32_t *src, int32_t *dst, size_t rows, size_t cols) {
+  transpose_matrix_column_major(src, dst, rows, cols, rows, cols);
+}
+
+void transpose_matrix_row_major(const int32_t *src, int32_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                size_t dst_ld) {
   constexpr size_t block_size = 8;
 
   for (size_t i = 0; i < rows; i += block_size) {
@@ -84,11 +90,11 @@ void transpose_matrix_row_major(const int32_t *src, int32_t *dst, size_t rows, s
       size_t block_cols = std::min(block_size, cols - j);
 
       if (block_rows == 8 && block_cols == 8) {
-        transpose8x8_block(&src[i * cols + j], &dst[j * rows + i], cols, rows);
+        transpose8x8_block(&src[i * src_ld + j], &dst[j * dst_ld + i], src_ld, dst_ld);
       } else {
         for (size_t ii = 0; ii < block_rows; ii++) {
           for (size_t jj = 0; jj < block_cols; jj++) {
-            dst[(j + jj) * rows + (i + ii)] = src[(i + ii) * cols + (j + jj)];
+            dst[(j + jj) * dst_ld + (i + ii)] = src[(i + ii) * src_ld + (j + jj)];
           }
         }
       }
@@ -96,6 +102,10 @@ void transpose_matrix_row_major(const int32_t *src, int32_t *dst, size_t rows, s
   }
 }
 
+void transpose_matrix_row_major(const int32_t *src, int32_t *dst, size_t rows, size_t cols) {
+  transpose_matrix_row_major(src, dst, rows, cols, cols, rows);
+}
+
 void transpose8x8_block(const int8_t *src, size_t src_stride, int8_t *dst, size_t dst_stride) {
   __m128i row0 = _mm_loadl_epi64((const __m128i *)(src + 0 * src_stride));
   __m128i row1 = _mm_loadl_epi64((const __m128i *)(src + 1 * src_stride));
@@ -139,7 +149,8 @@ void transpose8x8_block(const int8_t *src, size_t src_stride, int8_t *dst, size_
   _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + 7 * dst_stride), _mm_srli_si128(o3, 8));
 }
 
-void transpose_matrix_column_major(const int8_t *src, int8_t *dst, size_t rows, size_t cols) {
+void transpose_matrix_column_major(const int8_t *src, int8_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                   size_t dst_ld) {
   constexpr size_t block_size = 8;
 
   for (size_t i = 0; i < cols; i += block_size) {
@@ -148,11 +159,11 @@ void transpose_matrix_column_major(const int8_t *src, int8_t *dst, size_t rows,
       size_t block_cols = std::min(block_size, cols - i);
 
       if (block_rows == 8 && block_cols == 8) {
-        transpose8x8_block(&src[i * rows + j], rows, &dst[j * cols + i], cols);
+        transpose8x8_block(&src[i * src_ld + j], src_ld, &dst[j * dst_ld + i], dst_ld);
       } else {
         for (size_t ii = 0; ii < block_cols; ii++) {
           for (size_t jj = 0; jj < block_rows; jj++) {
-            dst[(j + jj) * cols + (i + ii)] = src[(i + ii) * rows + (j + jj)];
+            dst[(j + jj) * dst_ld + (i + ii)] = src[(i + ii) * src_ld + (j + jj)];
           }
         }
       }
@@ -160,7 +171,12 @@ void transpose_matrix_column_major(const int8_t *src, int8_t *dst, size_t rows,
   }
 }
 
-void transpose_matrix_row_major(const int8_t *src, int8_t *dst, size_t rows, size_t cols) {
+void transpose_matrix_column_major(const int8_t *src, int8_t *dst, size_t rows, size_t cols) {
+  transpose_matrix_column_major(src, dst, rows, cols, rows, cols);
+}
+
+void transpose_matrix_row_major(const int8_t *src, int8_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                size_t dst_ld) {
   constexpr size_t block_size = 8;
 
   for (size_t i = 0; i < rows; i += block_size) {
@@ -169,11 +185,11 @@ void transpose_matrix_row_major(const int8_t *src, int8_t *dst, size_t rows, siz
       size_t block_cols = std::min(block_size, cols - j);
 
       if (block_rows == 8 && block_cols == 8) {
-        transpose8x8_block(&src[i * cols + j], cols, &dst[j * rows + i], rows);
+        transpose8x8_block(&src[i * src_ld + j], src_ld, &dst[j * dst_ld + i], dst_ld);
       } else {
         for (size_t ii = 0; ii < block_rows; ii++) {
           for (size_t jj = 0; jj < block_cols; jj++) {
-            dst[(j + jj) * rows + (i + ii)] = src[(i + ii) * cols + (j + jj)];
+            dst[(j + jj) * dst_ld + (i + ii)] = src[(i + ii) * src_ld + (j + jj)];
           }
         }
       }
@@ -181,6 +197,10 @@ void transpose_matrix_row_major(const int8_t *src, int8_t *dst, size_t rows, siz
   }
 }
 
+void transpose_matrix_row_major(const int8_t *src, int8_t *dst, size_t rows, size_t cols) {
+  transpose_matrix_row_major(src, dst, rows, cols, cols, rows);
+}
+
 void transpose8x8_block(const float *src, float *dst, size_t src_stride, size_t dst_stride) {
   auto col0 = _mm256_loadu_ps(&src[0 * src_stride]);
   auto col1 = _mm256_loadu_ps(&src[1 * src_stride]);
@@ -228,7 +248,8 @@ void transpose8x8_block(const float *src, float *dst, size_t src_stride, size_t
   _mm256_storeu_ps(&dst[7 * dst_stride], p7);
 }
 
-void transpose_matrix_column_major(const float *src, float *dst, size_t rows, size_t cols) {
+void transpose_matrix_column_major(const float *src, float *dst, size_t rows, size_t cols, size_t src_ld,
+                                   size_t dst_ld) {
   constexpr size_t block_size = 8;
 
   for (size_t i = 0; i < cols; i += block_size) {
@@ -237,11 +258,36 @@ void transpose_matrix_column_major(const float *src, float *dst, size_t rows, si
       size_t block_cols = std::min(block_size, cols - i);
 
       if (block_rows == 8 && block_cols == 8) {
-        transpose8x8_block(&src[i * rows + j], &dst[j * cols + i], rows, cols);
+        transpose8x8_block(&src[i * src_ld + j], &dst[j * dst_ld + i], src_ld, dst_ld);
       } else {
         for (size_t ii = 0; ii < block_cols; ii++) {
           for (size_t jj = 0; jj < block_rows; jj++) {
-            dst[(j + jj) * cols + (i + ii)] = src[(i + ii) * rows + (j + jj)];
+            dst[(j + jj) * dst_ld + (i + ii)] = src[(i + ii) * src_ld + (j + jj)];
+          }
+        }
+      }
+    }
+  }
+}
+
+void transpose_matrix_column_major(const float *src, float *dst, size_t rows, size_t cols) {
+  transpose_matrix_column_major(src, dst, rows, cols, rows, cols);
+}
+
+void transpose_matrix_row_major(const float *src, float *dst, size_t rows, size_t cols, size_t src_ld, size_t dst_ld) {
+  constexpr size_t block_size = 8;
+
+  for (size_t i = 0; i < rows; i += block_size) {
+    for (size_t j = 0; j < cols; j += block_size) {
+      size_t block_rows = std::min(block_size, rows - i);
+      size_t block_cols = std::min(block_size, cols - j);
+
+      if (block_rows == 8 && block_cols == 8) {
+        transpose8x8_block(&src[i * src_ld + j], &dst[j * dst_ld + i], src_ld, dst_ld);
+      } else {
+        for (size_t ii = 0; ii < block_rows; ii++) {
+          for (size_t jj = 0; jj < block_cols; jj++) {
+            dst[(j + jj) * dst_ld + (i + ii)] = src[(i + ii) * src_ld + (j + jj)];
           }
         }
       }
@@ -250,6 +296,77 @@ void transpose_matrix_column_major(const float *src, float *dst, size_t rows, si
 }
 
 void transpose_matrix_row_major(const float *src, float *dst, size_t rows, size_t cols) {
+  transpose_matrix_row_major(src, dst, rows, cols, cols, rows);
+}
+
+void transpose8x8_block(const uint16_t *src, size_t src_stride, uint16_t *dst, size_t dst_stride) {
+  __m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 0 * src_stride));
+  __m128i row1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 1 * src_stride));
+  __m128i row2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * src_stride));
+  __m128i row3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 3 * src_stride));
+  __m128i row4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * src_stride));
+  __m128i row5 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 5 * src_stride));
+  __m128i row6 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 6 * src_stride));
+  __m128i row7 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 7 * src_stride));
+
+  // Pairs of rows, columns 0-3 and 4-7
+  __m128i t0 = _mm_unpacklo_epi16(row0, row1);
+  __m128i t1 = _mm_unpackhi_epi16(row0, row1);
+  __m128i t2 = _mm_unpacklo_epi16(row2, row3);
+  __m128i t3 = _mm_unpackhi_epi16(row2, row3);
+  __m128i t4 = _mm_unpacklo_epi16(row4, row5);
+  __m128i t5 = _mm_unpackhi_epi16(row4, row5);
+  __m128i t6 = _mm_unpacklo_epi16(row6, row7);
+  __m128i t7 = _mm_unpackhi_epi16(row6, row7);
+
+  // Quads of rows, two columns each
+  __m128i tt0 = _mm_unpacklo_epi32(t0, t2);
+  __m128i tt1 = _mm_unpackhi_epi32(t0, t2);
+  __m128i tt2 = _mm_unpacklo_epi32(t1, t3);
+  __m128i tt3 = _mm_unpackhi_epi32(t1, t3);
+  __m128i tt4 = _mm_unpacklo_epi32(t4, t6);
+  __m128i tt5 = _mm_unpackhi_epi32(t4, t6);
+  __m128i tt6 = _mm_unpacklo_epi32(t5, t7);
+  __m128i tt7 = _mm_unpackhi_epi32(t5, t7);
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 0 * dst_stride), _mm_unpacklo_epi64(tt0, tt4));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 1 * dst_stride), _mm_unpackhi_epi64(tt0, tt4));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * dst_stride), _mm_unpacklo_epi64(tt1, tt5));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 3 * dst_stride), _mm_unpackhi_epi64(tt1, tt5));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 4 * dst_stride), _mm_unpacklo_epi64(tt2, tt6));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 5 * dst_stride), _mm_unpackhi_epi64(tt2, tt6));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 6 * dst_stride), _mm_unpacklo_epi64(tt3, tt7));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 7 * dst_stride), _mm_unpackhi_epi64(tt3, tt7));
+}
+
+void transpose_matrix_column_major(const uint16_t *src, uint16_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                   size_t dst_ld) {
+  constexpr size_t block_size = 8;
+
+  for (size_t i = 0; i < cols; i += block_size) {
+    for (size_t j = 0; j < rows; j += block_size) {
+      size_t block_rows = std::min(block_size, rows - j);
+      size_t block_cols = std::min(block_size, cols - i);
+
+      if (block_rows == 8 && block_cols == 8) {
+        transpose8x8_block(&src[i * src_ld + j], src_ld, &dst[j * dst_ld + i], dst_ld);
+      } else {
+        for (size_t ii = 0; ii < block_cols; ii++) {
+          for (size_t jj = 0; jj < block_rows; jj++) {
+            dst[(j + jj) * dst_ld + (i + ii)] = src[(i + ii) * src_ld + (j + jj)];
+          }
+        }
+      }
+    }
+  }
+}
+
+void transpose_matrix_column_major(const uint16_t *src, uint16_t *dst, size_t rows, size_t cols) {
+  transpose_matrix_column_major(src, dst, rows, cols, rows, cols);
+}
+
+void transpose_matrix_row_major(const uint16_t *src, uint16_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                size_t dst_ld) {
   constexpr size_t block_size = 8;
 
   for (size_t i = 0; i < rows; i += block_size) {
@@ -258,14 +375,39 @@ void transpose_matrix_row_major(const float *src, float *dst, size_t rows, size_
       size_t block_cols = std::min(block_size, cols - j);
 
       if (block_rows == 8 && block_cols == 8) {
-        transpose8x8_block(&src[i * cols + j], &dst[j * rows + i], cols, rows);
+        transpose8x8_block(&src[i * src_ld + j], src_ld, &dst[j * dst_ld + i], dst_ld);
       } else {
         for (size_t ii = 0; ii < block_rows; ii++) {
           for (size_t jj = 0; jj < block_cols; jj++) {
-            dst[(j + jj) * rows + (i + ii)] = src[(i + ii) * cols + (j + jj)];
+            dst[(j + jj) * dst_ld + (i + ii)] = src[(i + ii) * src_ld + (j + jj)];
           }
         }
       }
     }
   }
 }
+
+void transpose_matrix_row_major(const uint16_t *src, uint16_t *dst, size_t rows, size_t cols) {
+  transpose_matrix_row_major(src, dst, rows, cols, cols, rows);
+}
+
+// int16 moves the same bits as uint16
+void transpose_matrix_column_major(const int16_t *src, int16_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                   size_t dst_ld) {
+  transpose_matrix_column_major(reinterpret_cast<const uint16_t *>(src), reinterpret_cast<uint16_t *>(dst), rows, cols,
+                                src_ld, dst_ld);
+}
+
+void transpose_matrix_column_major(const int16_t *src, int16_t *dst, size_t rows, size_t cols) {
+  transpose_matrix_column_major(src, dst, rows, cols, rows, cols);
+}
+
+void transpose_matrix_row_major(const int16_t *src, int16_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                size_t dst_ld) {
+  transpose_matrix_row_major(reinterpret_cast<const uint16_t *>(src), reinterpret_cast<uint16_t *>(dst), rows, cols,
+                             src_ld, dst_ld);
+}
+
+void transpose_matrix_row_major(const int16_t *src, int16_t *dst, size_t rows, size_t cols) {
+  transpose_matrix_row_major(src, dst, rows, cols, cols, rows);
+}
@@ -9,3 +9,34 @@ void transpose_matrix_row_major(const int8_t *src, int8_t *dst, size_t rows, siz
 
 void transpose_matrix_column_major(const int32_t *src, int32_t *dst, size_t rows, size_t cols);
 void transpose_matrix_row_major(const int32_t *src, int32_t *dst, size_t rows, size_t cols);
+
+// 16-bit elements, any 16-bit type (fp16, bf16) moves as uint16_t
+void transpose_matrix_column_major(const uint16_t *src, uint16_t *dst, size_t rows, size_t cols);
+void transpose_matrix_row_major(const uint16_t *src, uint16_t *dst, size_t rows, size_t cols);
+void transpose_matrix_column_major(const int16_t *src, int16_t *dst, size_t rows, size_t cols);
+void transpose_matrix_row_major(const int16_t *src, int16_t *dst, size_t rows, size_t cols);
+
+// Strided versions, src_ld and dst_ld are leading dimensions of src and dst.
+// Used to transpose column blocks of bigger matrices.
+void transpose_matrix_column_major(const float *src, float *dst, size_t rows, size_t cols, size_t src_ld,
+                                   size_t dst_ld);
+void transpose_matrix_row_major(const float *src, float *dst, size_t rows, size_t cols, size_t src_ld, size_t dst_ld);
+
+void transpose_matrix_column_major(const int8_t *src, int8_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                   size_t dst_ld);
+void transpose_matrix_row_major(const int8_t *src, int8_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                size_t dst_ld);
+
+void transpose_matrix_column_major(const int32_t *src, int32_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                   size_t dst_ld);
+void transpose_matrix_row_major(const int32_t *src, int32_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                size_t dst_ld);
+
+void transpose_matrix_column_major(const uint16_t *src, uint16_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                   size_t dst_ld);
+void transpose_matrix_row_major(const uint16_t *src, uint16_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                size_t dst_ld);
+void transpose_matrix_column_major(const int16_t *src, int16_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                   size_t dst_ld);
+void transpose_matrix_row_major(const int16_t *src, int16_t *dst, size_t rows, size_t cols, size_t src_ld,
+                                size_t dst_ld);
@@ -0,0 +1,133 @@
+#include "q4.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <vector>
+
+#include "common.hpp"
+#include "share_half.h"
+#include "worker_pool.hpp"
+
+namespace {
+// Position of weight i of a group in its 8B word: low nibbles hold weights 0..7, high ones 8..15
+void put_nibble(uint8_t *weights, uint32_t i, uint8_t q) {
+  uint8_t &byte = weights[i / 16 * 8 + i % 8];
+  byte |= (i % 16 < 8) ? q : static_cast<uint8_t>(q << 4);
+}
+
+uint8_t get_nibble(const uint8_t *weights, uint32_t i) {
+  uint8_t byte = weights[i / 16 * 8 + i % 8];
+  return (i % 16 < 8) ? (byte & 0xf) : (byte >> 4);
+}
+}  // namespace
+
+bool q4_valid_group(uint32_t group_size) {
+  return group_size >= Q4_MIN_GROUP && group_size <= Q4_MAX_GROUP && (group_size & (group_size - 1)) == 0;
+}
+
+void q4_pack_row(const float *W, uint32_t n, uint32_t group_size, bool zero_points, uint8_t *out) {
+  uint32_t nr_groups = Q4_NR_GROUPS(n, group_size);
+  std::memset(out, 0, Q4_ROW_BYTES(n, group_size, zero_points));
+  uint8_t *weights = out;
+  auto *scales = reinterpret_cast<uint16_t *>(out + Q4_WEIGHT_BYTES(n, group_size));
+  uint8_t *zeros = out + Q4_WEIGHT_BYTES(n, group_size) + Q4_SCALE_BYTES(n, group_size);
+
+  for (uint32_t g = 0; g < nr_groups; g++) {
+    uint32_t first = g * group_size;
+    uint32_t last = std::min(n, first + group_size);
+    // 0 is always in range, so it stays exact
+    float lo = 0.0f;
+    float hi = 0.0f;
+    for (uint32_t i = first; i < last; i++) {
+      lo = std::min(lo, W[i]);
+      hi = std::max(hi, W[i]);
+    }
+
+    int zero = Q4_SYMMETRIC_ZERO;
+    const int q_max = 15;
+    float scale = std::max(-lo, hi) / 7.0f;
+    if (zero_points) {
+      scale = (hi - lo) / 15.0f;
+    }
+    // Quantize with the scale the kernel is going to see
+    scales[g] = float_to_half(scale);
+    scale = half_to_float(scales[g]);
+    if (zero_points) {
+      zero = scale == 0.0f ? 0 : std::min(std::max(static_cast<int>(std::lround(-lo / scale)), 0), q_max);
+      zeros[g] = static_cast<uint8_t>(zero);
+    }
+
+    for (uint32_t i = first; i < first + group_size; i++) {
+      int q = zero;
+      if (i < last && scale != 0.0f) {
+        q = std::min(std::max(static_cast<int>(std::lround(W[i] / scale)) + zero, 0), q_max);
+      }
+      put_nibble(weights, i, static_cast<uint8_t>(q));
+    }
+  }
+}
+
+void q4_unpack_row(const uint8_t *packed, uint32_t n, uint32_t group_size, bool zero_points, float *W) {
+  auto *scales = reinterpret_cast<const uint16_t *>(packed + Q4_WEIGHT_BYTES(n, group_size));
+  const uint8_t *zeros = packed + Q4_WEIGHT_BYTES(n, group_size) + Q4_SCALE_BYTES(n, group_size);
+  for (uint32_t i = 0; i < n; i++) {
+    uint32_t g = i / group_size;
+    int zero = zero_points ? zeros[g] : Q4_SYMMETRIC_ZERO;
+    W[i] = half_to_float(scales[g]) * static_cast<float>(get_nibble(packed, i) - zero);
+  }
+}
+
+float q4_quantize_x(const float *x, uint32_t n, int8_t *out) {
+  float amax = 0.0f;
+  for (uint32_t i = 0; i < n; i++) {
+    amax = std::max(amax, std::fabs(x[i]));
+  }
+  float scale = amax / 127.0f;
+  for (uint32_t i = 0; i < n; i++) {
+    int q = scale == 0.0f ? 0 : static_cast<int>(std::lround(x[i] / scale));
+    out[i] = static_cast<int8_t>(std::min(std::max(q, -127), 127));
+  }
+  return scale;
+}
+
+void q4_pack_x(const int8_t *x, float scale, uint32_t n, uint32_t group_size, uint8_t *region) {
+  std::memset(region, 0, Q4_X_REGION_BYTES(n, group_size));
+  std::memcpy(region, x, n);
+  auto *sums = reinterpret_cast<int32_t *>(region + Q4_X_BYTES(n, group_size));
+  for (uint32_t i = 0; i < n; i++) {
+    sums[i / group_size] += x[i];
+  }
+  std::memcpy(region + Q4_X_BYTES(n, group_size) + Q4_XSUM_BYTES(n, group_size), &scale, sizeof(scale));
+}
+
+extern "C" {
+size_t pimblas_q4_size(uint32_t m, uint32_t n, uint32_t group_size, int zero_points) {
+  return static_cast<size_t>(m) * Q4_ROW_BYTES(n, group_size, zero_points);
+}
+
+int pimblas_q4_pack(uint32_t m, uint32_t n, const float *W, uint32_t group_size, int zero_points, uint8_t *packed) {
+  if (false == q4_valid_group(group_size)) {
+    show_error("pimblas_q4_pack: Unsupported group_size=[{}]", group_size);
+    return -1;
+  }
+  size_t row_bytes = Q4_ROW_BYTES(n, group_size, zero_points);
+  auto &pool = WorkerPool::instance();
+  uint32_t nr_chunks = std::min(m, std::max(1u, pool.get_nr_threads() * 4));
+  std::vector<std::future<void>> done;
+  for (uint32_t c = 0; c < nr_chunks; c++) {
+    uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(m) * c / nr_chunks);
+    uint32_t last = static_cast<uint32_t>(static_cast<uint64_t>(m) * (c + 1) / nr_chunks);
+    done.push_back(pool.submit([=]() {
+      for (uint32_t row = first; row < last; row++) {
+        q4_pack_row(W + static_cast<size_t>(row) * n, n, group_size, zero_points != 0, packed + row * row_bytes);
+      }
+    }));
+  }
+  for (auto &d : done) {
+    d.wait();
+  }
+  return 0;
+}
+}
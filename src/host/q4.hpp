@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "share_q4.h"
+
+// Host packer of 4-bit grouped quantized rows and x, format is described in share_q4.h.
+
+// Power of two the layout supports
+bool q4_valid_group(uint32_t group_size);
+
+// Quantizes n weights of W into a packed row of Q4_ROW_BYTES(n, group_size, zero_points) bytes.
+// Scales are absmax / 7 per group, with zero_points (max - min) / 15 and the zero point rounded to 0..15.
+void q4_pack_row(const float *W, uint32_t n, uint32_t group_size, bool zero_points, uint8_t *out);
+
+// Weights a packed row stands for, n of them
+void q4_unpack_row(const uint8_t *packed, uint32_t n, uint32_t group_size, bool zero_points, float *W);
+
+// Quantizes n values of x to int8 with a single absmax scale, returns the scale
+float q4_quantize_x(const float *x, uint32_t n, int8_t *out);
+
+// Fills region (Q4_X_REGION_BYTES(n, group_size)) with x padded with zeros, its group sums and scale
+void q4_pack_x(const int8_t *x, float scale, uint32_t n, uint32_t group_size, uint8_t *region);
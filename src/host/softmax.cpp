@@ -6,8 +6,14 @@ void set_vec_size(Kernel &kernel, size_t chunk_size, size_t size) {
   kernel.set_arg_broadcast_exact("vec_size", 0, &vec_size, sizeof(uint32_t), false);
   uint32_t remainder = size % chunk_size;
   if (size % chunk_size != 0) {
-    dpu_set_t last_dpu;
-    DPU_FOREACH(kernel.get_dpu_set(), last_dpu) {}
+    dpu_set_t dpu, last_dpu;
+    uint32_t idx;
+    DPU_FOREACH(kernel.get_dpu_set(), dpu, idx) {
+      if (idx == kernel.get_nr_dpus()) {
+        break;
+      }
+      last_dpu = dpu;
+    }
     dpu_copy_to(last_dpu, "vec_size", 0, &remainder, sizeof(uint32_t));
   }
 }
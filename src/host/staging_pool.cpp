@@ -0,0 +1,46 @@
+#include "staging_pool.hpp"
+
+#include <algorithm>
+
+#include "dpu_transfer_helper.hpp"
+
+StagingPool::Buffer::~Buffer() {
+  if (pool != nullptr && ptr != nullptr) {
+    pool->release(std::move(ptr), capacity);
+  }
+}
+
+StagingPool &StagingPool::instance() {
+  static StagingPool pool;
+  return pool;
+}
+
+StagingPool::Buffer StagingPool::acquire(size_t size) {
+  size = alignUp(std::max<size_t>(size, 8), 8);
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto best = cached.end();
+    for (auto it = cached.begin(); it != cached.end(); ++it) {
+      if (it->capacity >= size && (best == cached.end() || it->capacity < best->capacity)) {
+        best = it;
+      }
+    }
+    if (best != cached.end()) {
+      Buffer buffer(this, std::move(best->data), best->capacity);
+      cached.erase(best);
+      return buffer;
+    }
+  }
+  return Buffer(this, std::unique_ptr<uint8_t[]>(new uint8_t[size]), size);
+}
+
+void StagingPool::release(std::unique_ptr<uint8_t[]> data, size_t capacity) {
+  std::lock_guard<std::mutex> lock(mtx);
+  cached.push_back(Cached{.data = std::move(data), .capacity = capacity});
+  if (cached.size() > max_cached) {
+    // Drop the smallest one, big buffers are the expensive ones to get again
+    auto smallest = std::min_element(cached.begin(), cached.end(),
+                                     [](const Cached &a, const Cached &b) { return a.capacity < b.capacity; });
+    cached.erase(smallest);
+  }
+}
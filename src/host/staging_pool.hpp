@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common.hpp"
+
+// Process wide pool of host staging buffers for transfers.
+// Sizes are padded to 8B, so a buffer can always take a whole MRAM transfer. Released buffers are
+// kept for the next transfer instead of being freed, at most max_cached of them.
+class StagingPool {
+ public:
+  static constexpr size_t max_cached = 8;
+
+  // Lease of a buffer, goes back to the pool when destroyed
+  class Buffer {
+   public:
+    Buffer() = default;
+    Buffer(StagingPool *pool, std::unique_ptr<uint8_t[]> data, size_t capacity)
+        : pool(pool), ptr(std::move(data)), capacity(capacity) {}
+    ~Buffer();
+
+    Buffer(Buffer &&other) = default;
+    Buffer &operator=(Buffer &&other) = default;
+
+    uint8_t *data() { return ptr.get(); }
+    size_t size() const { return capacity; }
+
+   private:
+    StagingPool *pool = nullptr;
+    std::unique_ptr<uint8_t[]> ptr;
+    size_t capacity = 0;
+  };
+
+  static StagingPool &instance();
+
+  StagingPool(const StagingPool &) = delete;
+  StagingPool &operator=(const StagingPool &) = delete;
+
+  // Smallest cached buffer holding at least size bytes, a new one if none does
+  Buffer acquire(size_t size);
+
+ private:
+  StagingPool() = default;
+
+  void release(std::unique_ptr<uint8_t[]> data, size_t capacity);
+
+  struct Cached {
+    std::unique_ptr<uint8_t[]> data;
+    size_t capacity;
+  };
+
+  std::mutex mtx;
+  std::vector<Cached> cached;
+};
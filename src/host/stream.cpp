@@ -0,0 +1,246 @@
+#include "stream.hpp"
+
+#include "gemv_plan.hpp"
+
+Stream::Stream() { thread = std::thread(&Stream::worker, this); }
+
+Stream::~Stream() {
+  synchronize();
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stop = true;
+  }
+  work_cv.notify_one();
+  thread.join();
+}
+
+void Stream::enqueue(std::function<int()> op) {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    ops.push_back(std::move(op));
+  }
+  work_cv.notify_one();
+}
+
+int Stream::synchronize() {
+  std::unique_lock<std::mutex> lock(mtx);
+  idle_cv.wait(lock, [this] { return ops.empty() && !busy; });
+  int ret = error;
+  error = 0;
+  return ret;
+}
+
+void Stream::worker() {
+  std::unique_lock<std::mutex> lock(mtx);
+  while (true) {
+    work_cv.wait(lock, [this] { return stop || !ops.empty(); });
+    if (ops.empty()) {
+      return;
+    }
+
+    auto op = std::move(ops.front());
+    ops.pop_front();
+    busy = true;
+    lock.unlock();
+
+    int ret = op();
+
+    lock.lock();
+    busy = false;
+    if (ret != 0 && error == 0) {
+      error = ret;
+    }
+    if (ops.empty()) {
+      idle_cv.notify_all();
+    }
+  }
+}
+
+uint64_t Event::record() {
+  std::lock_guard<std::mutex> lock(mtx);
+  return ++recorded;
+}
+
+void Event::complete(uint64_t target) {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    completed = std::max(completed, target);
+  }
+  cv.notify_all();
+}
+
+void Event::wait(uint64_t target) {
+  std::unique_lock<std::mutex> lock(mtx);
+  cv.wait(lock, [this, target] { return completed >= target; });
+}
+
+uint64_t Event::get_recorded() {
+  std::lock_guard<std::mutex> lock(mtx);
+  return recorded;
+}
+
+bool Event::is_completed() {
+  std::lock_guard<std::mutex> lock(mtx);
+  return completed >= recorded;
+}
+
+extern "C" {
+pimblas_stream *pimblas_stream_create(void) { return new pimblas_stream(); }
+
+void pimblas_stream_destroy(pimblas_stream *stream) { delete stream; }
+
+int pimblas_stream_synchronize(pimblas_stream *stream) {
+  if (stream == nullptr) {
+    return -1;
+  }
+  return stream->stream.synchronize();
+}
+
+int pimblas_stream_wait_event(pimblas_stream *stream, pimblas_event *event) {
+  if (stream == nullptr || event == nullptr) {
+    return -1;
+  }
+  auto e = event->event;
+  auto target = e->get_recorded();
+  stream->stream.enqueue([e, target]() {
+    e->wait(target);
+    return 0;
+  });
+  return 0;
+}
+
+pimblas_event *pimblas_event_create(void) { return new pimblas_event(); }
+
+void pimblas_event_destroy(pimblas_event *event) { delete event; }
+
+int pimblas_event_record(pimblas_event *event, pimblas_stream *stream) {
+  if (stream == nullptr || event == nullptr) {
+    return -1;
+  }
+  auto e = event->event;
+  auto target = e->record();
+  stream->stream.enqueue([e, target]() {
+    e->complete(target);
+    return 0;
+  });
+  return 0;
+}
+
+int pimblas_event_wait(pimblas_event *event) {
+  if (event == nullptr) {
+    return -1;
+  }
+  event->event->wait(event->event->get_recorded());
+  return 0;
+}
+
+int pimblas_event_query(pimblas_event *event) {
+  if (event == nullptr) {
+    return -1;
+  }
+  return event->event->is_completed() ? 1 : 0;
+}
+
+int gemv_f_async(pimblas_stream *stream, uint32_t m, uint32_t n, const float *A, const float *x, float *y,
+                 const float *alpha, const float *beta) {
+  if (stream == nullptr) {
+    return -1;
+  }
+  float a = *alpha;
+  float b = *beta;
+  stream->stream.enqueue([=]() { return gemv_f(m, n, A, x, y, &a, &b); });
+  return 0;
+}
+
+int gemv_int8_async(pimblas_stream *stream, uint32_t m, uint32_t n, const int8_t *A, const int8_t *x, int *y,
+                    const int *alpha, const int *beta) {
+  if (stream == nullptr) {
+    return -1;
+  }
+  int a = *alpha;
+  int b = *beta;
+  stream->stream.enqueue([=]() { return gemv_int8(m, n, A, x, y, &a, &b); });
+  return 0;
+}
+
+int gemv_int32_async(pimblas_stream *stream, uint32_t m, uint32_t n, const int *A, const int *x, int *y,
+                     const int *alpha, const int *beta) {
+  if (stream == nullptr) {
+    return -1;
+  }
+  int a = *alpha;
+  int b = *beta;
+  stream->stream.enqueue([=]() { return gemv_int32(m, n, A, x, y, &a, &b); });
+  return 0;
+}
+
+int pimblas_gemv_plan_execute_async(pimblas_stream *stream, pimblas_gemv_plan *plan, const void *x, void *y,
+                                    const void *alpha, const void *beta) {
+  if (stream == nullptr) {
+    return -1;
+  }
+  if (plan == nullptr) {
+    return -1;
+  }
+  stream->stream.enqueue(plan->bind(x, y, alpha, beta));
+  return 0;
+}
+
+int gemm_row_maj_f_async(pimblas_stream *stream, const int *m, const int *n, const int *k, const float *alpha,
+                         const float *a, const float *b, const float *beta, float *c) {
+  if (stream == nullptr) {
+    return -1;
+  }
+  int m_v = *m, n_v = *n, k_v = *k;
+  float alpha_v = *alpha, beta_v = *beta;
+  stream->stream.enqueue([=]() {
+    gemm_row_maj_f(&m_v, &n_v, &k_v, &alpha_v, a, b, &beta_v, c);
+    return 0;
+  });
+  return 0;
+}
+
+int gemm_row_maj_int8_async(pimblas_stream *stream, const int *m, const int *n, const int *k, const int *alpha,
+                            const int8_t *a, const int8_t *b, const int *beta, int *c) {
+  if (stream == nullptr) {
+    return -1;
+  }
+  int m_v = *m, n_v = *n, k_v = *k;
+  int alpha_v = *alpha, beta_v = *beta;
+  stream->stream.enqueue([=]() {
+    gemm_row_maj_int8(&m_v, &n_v, &k_v, &alpha_v, a, b, &beta_v, c);
+    return 0;
+  });
+  return 0;
+}
+
+int gemm_row_maj_int32_async(pimblas_stream *stream, const int *m, const int *n, const int *k, const int *alpha,
+                             const int32_t *a, const int32_t *b, const int *beta, int *c) {
+  if (stream == nullptr) {
+    return -1;
+  }
+  int m_v = *m, n_v = *n, k_v = *k;
+  int alpha_v = *alpha, beta_v = *beta;
+  stream->stream.enqueue([=]() {
+    gemm_row_maj_int32(&m_v, &n_v, &k_v, &alpha_v, a, b, &beta_v, c);
+    return 0;
+  });
+  return 0;
+}
+
+int softmax_async(pimblas_stream *stream, const float *vec_in, float *vec_out, size_t size) {
+  if (stream == nullptr) {
+    return -1;
+  }
+  stream->stream.enqueue([=]() { return softmax(vec_in, vec_out, size); });
+  return 0;
+}
+
+int relu_f_async(pimblas_stream *stream, const float *input, float *output, size_t num_elem) {
+  if (stream == nullptr) {
+    return -1;
+  }
+  stream->stream.enqueue([=]() { return relu_f(input, output, num_elem); });
+  return 0;
+}
+}
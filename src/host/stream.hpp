@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "common.hpp"
+
+// In order queue of host side ops, executed by a single worker thread.
+// Ops on different streams run concurrently, every op allocates its own DPUs.
+class Stream {
+ public:
+  Stream();
+  ~Stream();
+
+  Stream(const Stream &) = delete;
+  Stream &operator=(const Stream &) = delete;
+
+  void enqueue(std::function<int()> op);
+  // Waits for every enqueued op, returns the first error since the last synchronize
+  int synchronize();
+
+ private:
+  void worker();
+
+  std::mutex mtx;
+  std::condition_variable work_cv;
+  std::condition_variable idle_cv;
+  std::deque<std::function<int()>> ops;
+  bool busy = false;
+  bool stop = false;
+  int error = 0;
+  std::thread thread;
+};
+
+// Marker in a stream, completed once every op enqueued before the record has finished
+class Event {
+ public:
+  uint64_t record();
+  void complete(uint64_t target);
+  void wait(uint64_t target);
+  uint64_t get_recorded();
+  bool is_completed();
+
+ private:
+  std::mutex mtx;
+  std::condition_variable cv;
+  uint64_t recorded = 0;
+  uint64_t completed = 0;
+};
+
+struct pimblas_stream {
+  Stream stream;
+};
+
+struct pimblas_event {
+  std::shared_ptr<Event> event = std::make_shared<Event>();
+};
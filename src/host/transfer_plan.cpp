@@ -0,0 +1,106 @@
+#include "transfer_plan.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+TransferPlan TransferPlan::build(dpu_set_t set, uint32_t nr_dpus, dpu_xfer_t xfer, const char *symbol_name,
+                                 size_t sym_offset, size_t window_size, size_t data_size,
+                                 const std::function<void(uint32_t, size_t &, size_t &)> &part_of) {
+  TransferPlan plan;
+  plan.set = set;
+  plan.xfer = xfer;
+  plan.symbol_name = symbol_name;
+  plan.sym_offset = sym_offset;
+  plan.window_size = window_size;
+  plan.data_size = data_size;
+
+  // Leased sets can hold more DPUs than nr_dpus, the rest is left untouched
+  dpu_set_t rank, dpu;
+  uint32_t rank_idx;
+  uint32_t dpu_idx = 0;
+  DPU_RANK_FOREACH(set, rank, rank_idx) {
+    if (dpu_idx == nr_dpus) {
+      break;
+    }
+    RankTargets rank_targets{.rank = rank, .rank_idx = rank_idx, .targets = {}};
+    DPU_FOREACH(rank, dpu) {
+      if (dpu_idx == nr_dpus) {
+        break;
+      }
+      size_t begin = 0;
+      size_t length = 0;
+      part_of(dpu_idx, begin, length);
+      length = std::min(length, data_size > begin ? data_size - begin : 0);
+
+      uint32_t slot = not_staged;
+      bool overlaps = xfer == DPU_XFER_FROM_DPU && length < window_size;
+      if (overlaps || begin + window_size > data_size) {
+        slot = static_cast<uint32_t>(plan.staged.size());
+        plan.staged.push_back(Staged{.begin = begin, .length = length});
+      }
+      rank_targets.targets.push_back(Target{.dpu = dpu, .begin = begin, .slot = slot});
+      dpu_idx++;
+    }
+    plan.ranks.push_back(std::move(rank_targets));
+  }
+
+  plan.staging.resize(plan.staged.size() * window_size);
+  return plan;
+}
+
+TransferPlan TransferPlan::chunks(dpu_set_t set, uint32_t nr_dpus, dpu_xfer_t xfer, const char *symbol_name,
+                                  size_t sym_offset, size_t chunk_size, size_t size) {
+  return build(set, nr_dpus, xfer, symbol_name, sym_offset, alignUp(chunk_size, 8), size,
+               [chunk_size](uint32_t dpu_idx, size_t &begin, size_t &length) {
+                 begin = dpu_idx * chunk_size;
+                 length = chunk_size;
+               });
+}
+
+TransferPlan TransferPlan::rows(dpu_set_t set, const RowPartition &part, dpu_xfer_t xfer, const char *symbol_name,
+                                size_t sym_offset, size_t row_bytes) {
+  return build(set, part.nr_dpus, xfer, symbol_name, sym_offset, alignUp(part.rows_per_dpu * row_bytes, 8),
+               part.m * row_bytes, [&part, row_bytes](uint32_t dpu_idx, size_t &begin, size_t &length) {
+                 begin = part.first_row(dpu_idx) * row_bytes;
+                 length = part.nr_rows(dpu_idx) * row_bytes;
+               });
+}
+
+void TransferPlan::execute(const void *data, dpu_xfer_flags_t flags, RankTimer *timer) {
+  auto *bytes = (uint8_t *)data;
+  if (xfer == DPU_XFER_TO_DPU) {
+    for (size_t i = 0; i < staged.size(); i++) {
+      size_t valid = std::min(window_size, data_size > staged[i].begin ? data_size - staged[i].begin : 0);
+      memcpy(&staging[i * window_size], &bytes[staged[i].begin], valid);
+      memset(&staging[i * window_size + valid], 0, window_size - valid);
+    }
+  }
+
+  for (auto &rank_targets : ranks) {
+    for (auto &target : rank_targets.targets) {
+      uint8_t *src = target.slot == not_staged ? &bytes[target.begin] : &staging[target.slot * window_size];
+      DPU_ASSERT(dpu_prepare_xfer(target.dpu, (void *)src));
+    }
+    if (timer) {
+      timer->start(rank_targets.rank, rank_targets.rank_idx);
+    }
+    DPU_ASSERT(
+        dpu_push_xfer(rank_targets.rank, xfer, symbol_name.c_str(), sym_offset, window_size, DPU_XFER_ASYNC));
+    if (timer) {
+      auto rank_dpus = static_cast<uint32_t>(rank_targets.targets.size());
+      timer->stop(rank_targets.rank, rank_targets.rank_idx, rank_dpus, rank_dpus * window_size);
+    }
+  }
+
+  if (xfer == DPU_XFER_FROM_DPU && false == staged.empty()) {
+    DPU_ASSERT(dpu_sync(set));
+    for (size_t i = 0; i < staged.size(); i++) {
+      memcpy(&bytes[staged[i].begin], &staging[i * window_size], staged[i].length);
+    }
+    return;
+  }
+
+  if (flags != DPU_XFER_ASYNC) {
+    DPU_ASSERT(dpu_sync(set));
+  }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "dpu_transfer_helper.hpp"
+
+// Precomputed scatter/gather between a host buffer and a symbol of a DPU set.
+// DPU handles, offsets of their parts in the host buffer and staging of tails are worked out once,
+// execute() only binds a new base address. Every DPU moves window_size bytes with a single push per rank.
+// Windows running past the end of the buffer go through zero padded staging. Gathers also stage windows
+// longer than the DPU's part (they would overwrite the next part) and sync the set before copying them out.
+// Staging belongs to the plan, a plan with staged DPUs mustn't run again before its last transfer is done.
+class TransferPlan {
+ public:
+  TransferPlan() = default;
+
+  // chunk_size bytes per DPU out of size bytes, DPU i starts at i * chunk_size (transfer_chunks layout)
+  static TransferPlan chunks(dpu_set_t set, uint32_t nr_dpus, dpu_xfer_t xfer, const char *symbol_name,
+                             size_t sym_offset, size_t chunk_size, size_t size);
+
+  // part.rows_per_dpu rows of row_bytes per DPU, DPU i starts at part.first_row(i)
+  static TransferPlan rows(dpu_set_t set, const RowPartition &part, dpu_xfer_t xfer, const char *symbol_name,
+                           size_t sym_offset, size_t row_bytes);
+
+  void execute(const void *data, dpu_xfer_flags_t flags, RankTimer *timer = nullptr);
+
+  bool empty() const { return ranks.empty(); }
+  size_t get_nr_staged() const { return staged.size(); }
+
+ private:
+  static constexpr uint32_t not_staged = UINT32_MAX;
+
+  struct Target {
+    dpu_set_t dpu;
+    size_t begin;
+    uint32_t slot;
+  };
+
+  struct RankTargets {
+    dpu_set_t rank;
+    uint32_t rank_idx;
+    std::vector<Target> targets;
+  };
+
+  struct Staged {
+    size_t begin;
+    size_t length;
+  };
+
+  // part_of(dpu_idx, begin, length) gives the part of the host buffer owned by the DPU
+  static TransferPlan build(dpu_set_t set, uint32_t nr_dpus, dpu_xfer_t xfer, const char *symbol_name,
+                            size_t sym_offset, size_t window_size, size_t data_size,
+                            const std::function<void(uint32_t, size_t &, size_t &)> &part_of);
+
+  dpu_set_t set{};
+  dpu_xfer_t xfer = DPU_XFER_TO_DPU;
+  std::string symbol_name;
+  size_t sym_offset = 0;
+  size_t window_size = 0;
+  size_t data_size = 0;
+
+  std::vector<RankTargets> ranks;
+  std::vector<Staged> staged;
+  std::vector<uint8_t> staging;
+};
@@ -25,12 +25,11 @@ int vector_add(const int *a_input_ptr, const int *b_input_ptr, size_t num_elem,
   struct dpu_set_t dpu_set, dpu;
 
   uint32_t dpus_exe = 8;
-  DPU_ASSERT(dpu_alloc(dpus_exe, NULL, &dpu_set));
-  char *kern_name = pimblas_get_kernel_dir_concat_free("vector_add.kernel");
-  show_debug("kern_path=%s\n", kern_name);
-
-  DPU_ASSERT(dpu_load(dpu_set, kern_name, NULL));
-  free(kern_name);
+  if (pimblas_dpu_alloc(dpus_exe, &dpu_set) != 0) {
+    show_error("vector_add: Couldn't allocate nr_dpus=%d", dpus_exe);
+    return -1;
+  }
+  DPU_ASSERT(pimblas_dpu_load(dpu_set, "vector_add.kernel", NULL));
 
   uint32_t nr_of_dpus;
   DPU_ASSERT(dpu_get_nr_dpus(dpu_set, &nr_of_dpus));
@@ -117,7 +116,7 @@ int vector_add(const int *a_input_ptr, const int *b_input_ptr, size_t num_elem,
   //  input_arguments[i].transfer_size_bytes,
   //  input_arguments[i].transfer_size_bytes, DPU_XFER_DEFAULT));
 
-  DPU_ASSERT(dpu_free(dpu_set));
+  pimblas_dpu_free(dpu_set);
 
   return 0;
 }
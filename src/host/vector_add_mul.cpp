@@ -1,6 +1,7 @@
 #include "common.hpp"
 #include "dpu_transfer_helper.hpp"
 #include "helper.hpp"
+#include "kernel.hpp"
 
 #define PARAM_COUNT 4
 #define VECTOR_LEN_POS 0
@@ -35,25 +36,25 @@ int vec_sub_f(const float *input_a, const float *input_b, float *output, size_t
 }
 
 int vec_add_mul_f(const float *input_a, const float *input_b, float *output, int OP_TYPE, size_t size, int num_dpus) {
-  dpu_set_t set;
-  DPU_ASSERT(dpu_alloc(num_dpus, nullptr, &set));
+  Kernel vec;
+  if (false == vec.allocate_n(num_dpus)) {
+    show_error("vec_add_mul_f: Couldn't allocate nr_dpus=[{}]", num_dpus);
+    return -1;
+  }
 
-  char *kernName = pimblas_get_kernel_dir_concat_free("vector_add_mul.kernel");
-  show_debug("kern_path = {} ", kernName);
-  DPU_ASSERT(dpu_load(set, kernName, nullptr));
-  free(kernName);
+  vec.load_program("vector_add_mul.kernel");
+  dpu_set_t &set = vec.get_dpu_set();
 
   int chunk_size = 0;
-  get_chunk_size2(set, size, chunk_size);
+  get_chunk_size2(num_dpus, size, chunk_size);
   set_params_add_mul(set, chunk_size, OP_TYPE);
 
-  to_mram2(set, "buffer_a", input_a, size);
-  to_mram2(set, "buffer_b", input_b, size);
+  to_mram2(set, num_dpus, "buffer_a", input_a, size);
+  to_mram2(set, num_dpus, "buffer_b", input_b, size);
 
-  DPU_ASSERT(dpu_launch(set, DPU_SYNCHRONOUS));
+  vec.launch(false);
 
-  from_mram2(set, "buffer_a", output, size);
-  DPU_ASSERT(dpu_free(set));
+  from_mram2(set, num_dpus, "buffer_a", output, size);
   return 0;
 }
 }
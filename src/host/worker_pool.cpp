@@ -0,0 +1,59 @@
+#include "worker_pool.hpp"
+
+#include <cstdlib>
+
+WorkerPool &WorkerPool::instance() {
+  static WorkerPool pool([] {
+    const char *env = std::getenv("PIMBLAS_HOST_THREADS");
+    uint32_t nr_threads = env ? static_cast<uint32_t>(strtoul(env, nullptr, 10)) : std::thread::hardware_concurrency();
+    return std::max(1u, nr_threads);
+  }());
+  return pool;
+}
+
+WorkerPool::WorkerPool(uint32_t nr_threads) {
+  for (uint32_t i = 0; i < nr_threads; i++) {
+    threads.emplace_back(&WorkerPool::worker, this);
+  }
+  show_debug("worker_pool: Started nr_threads=[{}]", nr_threads);
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    stop = true;
+  }
+  cv.notify_all();
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+std::future<void> WorkerPool::submit(std::function<void()> task) {
+  std::packaged_task<void()> packaged(std::move(task));
+  auto future = packaged.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    tasks.push_back(std::move(packaged));
+  }
+  cv.notify_one();
+  return future;
+}
+
+void WorkerPool::worker() {
+  std::unique_lock<std::mutex> lock(mtx);
+  while (true) {
+    cv.wait(lock, [this] { return stop || !tasks.empty(); });
+    if (tasks.empty()) {
+      return;
+    }
+
+    auto task = std::move(tasks.front());
+    tasks.pop_front();
+    lock.unlock();
+
+    task();
+
+    lock.lock();
+  }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common.hpp"
+
+// Process wide pool of host worker threads for host side work (transposes, packing)
+// that can overlap with DPUs. Tasks are executed in submission order.
+// Number of threads is taken from PIMBLAS_HOST_THREADS, defaults to hardware concurrency.
+class WorkerPool {
+ public:
+  static WorkerPool &instance();
+
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  std::future<void> submit(std::function<void()> task);
+
+  uint32_t get_nr_threads() const { return static_cast<uint32_t>(threads.size()); }
+
+ private:
+  explicit WorkerPool(uint32_t nr_threads);
+
+  void worker();
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<std::packaged_task<void()>> tasks;
+  bool stop = false;
+  std::vector<std::thread> threads;
+};
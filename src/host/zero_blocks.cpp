@@ -0,0 +1,56 @@
+#include "zero_blocks.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+uint64_t load_word(const uint8_t *src, size_t nr_bytes) {
+  uint64_t word = 0;
+  std::memcpy(&word, src, nr_bytes);
+  return word;
+}
+}  // namespace
+
+void zb_compress_row(const uint8_t *src, size_t row_bytes, std::vector<uint64_t> &out) {
+  for (size_t b = 0; b < row_bytes; b += ZB_BLOCK_BYTES) {
+    size_t block_bytes = std::min<size_t>(ZB_BLOCK_BYTES, row_bytes - b);
+    size_t header = out.size();
+    out.resize(header + ZB_HEADER_BYTES / 8, 0);
+
+    uint32_t masks[ZB_MASK_WORDS] = {};
+    for (size_t w = 0; w * 8 < block_bytes; w++) {
+      uint64_t word = load_word(src + b + w * 8, std::min<size_t>(8, block_bytes - w * 8));
+      if (word != 0) {
+        masks[w / 32] |= 1u << (w % 32);
+        out.push_back(word);
+      }
+    }
+    std::memcpy(&out[header], masks, ZB_HEADER_BYTES);
+  }
+}
+
+size_t zb_estimate_size(const uint8_t *src, size_t nr_rows, size_t row_bytes, size_t step) {
+  size_t nr_words = 0;
+  size_t nr_sampled = 0;
+  for (size_t row = 0; row < nr_rows; row += step) {
+    const uint8_t *row_src = src + row * row_bytes;
+    for (size_t i = 0; i < row_bytes; i += 8) {
+      nr_words += load_word(row_src + i, std::min<size_t>(8, row_bytes - i)) != 0 ? 1 : 0;
+    }
+    nr_sampled++;
+  }
+  if (nr_sampled == 0) {
+    return 0;
+  }
+  size_t header_bytes = ZB_NR_BLOCKS(row_bytes) * ZB_HEADER_BYTES;
+  return nr_rows * header_bytes + nr_words * 8 * nr_rows / nr_sampled;
+}
+
+bool zb_enabled() {
+  static const bool enabled = [] {
+    const char *env = std::getenv("PIMBLAS_COMPRESS_WEIGHTS");
+    return env != nullptr && strtoul(env, nullptr, 10) != 0;
+  }();
+  return enabled;
+}
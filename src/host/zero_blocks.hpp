@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "share_zero_blocks.h"
+
+// Host packer of zero word compressed rows, format is described in share_zero_blocks.h.
+
+// Appends row_bytes of src compressed to out, the row is padded with zeros to 8B
+void zb_compress_row(const uint8_t *src, size_t row_bytes, std::vector<uint64_t> &out);
+
+// Size in bytes of nr_rows compressed rows, only every step-th row is looked at and the result scaled up
+size_t zb_estimate_size(const uint8_t *src, size_t nr_rows, size_t row_bytes, size_t step);
+
+// Compressed weights are opt in with PIMBLAS_COMPRESS_WEIGHTS=1
+bool zb_enabled();
@@ -0,0 +1,5 @@
+#include "dpu_idle.h"
+
+#include <defs.h>
+
+__host uint32_t dpu_idle;
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Set by the host on DPUs a launch doesn't use (see Kernel::launch).
+ * The DPU pool leases whole ranks and they're launched as a whole, the spare DPUs would run
+ * on zeroed or stale args, so every kernel returns right away when it's set.
+ */
+extern uint32_t dpu_idle;
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <built_ins.h>
+#include <stdint.h>
+
+/*
+ * Integer multiplications for the DPU, its multiplier takes a single byte of each operand.
+ * Shared by the int8, int16 and int32 GEMV and GEMM kernels.
+ */
+
+/*
+ * Performs a dot product of eight 8-bit values.
+ *
+ * The first operand is a 64-bit value already in a register, the second one is loaded
+ * from the 8B aligned memory location pointed to by `y`. The dot product of the individual
+ * 8-bit integers is calculated in a highly optimized manner using various multiplication intrinsics.
+ */
+#define DOT_8_VALUE(x_dw, y, acc)             \
+  do {                                        \
+    unsigned long y_dw;                       \
+    unsigned int x_lo, x_hi, y_lo, y_hi;      \
+    int tmp;                                  \
+                                              \
+    x_lo = (x_dw);                            \
+    x_hi = (x_dw) >> 32;                      \
+    y_dw = *((unsigned long *)(y));           \
+    y_lo = y_dw;                              \
+    y_hi = y_dw >> 32;                        \
+                                              \
+    __builtin_mul_sl_sl_rrr(tmp, x_lo, y_lo); \
+    acc += tmp;                               \
+    __builtin_mul_sh_sh_rrr(tmp, x_lo, y_lo); \
+    acc += tmp;                               \
+    x_lo >>= 16;                              \
+    y_lo >>= 16;                              \
+    __builtin_mul_sl_sl_rrr(tmp, x_lo, y_lo); \
+    acc += tmp;                               \
+    __builtin_mul_sh_sh_rrr(tmp, x_lo, y_lo); \
+    acc += tmp;                               \
+    __builtin_mul_sl_sl_rrr(tmp, x_hi, y_hi); \
+    acc += tmp;                               \
+    __builtin_mul_sh_sh_rrr(tmp, x_hi, y_hi); \
+    acc += tmp;                               \
+    x_hi >>= 16;                              \
+    y_hi >>= 16;                              \
+    __builtin_mul_sl_sl_rrr(tmp, x_hi, y_hi); \
+    acc += tmp;                               \
+    __builtin_mul_sh_sh_rrr(tmp, x_hi, y_hi); \
+    acc += tmp;                               \
+  } while (0)
+
+/*
+ * Performs a dot product of eight 8-bit values, both loaded from 8B aligned memory locations.
+ */
+#define DOT_8(x, y, acc)                              \
+  do {                                                \
+    unsigned long x_dot_dw = *((unsigned long *)(x)); \
+    DOT_8_VALUE(x_dot_dw, y, acc);                    \
+  } while (0)
+
+/*
+ * Signed 32-bit multiplication put together from 8-bit multiplications of the magnitudes,
+ * partial products that can't reach the low 32 bits of the result are skipped.
+ */
+__attribute__((always_inline)) static inline int32_t mul32(register int32_t x, register int32_t y) {
+  int32_t xh, yh, result, tmp, sign;
+  __asm__(
+      "  lsr %[xh], %[xl], 31, z, 11f\n"
+      "  neg %[xl], %[xl]\n"  // compute (~x + 1)
+      "11:\n"
+      "  lsr %[yh], %[yl], 31, z, 12f\n"
+      "  neg %[yl], %[yl]\n"  // compute (~y + 1)
+
+      "12:\n"
+      "  xor %[t4], %[xh], %[yh]\n"
+
+      "  lsr %[xh], %[xl], 16\n"      // x3 x2
+      "  and %[xl], %[xl], 0xFFFF\n"  // x1 x0
+      "  lsr %[yh], %[yl], 16\n"      // y3 y2
+      " and %[yl], %[yl], 0xFFFF\n"   // y1 y0
+
+      "  mul_ul_ul %[t2], %[xl], %[yl]\n"  // x0 * y0
+
+      "  mul_ul_uh %[t3], %[xl], %[yl], z, 1f\n"  // x0 * y1
+      "  lsl_add %[t2], %[t2], %[t3], 8\n"
+      "1:\n"
+      "  mul_uh_ul %[t3], %[xl], %[yl], z, 2f\n"  // x1 * y0
+      "  lsl_add %[t2], %[t2], %[t3], 8\n"
+      "2:\n"
+      "  mul_uh_uh %[t3], %[xl], %[yl], z, 3f\n"  // x1 * y1
+      "  lsl_add %[t2], %[t2], %[t3], 16\n"
+      "3:\n"
+      "  mul_ul_ul %[t3], %[xl], %[yh], z, 4f\n"  // x0 * y2
+      "  lsl_add %[t2], %[t2], %[t3], 16\n"
+      "4:\n"
+      "  mul_ul_uh %[t3], %[xl], %[yh], z, 5f\n"  // x0 * y3
+      "  lsl_add %[t2], %[t2], %[t3], 24\n"
+      "5:\n"
+      "  mul_uh_ul %[t3], %[xl], %[yh], z, 6f\n"  // x1 * y2
+      "  lsl_add %[t2], %[t2], %[t3], 24\n"
+      "6:\n"
+      "  mul_ul_ul %[t3], %[xh], %[yl], z, 7f\n"  // x2 * y0
+      "  lsl_add %[t2], %[t2], %[t3], 16\n"
+      "7:\n"
+      "  mul_ul_uh %[t3], %[xh], %[yl], z, 8f\n"  // x2 * y1
+      "  lsl_add %[t2], %[t2], %[t3], 24\n"
+      "8:\n"
+      "  mul_uh_ul %[t3], %[xh], %[yl], z, 9f\n"  // x3 * y0
+      "  lsl_add %[t2], %[t2], %[t3], 24\n"
+      "9:\n"
+      " jeq %[t4], 0, 10f\n"
+      " neg %[t2], %[t2]\n"  // if signs are different negate the result
+      "10:\n"
+      : [t2] "=&r"(result), [xh] "=&r"(xh), [yh] "=&r"(yh), [t3] "=&r"(tmp), [t4] "=&r"(sign)
+      : [xl] "+r"(x), [yl] "+r"(y)
+      :);
+
+  return result;
+}
+
+/*
+ * Accumulates the product of the 16-bit values in the low halves of x and y.
+ * With x = xh * 256 + xl and y = yh * 256 + yl (xh, yh signed, xl, yl unsigned bytes)
+ * x * y = (xh * yh << 16) + ((xh * yl + yh * xl) << 8) + xl * yl,
+ * the three parts go to separate accumulators and are shifted once per block (see COMBINE_16).
+ */
+#define MUL_16(x, y, ll, mid, hh)       \
+  do {                                  \
+    int tmp;                            \
+                                        \
+    __builtin_mul_ul_ul_rrr(tmp, x, y); \
+    ll += tmp;                          \
+    __builtin_mul_sh_ul_rrr(tmp, x, y); \
+    mid += tmp;                         \
+    __builtin_mul_sh_ul_rrr(tmp, y, x); \
+    mid += tmp;                         \
+    __builtin_mul_sh_sh_rrr(tmp, x, y); \
+    hh += tmp;                          \
+  } while (0)
+
+/*
+ * Performs a dot product of four 16-bit values, x and y are 8B aligned.
+ */
+#define DOT_4(x, y, ll, mid, hh)    \
+  do {                              \
+    unsigned long x_dw, y_dw;       \
+    unsigned int x_w, y_w;          \
+                                    \
+    x_dw = *((unsigned long *)(x)); \
+    y_dw = *((unsigned long *)(y)); \
+    x_w = x_dw;                     \
+    y_w = y_dw;                     \
+    MUL_16(x_w, y_w, ll, mid, hh);  \
+    x_w >>= 16;                     \
+    y_w >>= 16;                     \
+    MUL_16(x_w, y_w, ll, mid, hh);  \
+    x_w = x_dw >> 32;               \
+    y_w = y_dw >> 32;               \
+    MUL_16(x_w, y_w, ll, mid, hh);  \
+    x_w >>= 16;                     \
+    y_w >>= 16;                     \
+    MUL_16(x_w, y_w, ll, mid, hh);  \
+  } while (0)
+
+// Sums of products, partial sums are unsigned, so they wrap the same way int multiplication does
+#define COMBINE_16(ll, mid, hh) ((int)((ll) + ((mid) << 8) + ((hh) << 16)))
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <mram.h>
+#include <stdint.h>
+
+#include "share_zero_blocks.h"
+
+/*
+ * Decodes a zero word compressed block (see share_zero_blocks.h) at src into dst.
+ *
+ * dst holds ZB_BLOCK_BYTES and masks ZB_HEADER_BYTES, both 8B aligned WRAM.
+ * Non zero words are read into the end of dst and spread forward in place, a word never moves
+ * past the ones still waiting to be read, so no extra buffer is needed.
+ * Returns size of the block in MRAM, nr_words is set to the number of non zero words,
+ * dst is left untouched when it's 0.
+ */
+static inline uint32_t zb_decode_block(__mram_ptr uint8_t *src, uint64_t *dst, uint32_t *masks, uint32_t *nr_words) {
+  mram_read((__mram_ptr void *)src, masks, ZB_HEADER_BYTES);
+
+  uint32_t count = 0;
+  for (uint32_t h = 0; h < ZB_MASK_WORDS; h++) {
+    count += __builtin_popcount(masks[h]);
+  }
+  *nr_words = count;
+  if (count == 0) {
+    return ZB_HEADER_BYTES;
+  }
+
+  uint64_t *payload = dst + ZB_BLOCK_WORDS - count;
+  mram_read((__mram_ptr void *)(src + ZB_HEADER_BYTES), payload, count * 8);
+  if (count == ZB_BLOCK_WORDS) {
+    return ZB_HEADER_BYTES + ZB_BLOCK_BYTES;
+  }
+
+  uint32_t k = 0;
+  for (uint32_t h = 0; h < ZB_MASK_WORDS; h++) {
+    uint32_t bits = masks[h];
+    uint64_t *out = dst + 32 * h;
+    for (uint32_t w = 0; w < 32; w++) {
+      out[w] = (bits & 1) ? payload[k++] : 0;
+      bits >>= 1;
+    }
+  }
+  return ZB_HEADER_BYTES + count * 8;
+}
@@ -0,0 +1,3 @@
+// Tiled GEMM with bfloat16 A and B, see gemm_half.h
+#define TO_FLOAT bf16_to_float
+#include "gemm_half.h"
@@ -0,0 +1,3 @@
+// Tiled GEMM with IEEE half precision A and B, see gemm_half.h
+#define TO_FLOAT half_to_float
+#include "gemm_half.h"
@@ -0,0 +1,152 @@
+#include <alloc.h>
+#include <barrier.h>
+#include <defs.h>
+#include <mram.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dpu_idle.h"
+#include "share_half.h"
+
+/*
+Tiled GEMM kernel with 16-bit floating point A and B performing C = alpha * A * B + beta * C
+A is a matrix of size m x k (row major),
+B is a matrix of size k x n, stored transposed - n x k (column major),
+C is a matrix of size m x n (row major), float
+
+Included by gemm_f16.c and gemm_bf16.c, TO_FLOAT expands a 16-bit element to float.
+Same tiling as gemm_f.c, blocks of A and B rows are expanded to float once when they're brought to WRAM,
+then every element is used TILE_SIZE times.
+
+MRAM layout:
+A - rows_per_dpu * row_size
+B - cols_per_dpu * row_size, starts 8B aligned
+C - rows_per_dpu * cols_per_dpu, starts 8B aligned
+
+Computing parameters:
+NR_TASKLETS - number of tasklets (threads) running on single DPU
+rows_per_dpu - number of rows of C tile, multiple of TILE_SIZE
+cols_per_dpu - number of columns of C tile, multiple of TILE_SIZE
+row_size - k, length of rows of A and columns of B
+*/
+
+#ifndef TO_FLOAT
+#error "TO_FLOAT has to be defined"
+#endif
+
+#define TILE_SIZE 8
+// TILE_SIZE expanded rows of A and B per tasklet - 2 x 8 x 32 floats = 2KB per tasklet
+#define BLOCK_SIZE 32
+
+struct params {
+  uint32_t rows_per_dpu;
+  uint32_t cols_per_dpu;
+  uint32_t row_size;
+  float alpha;
+  float beta;
+};
+
+__host struct params args;
+
+BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+
+uint32_t alignUpTo8(uint32_t value) { return (value + 7) & ~7; }
+
+uint32_t alignDownTo8(uint32_t value) { return value & ~7; }
+
+// Reads single block of a row and expands it, rows start at any even offset.
+// raw holds BLOCK_SIZE + 4 elements, the extra 8B cover rows that don't start 8B aligned.
+static void read_block(uint16_t *mram, uint16_t *raw, float *wram, uint32_t block_length) {
+  uint32_t offset = (uint32_t)mram;
+  mram_read((__mram_ptr void *)(alignDownTo8(offset)), raw, (BLOCK_SIZE + 4) * sizeof(uint16_t));
+  uint16_t *block = raw + (offset & 7) / sizeof(uint16_t);
+  for (uint32_t l = 0; l < block_length; l++) {
+    wram[l] = TO_FLOAT(block[l]);
+  }
+}
+
+int main() {
+  if (dpu_idle) {
+    return 0;
+  }
+  int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset();
+  }
+  barrier_wait(&mem_reset_barrier);
+
+  // Sanity checks: both tile dimensions have to be multiples of TILE_SIZE,
+  // then every row of C micro tile is 8B aligned
+  if (args.rows_per_dpu % TILE_SIZE || args.cols_per_dpu % TILE_SIZE) {
+    return 1;
+  }
+
+  uint32_t mram_offset_in_bytes = 0;
+
+  uint16_t *A_mram = (uint16_t *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+  mram_offset_in_bytes += alignUpTo8(args.rows_per_dpu * args.row_size * sizeof(uint16_t));
+
+  uint16_t *B_mram = (uint16_t *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+  mram_offset_in_bytes += alignUpTo8(args.cols_per_dpu * args.row_size * sizeof(uint16_t));
+
+  float *C_mram = (float *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+
+  uint16_t *raw_wram = (uint16_t *)mem_alloc((BLOCK_SIZE + 4) * sizeof(uint16_t));
+  float *A_wram = (float *)mem_alloc(TILE_SIZE * BLOCK_SIZE * sizeof(float));
+  float *B_wram = (float *)mem_alloc(TILE_SIZE * BLOCK_SIZE * sizeof(float));
+  float *C_wram = (float *)mem_alloc(TILE_SIZE * TILE_SIZE * sizeof(float));
+  float *result_wram = (float *)mem_alloc(TILE_SIZE * sizeof(float));
+
+  uint32_t nr_tile_rows = args.rows_per_dpu / TILE_SIZE;
+  uint32_t nr_tile_cols = args.cols_per_dpu / TILE_SIZE;
+  uint32_t nr_tiles = nr_tile_rows * nr_tile_cols;
+  uint32_t nr_blocks = (args.row_size - 1) / BLOCK_SIZE + 1;
+
+  for (uint32_t tile = tasklet_id; tile < nr_tiles; tile += NR_TASKLETS) {
+    uint32_t tile_row = (tile / nr_tile_cols) * TILE_SIZE;
+    uint32_t tile_col = (tile % nr_tile_cols) * TILE_SIZE;
+
+    // zero out the results - tasklet computes many tiles
+    memset(C_wram, 0, TILE_SIZE * TILE_SIZE * sizeof(float));
+
+    for (uint32_t block = 0; block < nr_blocks; block++) {
+      const uint32_t block_offset = block * BLOCK_SIZE;
+      uint32_t block_length = block_offset + BLOCK_SIZE <= args.row_size ? BLOCK_SIZE : args.row_size - block_offset;
+
+      for (uint32_t i = 0; i < TILE_SIZE; i++) {
+        read_block(A_mram + (tile_row + i) * args.row_size + block_offset, raw_wram, A_wram + i * BLOCK_SIZE,
+                   block_length);
+        read_block(B_mram + (tile_col + i) * args.row_size + block_offset, raw_wram, B_wram + i * BLOCK_SIZE,
+                   block_length);
+      }
+
+      for (uint32_t i = 0; i < TILE_SIZE; i++) {
+        float *a = A_wram + i * BLOCK_SIZE;
+        for (uint32_t j = 0; j < TILE_SIZE; j++) {
+          float *b = B_wram + j * BLOCK_SIZE;
+          float sum = 0;
+          for (uint32_t l = 0; l < block_length; l++) {
+            sum += a[l] * b[l];
+          }
+          C_wram[i * TILE_SIZE + j] += sum;
+        }
+      }
+    }
+
+    for (uint32_t i = 0; i < TILE_SIZE; i++) {
+      float *result_mram = C_mram + (tile_row + i) * args.cols_per_dpu + tile_col;
+      if (args.beta != 0.0f) {
+        mram_read((__mram_ptr void *)(result_mram), result_wram, TILE_SIZE * sizeof(float));
+        for (uint32_t j = 0; j < TILE_SIZE; j++) {
+          result_wram[j] = args.alpha * C_wram[i * TILE_SIZE + j] + args.beta * result_wram[j];
+        }
+      } else {
+        for (uint32_t j = 0; j < TILE_SIZE; j++) {
+          result_wram[j] = args.alpha * C_wram[i * TILE_SIZE + j];
+        }
+      }
+      mram_write(result_wram, (__mram_ptr void *)(result_mram), TILE_SIZE * sizeof(float));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,155 @@
+#include <alloc.h>
+#include <barrier.h>
+#include <defs.h>
+#include <mram.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dpu_idle.h"
+#include "int_mul.h"
+
+/*
+Tiled GEMM kernel performing C = alpha * A * B + beta * C
+A is a matrix of size m x k (row major),
+B is a matrix of size k x n, stored transposed - n x k (column major),
+C is a matrix of size m x n (row major)
+
+Notes:
+Host splits C into a 2D grid, every DPU computes a single rows_per_dpu x cols_per_dpu tile of C.
+DPU gets rows_per_dpu rows of A and cols_per_dpu columns of B.
+
+Tile of C is split into TILE_SIZE x TILE_SIZE micro tiles, which are distributed across tasklets.
+For every micro tile, blocks of TILE_SIZE rows of A and TILE_SIZE columns of B are brought to WRAM
+and every element read from MRAM is used TILE_SIZE times (GEMV uses it once).
+
+MRAM layout:
+A - rows_per_dpu * row_size
+B - cols_per_dpu * row_size, starts 8B aligned
+C - rows_per_dpu * cols_per_dpu, starts 8B aligned
+
+Computing parameters:
+NR_TASKLETS - number of tasklets (threads) running on single DPU
+rows_per_dpu - number of rows of C tile, multiple of TILE_SIZE
+cols_per_dpu - number of columns of C tile, multiple of TILE_SIZE
+row_size - k, length of rows of A and columns of B
+*/
+
+#define TILE_SIZE 8
+// TILE_SIZE rows of A and B per tasklet - 2 x 8 x 32 ints = 2KB per tasklet
+#define BLOCK_SIZE 32
+
+struct params {
+  uint32_t rows_per_dpu;
+  uint32_t cols_per_dpu;
+  uint32_t row_size;
+  int alpha;
+  int beta;
+};
+
+__host struct params args;
+
+BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+
+uint32_t alignUpTo8(uint32_t value) { return (value + 7) & ~7; }
+
+uint32_t alignDownTo8(uint32_t value) { return value & ~7; }
+
+// Reads single block of a row, rows don't have to start 8B aligned
+static int *read_block(int *mram, int *wram) {
+  uint32_t offset = (uint32_t)mram;
+  if (offset & 7) {
+    mram_read((__mram_ptr void *)(alignDownTo8(offset)), wram, (BLOCK_SIZE + 2) * sizeof(int));
+    return wram + 1;
+  }
+  mram_read((__mram_ptr void *)(offset), wram, BLOCK_SIZE * sizeof(int));
+  return wram;
+}
+
+int main() {
+  if (dpu_idle) {
+    return 0;
+  }
+  int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset();
+  }
+  barrier_wait(&mem_reset_barrier);
+
+  // Sanity checks: both tile dimensions have to be multiples of TILE_SIZE,
+  // then every row of C micro tile is 8B aligned
+  if (args.rows_per_dpu % TILE_SIZE || args.cols_per_dpu % TILE_SIZE) {
+    return 1;
+  }
+
+  uint32_t mram_offset_in_bytes = 0;
+
+  int *A_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+  mram_offset_in_bytes += alignUpTo8(args.rows_per_dpu * args.row_size * sizeof(int));
+
+  int *B_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+  mram_offset_in_bytes += alignUpTo8(args.cols_per_dpu * args.row_size * sizeof(int));
+
+  int *C_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+
+  // Extra 8B per row for reading unaligned rows
+  const uint32_t wram_row = BLOCK_SIZE + 2;
+  int *A_wram = (int *)mem_alloc(TILE_SIZE * wram_row * sizeof(int));
+  int *B_wram = (int *)mem_alloc(TILE_SIZE * wram_row * sizeof(int));
+  int *C_wram = (int *)mem_alloc(TILE_SIZE * TILE_SIZE * sizeof(int));
+  int *result_wram = (int *)mem_alloc(TILE_SIZE * sizeof(int));
+
+  int *A_rows[TILE_SIZE];
+  int *B_rows[TILE_SIZE];
+
+  uint32_t nr_tile_rows = args.rows_per_dpu / TILE_SIZE;
+  uint32_t nr_tile_cols = args.cols_per_dpu / TILE_SIZE;
+  uint32_t nr_tiles = nr_tile_rows * nr_tile_cols;
+  uint32_t nr_blocks = (args.row_size - 1) / BLOCK_SIZE + 1;
+
+  for (uint32_t tile = tasklet_id; tile < nr_tiles; tile += NR_TASKLETS) {
+    uint32_t tile_row = (tile / nr_tile_cols) * TILE_SIZE;
+    uint32_t tile_col = (tile % nr_tile_cols) * TILE_SIZE;
+
+    // zero out the results - tasklet computes many tiles
+    memset(C_wram, 0, TILE_SIZE * TILE_SIZE * sizeof(int));
+
+    for (uint32_t block = 0; block < nr_blocks; block++) {
+      const uint32_t block_offset = block * BLOCK_SIZE;
+      uint32_t block_length =
+          block_offset + BLOCK_SIZE <= args.row_size ? BLOCK_SIZE : args.row_size - block_offset;
+
+      for (uint32_t i = 0; i < TILE_SIZE; i++) {
+        A_rows[i] = read_block(A_mram + (tile_row + i) * args.row_size + block_offset, A_wram + i * wram_row);
+        B_rows[i] = read_block(B_mram + (tile_col + i) * args.row_size + block_offset, B_wram + i * wram_row);
+      }
+
+      for (uint32_t i = 0; i < TILE_SIZE; i++) {
+        int *a = A_rows[i];
+        for (uint32_t j = 0; j < TILE_SIZE; j++) {
+          int *b = B_rows[j];
+          int sum = 0;
+          for (uint32_t l = 0; l < block_length; l++) {
+            sum += mul32(a[l], b[l]);
+          }
+          C_wram[i * TILE_SIZE + j] += sum;
+        }
+      }
+    }
+
+    for (uint32_t i = 0; i < TILE_SIZE; i++) {
+      int *result_mram = C_mram + (tile_row + i) * args.cols_per_dpu + tile_col;
+      if (args.beta != 0) {
+        mram_read((__mram_ptr void *)(result_mram), result_wram, TILE_SIZE * sizeof(int));
+        for (uint32_t j = 0; j < TILE_SIZE; j++) {
+          result_wram[j] = args.alpha * C_wram[i * TILE_SIZE + j] + args.beta * result_wram[j];
+        }
+      } else {
+        for (uint32_t j = 0; j < TILE_SIZE; j++) {
+          result_wram[j] = args.alpha * C_wram[i * TILE_SIZE + j];
+        }
+      }
+      mram_write(result_wram, (__mram_ptr void *)(result_mram), TILE_SIZE * sizeof(int));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,3 @@
+// GEMV with bfloat16 A and x, see gemv_half.h
+#define TO_FLOAT bf16_to_float
+#include "gemv_half.h"
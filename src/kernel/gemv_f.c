@@ -5,6 +5,9 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "dpu_idle.h"
+#include "perf_helper.h"
+
 /*
 Basic GEMV kernel performing y = alpha * A * x + beta * y
 A is a matrix of size m x n,
@@ -12,27 +15,42 @@ x is a vector of size n
 y is a vector of size m
 
 Notes:
-Part of A is transferred to single DPU - rows_per_dpu rows
-Part of y - rows_per_dpu elements
+Part of A is transferred to single DPU - nr_rows rows
+Part of y - nr_rows elements
 
 x is same across all DPU's
 
 Computing parameters:
 NR_TASKLETS - number of tasklets (threads) running on single DPU
-rows_per_dpu - maximum number of rows to be processed by single DPU
+rows_per_dpu - rows of A and y reserved in MRAM, same on every DPU
+nr_rows - number of rows processed by this DPU, even and at most rows_per_dpu
 row_size - maximum size of single matrix row
 
 */
 
 // We've got 64KB of WRAM, we are working with 4B floats, and need to allocate wram
-// for part of A rows, and part of X rows and output(small in comparison), and 16 tasklets.
-// That makes 4KB per tasklet, that means we could go to block size 512 - aka 4KB, but that
-// would leave no place for output. So we stick with 256 for now.
-// TODO: Find even more optimal value
+// for part of A rows, shared blocks of x and output(small in comparison), and up to 16 tasklets.
+// x blocks are shared, so A blocks can go up to 512 floats - 2048B, the most mram_read can move at once.
+// Variants (see cmake/kernel_variants.cmake) set BLOCK_SIZE and ALIGNED_ROWS, with ALIGNED_ROWS
+// every row starts 8B aligned (row_size * sizeof(element) is a multiple of 8) and the unaligned path is left out.
+#ifndef BLOCK_SIZE
+// Every tasklet keeps its own A block, past 16 tasklets they no longer fit in WRAM at full size
+#if NR_TASKLETS > 16
 #define BLOCK_SIZE 256
+#else
+#define BLOCK_SIZE 512
+#endif
+#endif
+#ifndef ALIGNED_ROWS
+#define ALIGNED_ROWS 0
+#endif
+// Part of a shared x block read by a single tasklet, rounded up to 8B, so with tasklet counts that
+// don't divide the block the last slice is shorter and the last tasklets may have none
+#define X_SLICE (((BLOCK_SIZE + NR_TASKLETS - 1) / NR_TASKLETS + 1) & ~1)
 
 struct params {
   uint32_t rows_per_dpu;
+  uint32_t nr_rows;
   uint32_t row_size;
   float alpha;
   float beta;
@@ -40,7 +58,13 @@ struct params {
 
 __host struct params args;
 
+// Every x block is read once per DPU, tasklets load a slice each and meet at x_barrier.
+// Blocks alternate between two buffers, so the next block can be loaded while slow tasklets
+// still work on the previous one.
+__dma_aligned float x_blocks[2][BLOCK_SIZE];
+
 BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+BARRIER_INIT(x_barrier, NR_TASKLETS);
 
 uint32_t alignUpTo8(uint32_t value) { return (value + 7) & ~7; }
 
@@ -51,19 +75,31 @@ uint32_t alignUpTo64(uint32_t value) { return (value + 63) & ~63; }
 uint32_t alignUpTo2(uint32_t value) { return (value + 1) & ~1; }
 
 int main() {
+  if (dpu_idle) {
+    return 0;
+  }
   int tasklet_id = me();
   if (tasklet_id == 0) {
     mem_reset();
   }
   barrier_wait(&mem_reset_barrier);
+  PERF_START();
 
-  // Sanity checks: NR_tasklets should be 16, rows_per_dpu should be a multiple of 32, because
-  // rows per tasklet should be even
-  if (NR_TASKLETS != 16 || args.rows_per_dpu & 31) {
+  // Sanity checks: rows are handed out in pairs, because rows per tasklet should be even
+  if ((args.rows_per_dpu & 1) || (args.nr_rows & 1) || args.nr_rows > args.rows_per_dpu) {
+    return 1;
+  }
+  if (ALIGNED_ROWS && ((args.row_size * sizeof(float)) & 7)) {
     return 1;
   }
-  // Rows per tasklet
-  int rows_per_tasklet = args.rows_per_dpu / NR_TASKLETS;
+  // Every tasklet gets the same number of pairs, the first ones take one leftover pair each
+  uint32_t nr_pairs = args.nr_rows / 2;
+  uint32_t leftover_pairs = nr_pairs % NR_TASKLETS;
+  uint32_t first_pair = tasklet_id * (nr_pairs / NR_TASKLETS);
+  first_pair += tasklet_id < leftover_pairs ? tasklet_id : leftover_pairs;
+  uint32_t first_row = 2 * first_pair;
+  // Tasklets without rows still load their slices of x
+  int rows_per_tasklet = 2 * (nr_pairs / NR_TASKLETS + (tasklet_id < leftover_pairs ? 1 : 0));
 
   // Note: All MRAM allocations need to be 8B aligned in order to read from/write to them.
 
@@ -72,23 +108,15 @@ int main() {
   // so it should be fine, because we are operating 4B floats.
   uint32_t mram_offset_in_bytes = 0;
 
-  float *A_mram = (float *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes +
-                            (tasklet_id * args.row_size * rows_per_tasklet) * sizeof(float));
+  float *A_mram = (float *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes + (first_row * args.row_size) * sizeof(float));
   mram_offset_in_bytes += alignUpTo8(args.row_size * args.rows_per_dpu * sizeof(float));
 
   float *x_mram = (float *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
   mram_offset_in_bytes += alignUpTo8(args.row_size * sizeof(float));
 
   // Should be fine as long as rows_per_tasklet is even
-  float *result_mram =
-      (float *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes + (tasklet_id * rows_per_tasklet) * sizeof(float));
-
-  // TODO: Find better way to share x across all tasklets, because now we
-  // have multiple copies of the same values across tasklets.
-  // If number of rows to be processed is small enough it should be possible
-  // or we could just make a barrier and wait until all tasklets finish until
-  // getting another part of x
-  float *x_wram = (float *)mem_alloc(BLOCK_SIZE * sizeof(float));
+  float *result_mram = (float *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes + first_row * sizeof(float));
+
   // It's important we allocate more memory for A_wram, because of the hack
   // we later to do to write into it from mram (alignment issues).
   // We add 64B in order to be aligned.
@@ -102,22 +130,35 @@ int main() {
   // zero out the results - it's required when we are running the kernel multiple times.
   memset(mul_result_wram, 0, result_size);
 
+  // Slice of every x block loaded by this tasklet, empty for tasklets past the end of the block
+  uint32_t x_first = tasklet_id * X_SLICE;
+  uint32_t x_length = x_first < BLOCK_SIZE ? BLOCK_SIZE - x_first : 0;
+  x_length = x_length < X_SLICE ? x_length : X_SLICE;
+
   int nr_blocks = (args.row_size - 1) / BLOCK_SIZE + 1;
   for (uint32_t block = 0; block < nr_blocks; block++) {
     const int block_offset = block * BLOCK_SIZE;
 
     int block_length = block_offset + BLOCK_SIZE <= args.row_size ? BLOCK_SIZE : args.row_size - block_offset;
-    mram_read((__mram_ptr void *)(x_mram + block_offset), x_wram, BLOCK_SIZE * sizeof(float));
+    // Buffer of this block was last used for block - 2, every tasklet is done with it,
+    // because it went through the barrier of block - 1 after that
+    float *x_wram = x_blocks[block & 1];
+    if (x_length != 0) {
+      mram_read((__mram_ptr void *)(x_mram + block_offset + x_first), x_wram + x_first, x_length * sizeof(float));
+    }
+    barrier_wait(&x_barrier);
     for (uint32_t i = 0; i < rows_per_tasklet; i++) {
       float sum = 0;
       uint32_t a_offset = (uint32_t)(A_mram + i * args.row_size + block_offset);
       float *A_wram_read = NULL;
-      if (a_offset & 7) {
+      if (!ALIGNED_ROWS && (a_offset & 7)) {
         // If offset is not aligned to 8B it will be automatically aligned down to 8 bytes
         // This happens when row_size is an odd value.
         // In our case when we are working on 4B floats it means we need to shift
         // one float (4B) to get to the values we want. That also means we need to read a bit more
-        mram_read((__mram_ptr void *)(alignDownTo8(a_offset)), A_wram, (BLOCK_SIZE + 2) * sizeof(float));
+        // Single mram_read can't cover the whole block and the extra 8B
+        mram_read((__mram_ptr void *)(alignDownTo8(a_offset)), A_wram, BLOCK_SIZE * sizeof(float));
+        mram_read((__mram_ptr void *)(alignDownTo8(a_offset) + BLOCK_SIZE * sizeof(float)), A_wram + BLOCK_SIZE, 8);
         A_wram_read = (A_wram + 1);
       } else {
         mram_read((__mram_ptr void *)(a_offset), A_wram, BLOCK_SIZE * sizeof(float));
@@ -132,6 +173,11 @@ int main() {
     }
   }
 
+  if (rows_per_tasklet == 0) {
+    PERF_STOP();
+    return 0;
+  }
+
   float *result_wram = (float *)mem_alloc(result_size);
   mram_read((__mram_ptr void *)(result_mram), result_wram, rows_per_tasklet * sizeof(float));
 
@@ -149,5 +195,6 @@ int main() {
 
   mram_write(result_wram, (__mram_ptr void *)result_mram, rows_per_tasklet * sizeof(float));
 
+  PERF_STOP();
   return 0;
 }
\ No newline at end of file
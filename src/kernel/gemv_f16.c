@@ -0,0 +1,3 @@
+// GEMV with IEEE half precision A and x, see gemv_half.h
+#define TO_FLOAT half_to_float
+#include "gemv_half.h"
@@ -0,0 +1,175 @@
+#include <alloc.h>
+#include <barrier.h>
+#include <defs.h>
+#include <mram.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dpu_idle.h"
+#include "perf_helper.h"
+#include "share_half.h"
+
+/*
+GEMV kernel with 16-bit floating point A and x performing y = alpha * A * x + beta * y
+A is a matrix of size m x n,
+x is a vector of size n
+y is a vector of size m, float
+
+Included by gemv_f16.c and gemv_bf16.c, TO_FLOAT expands a 16-bit element to float.
+Elements are expanded in WRAM and accumulated in float, so only the bytes moved from MRAM are halved.
+x is expanded once per block into the shared x buffer, A once per use.
+
+Notes:
+Part of A is transferred to single DPU - nr_rows rows
+Part of y - nr_rows elements
+
+x is same across all DPU's
+
+Computing parameters:
+NR_TASKLETS - number of tasklets (threads) running on single DPU
+rows_per_dpu - rows of A and y reserved in MRAM, same on every DPU
+nr_rows - number of rows processed by this DPU, even and at most rows_per_dpu
+row_size - maximum size of single matrix row
+*/
+
+#ifndef TO_FLOAT
+#error "TO_FLOAT has to be defined"
+#endif
+
+// A blocks are 1KB, same block of float x is 2KB and shared (see gemv_f.c)
+#ifndef BLOCK_SIZE
+#define BLOCK_SIZE 512
+#endif
+// Part of a shared x block read by a single tasklet, rounded up to 8B (4 elements)
+#define X_SLICE (((BLOCK_SIZE + NR_TASKLETS - 1) / NR_TASKLETS + 3) & ~3)
+
+struct params {
+  uint32_t rows_per_dpu;
+  uint32_t nr_rows;
+  uint32_t row_size;
+  float alpha;
+  float beta;
+};
+
+__host struct params args;
+
+// Expanded x blocks, double buffered as in gemv_f.c
+__dma_aligned float x_blocks[2][BLOCK_SIZE];
+
+BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+BARRIER_INIT(x_barrier, NR_TASKLETS);
+
+uint32_t alignUpTo8(uint32_t value) { return (value + 7) & ~7; }
+
+uint32_t alignDownTo8(uint32_t value) { return value & ~7; }
+
+uint32_t alignUpTo64(uint32_t value) { return (value + 63) & ~63; }
+
+int main() {
+  if (dpu_idle) {
+    return 0;
+  }
+  int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset();
+  }
+  barrier_wait(&mem_reset_barrier);
+  PERF_START();
+
+  // Sanity checks: rows are handed out in pairs, because rows per tasklet should be even
+  if ((args.rows_per_dpu & 1) || (args.nr_rows & 1) || args.nr_rows > args.rows_per_dpu) {
+    return 1;
+  }
+  // Every tasklet gets the same number of pairs, the first ones take one leftover pair each
+  uint32_t nr_pairs = args.nr_rows / 2;
+  uint32_t leftover_pairs = nr_pairs % NR_TASKLETS;
+  uint32_t first_pair = tasklet_id * (nr_pairs / NR_TASKLETS);
+  first_pair += tasklet_id < leftover_pairs ? tasklet_id : leftover_pairs;
+  uint32_t first_row = 2 * first_pair;
+  // Tasklets without rows still load their slices of x
+  int rows_per_tasklet = 2 * (nr_pairs / NR_TASKLETS + (tasklet_id < leftover_pairs ? 1 : 0));
+
+  // Note: All MRAM allocations need to be 8B aligned in order to read from/write to them.
+  // Rows of 2B elements start at any even offset, y stays 8B aligned because rows come in pairs.
+  uint32_t mram_offset_in_bytes = 0;
+
+  uint16_t *A_mram =
+      (uint16_t *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes + (first_row * args.row_size) * sizeof(uint16_t));
+  mram_offset_in_bytes += alignUpTo8(args.row_size * args.rows_per_dpu * sizeof(uint16_t));
+
+  uint16_t *x_mram = (uint16_t *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+  mram_offset_in_bytes += alignUpTo8(args.row_size * sizeof(uint16_t));
+
+  float *result_mram = (float *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes + first_row * sizeof(float));
+
+  // Unaligned rows are read from the 8B boundary below them, that's up to 3 more elements
+  uint16_t *A_wram = (uint16_t *)mem_alloc(BLOCK_SIZE * sizeof(uint16_t) + 8);
+  uint16_t *x_slice_wram = (uint16_t *)mem_alloc(X_SLICE * sizeof(uint16_t));
+
+  // Allocation needs to be aligned to 64B, or we start getting
+  // allocations on top of another...
+  uint32_t result_size = alignUpTo64(rows_per_tasklet * sizeof(float));
+  float *mul_result_wram = (float *)mem_alloc(result_size);
+
+  // zero out the results - it's required when we are running the kernel multiple times.
+  memset(mul_result_wram, 0, result_size);
+
+  // Slice of every x block loaded by this tasklet, empty for tasklets past the end of the block
+  uint32_t x_first = tasklet_id * X_SLICE;
+  uint32_t x_length = x_first < BLOCK_SIZE ? BLOCK_SIZE - x_first : 0;
+  x_length = x_length < X_SLICE ? x_length : X_SLICE;
+
+  int nr_blocks = (args.row_size - 1) / BLOCK_SIZE + 1;
+  for (uint32_t block = 0; block < nr_blocks; block++) {
+    const int block_offset = block * BLOCK_SIZE;
+
+    int block_length = block_offset + BLOCK_SIZE <= args.row_size ? BLOCK_SIZE : args.row_size - block_offset;
+    // Buffer of this block was last used for block - 2, every tasklet is done with it,
+    // because it went through the barrier of block - 1 after that
+    float *x_wram = x_blocks[block & 1];
+    if (x_length != 0) {
+      mram_read((__mram_ptr void *)(x_mram + block_offset + x_first), x_slice_wram, x_length * sizeof(uint16_t));
+      for (uint32_t j = 0; j < x_length; j++) {
+        x_wram[x_first + j] = TO_FLOAT(x_slice_wram[j]);
+      }
+    }
+    barrier_wait(&x_barrier);
+    for (uint32_t i = 0; i < rows_per_tasklet; i++) {
+      float sum = 0;
+      uint32_t a_offset = (uint32_t)(A_mram + i * args.row_size + block_offset);
+      mram_read((__mram_ptr void *)(alignDownTo8(a_offset)), A_wram, BLOCK_SIZE * sizeof(uint16_t) + 8);
+      uint16_t *A_wram_read = A_wram + (a_offset & 7) / sizeof(uint16_t);
+
+      for (uint32_t j = 0; j < block_length; ++j) {
+        sum += TO_FLOAT(A_wram_read[j]) * x_wram[j];
+      }
+
+      mul_result_wram[i] += sum;
+    }
+  }
+
+  if (rows_per_tasklet == 0) {
+    PERF_STOP();
+    return 0;
+  }
+
+  float *result_wram = (float *)mem_alloc(result_size);
+  mram_read((__mram_ptr void *)(result_mram), result_wram, rows_per_tasklet * sizeof(float));
+
+  if (args.beta != 0.0f) {
+    for (uint32_t i = 0; i < rows_per_tasklet; i++) {
+      // y = alpha * Ax + beta * y
+      result_wram[i] = args.alpha * mul_result_wram[i] + args.beta * result_wram[i];
+    }
+  } else {
+    for (uint32_t i = 0; i < rows_per_tasklet; i++) {
+      // y = alpha * Ax
+      result_wram[i] = args.alpha * mul_result_wram[i];
+    }
+  }
+
+  mram_write(result_wram, (__mram_ptr void *)result_mram, rows_per_tasklet * sizeof(float));
+
+  PERF_STOP();
+  return 0;
+}
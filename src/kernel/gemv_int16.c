@@ -0,0 +1,181 @@
+#include <alloc.h>
+#include <barrier.h>
+#include <built_ins.h>
+#include <defs.h>
+#include <mram.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dpu_idle.h"
+#include "int_mul.h"
+#include "perf_helper.h"
+
+/*
+Basic GEMV kernel performing y = alpha * A * x + beta * y
+A is a matrix of size m x n, int16
+x is a vector of size n, int16
+y is a vector of size m, int
+
+Notes:
+Part of A is transferred to single DPU - nr_rows rows
+Part of y - nr_rows elements
+
+x is same across all DPU's
+
+Computing parameters:
+NR_TASKLETS - number of tasklets (threads) running on single DPU
+rows_per_dpu - rows of A and y reserved in MRAM, same on every DPU
+nr_rows - number of rows processed by this DPU, even and at most rows_per_dpu
+row_size - maximum size of single matrix row
+
+The DPU multiplies bytes, a 16-bit product is put together from four of them (see MUL_16),
+that's still far less than the 32-bit multiplication of gemv_int32.c.
+*/
+
+// x blocks are shared, so the WRAM they took in every tasklet goes to A blocks,
+// mram_read can't move more than 2048B at once.
+// Variants (see cmake/kernel_variants.cmake) set BLOCK_SIZE and ALIGNED_ROWS, with ALIGNED_ROWS
+// every row starts 8B aligned (row_size * sizeof(element) is a multiple of 8) and the unaligned path is left out.
+#ifndef BLOCK_SIZE
+// Every tasklet keeps its own A block, past 16 tasklets they no longer fit in WRAM at full size
+#if NR_TASKLETS > 16
+#define BLOCK_SIZE 512
+#else
+#define BLOCK_SIZE 1024
+#endif
+#endif
+#ifndef ALIGNED_ROWS
+#define ALIGNED_ROWS 0
+#endif
+// Part of a shared x block read by a single tasklet, rounded up to 8B (4 elements)
+#define X_SLICE (((BLOCK_SIZE + NR_TASKLETS - 1) / NR_TASKLETS + 3) & ~3)
+
+#define MIN(x, y) (((y) < (x)) ? (y) : (x))
+#define ROUND_DOWN(x, s) ((x) & ~((s) - 1))
+
+struct params {
+  uint32_t rows_per_dpu;
+  uint32_t nr_rows;
+  uint32_t row_size;
+  int alpha;
+  int beta;
+};
+
+__host struct params args;
+
+// Every x block is read once per DPU, tasklets load a slice each and meet at x_barrier.
+// Blocks alternate between two buffers, so the next block can be loaded while slow tasklets
+// still work on the previous one.
+__dma_aligned int16_t x_blocks[2][BLOCK_SIZE];
+
+BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+BARRIER_INIT(x_barrier, NR_TASKLETS);
+
+int main() {
+  if (dpu_idle) {
+    return 0;
+  }
+  int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset();
+  }
+  barrier_wait(&mem_reset_barrier);
+  PERF_START();
+
+  // Sanity checks: rows are handed out in pairs, because rows per tasklet should be even
+  if ((args.rows_per_dpu & 1) || (args.nr_rows & 1) || args.nr_rows > args.rows_per_dpu) {
+    return 1;
+  }
+  if (ALIGNED_ROWS && (args.row_size & 3)) {
+    return 1;
+  }
+  // Every tasklet gets the same number of pairs, the first ones take one leftover pair each
+  uint32_t nr_pairs = args.nr_rows / 2;
+  uint32_t leftover_pairs = nr_pairs % NR_TASKLETS;
+  uint32_t first_pair = tasklet_id * (nr_pairs / NR_TASKLETS);
+  first_pair += tasklet_id < leftover_pairs ? tasklet_id : leftover_pairs;
+  uint32_t first_row = 2 * first_pair;
+  // Tasklets without rows still load their slices of x
+  int rows_per_tasklet = 2 * (nr_pairs / NR_TASKLETS + (tasklet_id < leftover_pairs ? 1 : 0));
+
+  // Note: All MRAM allocations need to be 8B aligned in order to read from/write to them.
+  // Offsets below are in bytes, rows of 2B elements start at any even offset.
+  uint32_t A_mram_offset = first_row * args.row_size * sizeof(int16_t);
+  uint8_t *A_mram = (uint8_t *)(DPU_MRAM_HEAP_POINTER);
+  uint32_t mram_offset = (args.row_size * args.rows_per_dpu * sizeof(int16_t) + 7) & ~7;
+
+  int16_t *x_mram = (int16_t *)(DPU_MRAM_HEAP_POINTER + mram_offset);
+  mram_offset += (args.row_size * sizeof(int16_t) + 7) & ~7;
+
+  // Should be fine as long as rows_per_tasklet is even
+  int *y_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset + first_row * sizeof(int));
+
+  // Unaligned rows are read from the 8B boundary below them, that's up to 3 more elements
+  int16_t *A_wram = (int16_t *)mem_alloc(BLOCK_SIZE * sizeof(int16_t) + 8);
+
+  int Ax_len = rows_per_tasklet * sizeof(int);
+  int *Ax_wram = (int *)mem_alloc(Ax_len);
+
+  // zero out the results - it's required when we are running the kernel multiple times.
+  memset(Ax_wram, 0, Ax_len);
+
+  // Slice of every x block loaded by this tasklet, empty for tasklets past the end of the block
+  uint32_t x_first = tasklet_id * X_SLICE;
+  uint32_t x_length = x_first < BLOCK_SIZE ? BLOCK_SIZE - x_first : 0;
+  x_length = x_length < X_SLICE ? x_length : X_SLICE;
+
+  int nr_blocks = (args.row_size - 1) / BLOCK_SIZE + 1;
+  for (int b = 0; b < nr_blocks; ++b) {
+    int b_offset = b * BLOCK_SIZE;
+    int b_length = MIN(BLOCK_SIZE, args.row_size - b_offset);
+    // Buffer of this block was last used for block b - 2, every tasklet is done with it,
+    // because it went through the barrier of block b - 1 after that
+    int16_t *x_wram = x_blocks[b & 1];
+    if (x_length != 0) {
+      mram_read((__mram_ptr void *)(x_mram + b_offset + x_first), x_wram + x_first, x_length * sizeof(int16_t));
+    }
+    barrier_wait(&x_barrier);
+    for (int i = 0; i < rows_per_tasklet; ++i) {
+      uint32_t A_offset = A_mram_offset + (i * args.row_size + b_offset) * sizeof(int16_t);
+      int16_t *A_wram_read = A_wram;
+      uint32_t ll = 0, mid = 0, hh = 0;
+      int j = 0;
+      if (!ALIGNED_ROWS && (A_offset & 7)) {
+        // Single mram_read can't cover the whole block and the extra 8B
+        mram_read((__mram_ptr void *)(A_mram + ROUND_DOWN(A_offset, 8)), A_wram, BLOCK_SIZE * sizeof(int16_t));
+        mram_read((__mram_ptr void *)(A_mram + ROUND_DOWN(A_offset, 8) + BLOCK_SIZE * sizeof(int16_t)),
+                  A_wram + BLOCK_SIZE, 8);
+        A_wram_read += (A_offset & 7) / sizeof(int16_t);
+      } else {
+        mram_read((__mram_ptr void *)(A_mram + A_offset), A_wram, BLOCK_SIZE * sizeof(int16_t));
+
+#pragma unroll(16)
+        for (; j < ROUND_DOWN(b_length, 4); j += 4) {
+          DOT_4(&A_wram_read[j], &x_wram[j], ll, mid, hh);
+        }
+      }
+
+      for (; j < b_length; ++j) {
+        MUL_16(A_wram_read[j], x_wram[j], ll, mid, hh);
+      }
+
+      Ax_wram[i] += COMBINE_16(ll, mid, hh);
+    }
+  }
+
+  if (rows_per_tasklet == 0) {
+    PERF_STOP();
+    return 0;
+  }
+
+  int *y_wram = (int *)mem_alloc(Ax_len);
+  mram_read((__mram_ptr void *)y_mram, y_wram, rows_per_tasklet * sizeof(int));
+
+  for (int i = 0; i < rows_per_tasklet; ++i) {
+    y_wram[i] = args.alpha * Ax_wram[i] + args.beta * y_wram[i];
+  }
+
+  mram_write(y_wram, (__mram_ptr void *)y_mram, rows_per_tasklet * sizeof(int));
+  PERF_STOP();
+  return 0;
+}
@@ -6,6 +6,10 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "dpu_idle.h"
+#include "int_mul.h"
+#include "perf_helper.h"
+
 /*
 Basic GEMV kernel performing y = alpha * A * x + beta * y
 A is a matrix of size m x n,
@@ -13,70 +17,45 @@ x is a vector of size n
 y is a vector of size m
 
 Notes:
-Part of A is transferred to single DPU - rows_per_dpu rows
-Part of y - rows_per_dpu elements
+Part of A is transferred to single DPU - nr_rows rows
+Part of y - nr_rows elements
 
 x is same across all DPU's
 
 Computing parameters:
 NR_TASKLETS - number of tasklets (threads) running on single DPU
-rows_per_dpu - maximum number of rows to be processed by single DPU
+rows_per_dpu - rows of A and y reserved in MRAM, same on every DPU
+nr_rows - number of rows processed by this DPU, even and at most rows_per_dpu
 row_size - maximum size of single matrix row
 
 */
 
+// x blocks are shared, so the WRAM they took in every tasklet goes to A blocks,
+// mram_read can't move more than 2048B at once.
+// Variants (see cmake/kernel_variants.cmake) set BLOCK_SIZE and ALIGNED_ROWS, with ALIGNED_ROWS
+// every row starts 8B aligned (row_size * sizeof(element) is a multiple of 8) and the unaligned path is left out.
+#ifndef BLOCK_SIZE
+// Every tasklet keeps its own A block, past 16 tasklets they no longer fit in WRAM at full size
+#if NR_TASKLETS > 16
 #define BLOCK_SIZE 1024
+#else
+#define BLOCK_SIZE 2048
+#endif
+#endif
+#ifndef ALIGNED_ROWS
+#define ALIGNED_ROWS 0
+#endif
+// Part of a shared x block read by a single tasklet, rounded up to 8B, so with tasklet counts that
+// don't divide the block the last slice is shorter and the last tasklets may have none
+#define X_SLICE (((BLOCK_SIZE + NR_TASKLETS - 1) / NR_TASKLETS + 7) & ~7)
 
 #define MIN(x, y) (((y) < (x)) ? (y) : (x))
 #define ROUND_UP(x, s) (((x) + ((s) - 1)) & ~((s) - 1))
 #define ROUND_DOWN(x, s) ((x) & ~((s) - 1))
 
-/*
- * Performs a dot product of eight 8-bit values.
- *
- * This macro loads two 64-bit values from the memory locations pointed to
- * by `x` and `y`, respectively. It then calculates the dot product of the
- * individual 8-bit integers from both `x` and `y` in a highly optimized
- * manner using various multiplication intrinsics.
- */
-#define DOT_8(x, y, acc)                      \
-  do {                                        \
-    unsigned long x_dw, y_dw;                 \
-    unsigned int x_lo, x_hi, y_lo, y_hi;      \
-    int tmp;                                  \
-                                              \
-    x_dw = *((unsigned long *)(x));           \
-    x_lo = x_dw;                              \
-    x_hi = x_dw >> 32;                        \
-    y_dw = *((unsigned long *)(y));           \
-    y_lo = y_dw;                              \
-    y_hi = y_dw >> 32;                        \
-                                              \
-    __builtin_mul_sl_sl_rrr(tmp, x_lo, y_lo); \
-    acc += tmp;                               \
-    __builtin_mul_sh_sh_rrr(tmp, x_lo, y_lo); \
-    acc += tmp;                               \
-    x_lo >>= 16;                              \
-    y_lo >>= 16;                              \
-    __builtin_mul_sl_sl_rrr(tmp, x_lo, y_lo); \
-    acc += tmp;                               \
-    __builtin_mul_sh_sh_rrr(tmp, x_lo, y_lo); \
-                                              \
-    acc += tmp;                               \
-    __builtin_mul_sl_sl_rrr(tmp, x_hi, y_hi); \
-    acc += tmp;                               \
-    __builtin_mul_sh_sh_rrr(tmp, x_hi, y_hi); \
-    acc += tmp;                               \
-    x_hi >>= 16;                              \
-    y_hi >>= 16;                              \
-    __builtin_mul_sl_sl_rrr(tmp, x_hi, y_hi); \
-    acc += tmp;                               \
-    __builtin_mul_sh_sh_rrr(tmp, x_hi, y_hi); \
-    acc += tmp;                               \
-  } while (0)
-
 struct params {
   uint32_t rows_per_dpu;
+  uint32_t nr_rows;
   uint32_t row_size;
   int alpha;
   int beta;
@@ -84,26 +63,44 @@ struct params {
 
 __host struct params args;
 
+// Every x block is read once per DPU, tasklets load a slice each and meet at x_barrier.
+// Blocks alternate between two buffers, so the next block can be loaded while slow tasklets
+// still work on the previous one.
+__dma_aligned int8_t x_blocks[2][BLOCK_SIZE];
+
 BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+BARRIER_INIT(x_barrier, NR_TASKLETS);
 
 int main() {
+  if (dpu_idle) {
+    return 0;
+  }
   int tasklet_id = me();
   if (tasklet_id == 0) {
     mem_reset();
   }
   barrier_wait(&mem_reset_barrier);
+  PERF_START();
 
-  // Sanity checks: NR_tasklets should be 16, rows_per_dpu should be a multiple of 32, because
-  // rows per tasklet should be even
-  if (NR_TASKLETS != 16 || args.rows_per_dpu & 31) {
+  // Sanity checks: rows are handed out in pairs, because rows per tasklet should be even
+  if ((args.rows_per_dpu & 1) || (args.nr_rows & 1) || args.nr_rows > args.rows_per_dpu) {
+    return 1;
+  }
+  if (ALIGNED_ROWS && (args.row_size & 7)) {
     return 1;
   }
-  // Rows per tasklet
-  int rows_per_tasklet = args.rows_per_dpu / NR_TASKLETS;
+  // Every tasklet gets the same number of pairs, the first ones take one leftover pair each
+  uint32_t nr_pairs = args.nr_rows / 2;
+  uint32_t leftover_pairs = nr_pairs % NR_TASKLETS;
+  uint32_t first_pair = tasklet_id * (nr_pairs / NR_TASKLETS);
+  first_pair += tasklet_id < leftover_pairs ? tasklet_id : leftover_pairs;
+  uint32_t first_row = 2 * first_pair;
+  // Tasklets without rows still load their slices of x
+  int rows_per_tasklet = 2 * (nr_pairs / NR_TASKLETS + (tasklet_id < leftover_pairs ? 1 : 0));
 
   // Note: All MRAM allocations need to be 8B aligned in order to read from/write to them.
 
-  int A_mram_offset = tasklet_id * rows_per_tasklet * args.row_size;
+  int A_mram_offset = first_row * args.row_size;
   int8_t *A_mram = (int8_t *)(DPU_MRAM_HEAP_POINTER);
   int mram_offset = ROUND_UP(args.row_size * args.rows_per_dpu, 8);
 
@@ -111,14 +108,8 @@ int main() {
   mram_offset += ROUND_UP(args.row_size, 8);
 
   // Should be fine as long as rows_per_tasklet is even
-  int *y_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset + tasklet_id * rows_per_tasklet * sizeof(int));
-
-  // TODO: Find better way to share x across all tasklets, because now we
-  // have multiple copies of the same values across tasklets.
-  // If number of rows to be processed is small enough it should be possible
-  // or we could just make a barrier and wait until all tasklets finish until
-  // getting another part of x
-  int8_t *x_wram = (int8_t *)mem_alloc(BLOCK_SIZE);
+  int *y_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset + first_row * sizeof(int));
+
   // It's important we allocate more memory for A_wram, because of the hack
   // we later to do to write into it from mram (alignment issues).
   // We add 8B in order to be aligned.
@@ -130,11 +121,22 @@ int main() {
   // zero out the results - it's required when we are running the kernel multiple times.
   memset(Ax_wram, 0, Ax_len);
 
+  // Slice of every x block loaded by this tasklet, empty for tasklets past the end of the block
+  uint32_t x_first = tasklet_id * X_SLICE;
+  uint32_t x_length = x_first < BLOCK_SIZE ? BLOCK_SIZE - x_first : 0;
+  x_length = x_length < X_SLICE ? x_length : X_SLICE;
+
   int nr_blocks = (args.row_size - 1) / BLOCK_SIZE + 1;
   for (int b = 0; b < nr_blocks; ++b) {
     int b_offset = b * BLOCK_SIZE;
     int b_length = MIN(BLOCK_SIZE, args.row_size - b_offset);
-    mram_read((__mram_ptr void *)(x_mram + b_offset), x_wram, BLOCK_SIZE);
+    // Buffer of this block was last used for block b - 2, every tasklet is done with it,
+    // because it went through the barrier of block b - 1 after that
+    int8_t *x_wram = x_blocks[b & 1];
+    if (x_length != 0) {
+      mram_read((__mram_ptr void *)(x_mram + b_offset + x_first), x_wram + x_first, x_length);
+    }
+    barrier_wait(&x_barrier);
     for (int i = 0; i < rows_per_tasklet; ++i) {
       // If offset is not aligned to 8B it will be automatically aligned down to 8 bytes
       // This happens when row_size is an odd value.
@@ -142,14 +144,16 @@ int main() {
       int8_t *A_wram_read = A_wram;
       int acc = 0;
       int j = 0;
-      if (A_offset & 7) {
-        mram_read((__mram_ptr void *)(A_mram + ROUND_DOWN(A_offset, 8)), A_wram, BLOCK_SIZE + 8);
+      if (!ALIGNED_ROWS && (A_offset & 7)) {
+        // Single mram_read can't cover the whole block and the extra 8B
+        mram_read((__mram_ptr void *)(A_mram + ROUND_DOWN(A_offset, 8)), A_wram, BLOCK_SIZE);
+        mram_read((__mram_ptr void *)(A_mram + ROUND_DOWN(A_offset, 8) + BLOCK_SIZE), A_wram + BLOCK_SIZE, 8);
         A_wram_read += A_offset & 7;
       } else {
         mram_read((__mram_ptr void *)(A_mram + A_offset), A_wram, BLOCK_SIZE);
 
 #pragma unroll(64)
-        for (; j < ROUND_DOWN(b_length, 512); j += 8) {
+        for (; j < ROUND_DOWN(b_length, 8); j += 8) {
           DOT_8(&A_wram_read[j], &x_wram[j], acc);
         }
       }
@@ -167,6 +171,11 @@ int main() {
     }
   }
 
+  if (rows_per_tasklet == 0) {
+    PERF_STOP();
+    return 0;
+  }
+
   int *y_wram = (int *)mem_alloc(Ax_len);
   mram_read((__mram_ptr void *)y_mram, y_wram, rows_per_tasklet * sizeof(int));
 
@@ -175,5 +184,6 @@ int main() {
   }
 
   mram_write(y_wram, (__mram_ptr void *)y_mram, rows_per_tasklet * sizeof(int));
+  PERF_STOP();
   return 0;
 }
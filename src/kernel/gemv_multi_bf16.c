@@ -0,0 +1,3 @@
+// Multi vector GEMV with bfloat16 A and X, see gemv_multi_half.h
+#define TO_FLOAT bf16_to_float
+#include "gemv_multi_half.h"
@@ -0,0 +1,3 @@
+// Multi vector GEMV with IEEE half precision A and X, see gemv_multi_half.h
+#define TO_FLOAT half_to_float
+#include "gemv_multi_half.h"
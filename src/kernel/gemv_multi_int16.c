@@ -0,0 +1,164 @@
+#include <alloc.h>
+#include <barrier.h>
+#include <built_ins.h>
+#include <defs.h>
+#include <mram.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dpu_idle.h"
+#include "int_mul.h"
+
+/*
+Multi vector GEMV kernel performing Y = alpha * A * X + beta * Y
+A is a matrix of size m x n, int16
+X holds nr_vectors vectors of size n, int16
+Y holds nr_vectors vectors of size m, int
+
+Notes:
+Part of A is transferred to single DPU - rows_per_dpu rows
+Part of every y - rows_per_dpu elements
+
+X is same across all DPU's
+Every block of A is read from MRAM once and multiplied by the matching block of all x vectors,
+same as gemv_multi_int8.c. Products are put together from byte multiplications (see MUL_16).
+
+MRAM layout:
+A - rows_per_dpu * row_size
+X - MAX_VECTORS * row_size, every vector starts 8B aligned
+Y - nr_vectors * rows_per_dpu, placement does not depend on nr_vectors
+
+Computing parameters:
+NR_TASKLETS - number of tasklets (threads) running on single DPU
+rows_per_dpu - number of rows to be processed by single DPU, even
+row_size - maximum size of single matrix row
+nr_vectors - number of x vectors, at most MAX_VECTORS
+*/
+
+// Blocks of all x vectors have to fit in WRAM at the same time - 4 vectors x 256B = 1KB per tasklet.
+// Every tasklet keeps its own blocks, past 16 tasklets they are halved to fit in WRAM
+#if NR_TASKLETS > 16
+#define BLOCK_SIZE 64
+#else
+#define BLOCK_SIZE 128
+#endif
+#define MAX_VECTORS 4
+
+#define MIN(x, y) (((y) < (x)) ? (y) : (x))
+#define ROUND_UP(x, s) (((x) + ((s) - 1)) & ~((s) - 1))
+#define ROUND_DOWN(x, s) ((x) & ~((s) - 1))
+
+struct params {
+  uint32_t rows_per_dpu;
+  uint32_t row_size;
+  uint32_t nr_vectors;
+  int alpha;
+  int beta;
+};
+
+__host struct params args;
+
+BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+
+int main() {
+  if (dpu_idle) {
+    return 0;
+  }
+  int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset();
+  }
+  barrier_wait(&mem_reset_barrier);
+
+  // Sanity checks: rows are handed out in pairs, because rows per tasklet should be even
+  if ((args.rows_per_dpu & 1) || args.nr_vectors == 0 || args.nr_vectors > MAX_VECTORS) {
+    return 1;
+  }
+  // Every tasklet gets the same number of pairs, the first ones take one leftover pair each
+  uint32_t nr_pairs = args.rows_per_dpu / 2;
+  uint32_t leftover_pairs = nr_pairs % NR_TASKLETS;
+  uint32_t first_pair = tasklet_id * (nr_pairs / NR_TASKLETS);
+  first_pair += tasklet_id < leftover_pairs ? tasklet_id : leftover_pairs;
+  uint32_t first_row = 2 * first_pair;
+  int rows_per_tasklet = 2 * (nr_pairs / NR_TASKLETS + (tasklet_id < leftover_pairs ? 1 : 0));
+  if (rows_per_tasklet == 0) {
+    return 0;
+  }
+  int nr_vectors = args.nr_vectors;
+
+  // Offsets below are in bytes, rows of 2B elements start at any even offset
+  uint32_t A_mram_offset = first_row * args.row_size * sizeof(int16_t);
+  uint8_t *A_mram = (uint8_t *)(DPU_MRAM_HEAP_POINTER);
+  uint32_t mram_offset = ROUND_UP(args.row_size * args.rows_per_dpu * sizeof(int16_t), 8);
+
+  // Every x vector starts 8B aligned
+  uint8_t *x_mram = (uint8_t *)(DPU_MRAM_HEAP_POINTER + mram_offset);
+  uint32_t x_stride = ROUND_UP(args.row_size * sizeof(int16_t), 8);
+  mram_offset += MAX_VECTORS * x_stride;
+
+  // first_row is even, so every y part is 8B aligned
+  int *y_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset + first_row * sizeof(int));
+  int y_stride = args.rows_per_dpu;
+
+  int16_t *x_wram = (int16_t *)mem_alloc(MAX_VECTORS * BLOCK_SIZE * sizeof(int16_t));
+  // Unaligned rows are read from the 8B boundary below them, that's up to 3 more elements
+  int16_t *A_wram = (int16_t *)mem_alloc(BLOCK_SIZE * sizeof(int16_t) + 8);
+
+  // Accumulators are stored row after row: Ax_wram[row * nr_vectors + vector]
+  int Ax_len = rows_per_tasklet * nr_vectors * sizeof(int);
+  int *Ax_wram = (int *)mem_alloc(Ax_len);
+  memset(Ax_wram, 0, Ax_len);
+
+  int nr_blocks = (args.row_size - 1) / BLOCK_SIZE + 1;
+  for (int b = 0; b < nr_blocks; ++b) {
+    int b_offset = b * BLOCK_SIZE;
+    int b_length = MIN(BLOCK_SIZE, args.row_size - b_offset);
+    for (int v = 0; v < nr_vectors; ++v) {
+      mram_read((__mram_ptr void *)(x_mram + v * x_stride + b_offset * sizeof(int16_t)), x_wram + v * BLOCK_SIZE,
+                BLOCK_SIZE * sizeof(int16_t));
+    }
+
+    for (int i = 0; i < rows_per_tasklet; ++i) {
+      uint32_t A_offset = A_mram_offset + (i * args.row_size + b_offset) * sizeof(int16_t);
+      int16_t *A_wram_read = A_wram;
+      int aligned = (A_offset & 7) == 0;
+      if (aligned) {
+        mram_read((__mram_ptr void *)(A_mram + A_offset), A_wram, BLOCK_SIZE * sizeof(int16_t));
+      } else {
+        mram_read((__mram_ptr void *)(A_mram + ROUND_DOWN(A_offset, 8)), A_wram, BLOCK_SIZE * sizeof(int16_t) + 8);
+        A_wram_read += (A_offset & 7) / sizeof(int16_t);
+      }
+
+      int *Ax = Ax_wram + i * nr_vectors;
+      for (int v = 0; v < nr_vectors; ++v) {
+        int16_t *x_wram_read = x_wram + v * BLOCK_SIZE;
+        uint32_t ll = 0, mid = 0, hh = 0;
+        int j = 0;
+        if (aligned) {
+#pragma unroll(8)
+          for (; j < ROUND_DOWN(b_length, 4); j += 4) {
+            DOT_4(&A_wram_read[j], &x_wram_read[j], ll, mid, hh);
+          }
+        }
+
+        for (; j < b_length; ++j) {
+          MUL_16(A_wram_read[j], x_wram_read[j], ll, mid, hh);
+        }
+        Ax[v] += COMBINE_16(ll, mid, hh);
+      }
+    }
+  }
+
+  int *y_wram = (int *)mem_alloc(rows_per_tasklet * sizeof(int));
+  for (int v = 0; v < nr_vectors; ++v) {
+    int *y_mram_v = y_mram + v * y_stride;
+    mram_read((__mram_ptr void *)y_mram_v, y_wram, rows_per_tasklet * sizeof(int));
+
+    for (int i = 0; i < rows_per_tasklet; ++i) {
+      y_wram[i] = args.alpha * Ax_wram[i * nr_vectors + v] + args.beta * y_wram[i];
+    }
+
+    mram_write(y_wram, (__mram_ptr void *)y_mram_v, rows_per_tasklet * sizeof(int));
+  }
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include <alloc.h>
+#include <barrier.h>
+#include <defs.h>
+#include <mram.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dpu_idle.h"
+#include "int_mul.h"
+
+/*
+Multi vector GEMV kernel performing Y = alpha * A * X + beta * Y
+A is a matrix of size m x n,
+X holds nr_vectors vectors of size n
+Y holds nr_vectors vectors of size m
+
+Notes:
+Part of A is transferred to single DPU - rows_per_dpu rows
+Part of every y - rows_per_dpu elements
+
+X is same across all DPU's
+Every block of A is read from MRAM once and multiplied by the matching block of all x vectors,
+so GEMM can process nr_vectors columns of B in a single launch.
+
+MRAM layout:
+A - rows_per_dpu * row_size
+X - MAX_VECTORS * row_size, every vector starts 8B aligned
+Y - nr_vectors * rows_per_dpu, placement does not depend on nr_vectors
+
+Computing parameters:
+NR_TASKLETS - number of tasklets (threads) running on single DPU
+rows_per_dpu - number of rows to be processed by single DPU, even
+row_size - maximum size of single matrix row
+nr_vectors - number of x vectors, at most MAX_VECTORS
+*/
+
+// Blocks of all x vectors have to fit in WRAM at the same time,
+// so the block is smaller than in gemv_int32 - 4 vectors x 64 ints = 1KB per tasklet.
+// Every tasklet keeps its own blocks, past 16 tasklets they are halved to fit in WRAM
+#if NR_TASKLETS > 16
+#define BLOCK_SIZE 32
+#else
+#define BLOCK_SIZE 64
+#endif
+#define MAX_VECTORS 4
+
+struct params {
+  uint32_t rows_per_dpu;
+  uint32_t row_size;
+  uint32_t nr_vectors;
+  int alpha;
+  int beta;
+};
+
+__host struct params args;
+
+BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+
+uint32_t alignUpTo8(uint32_t value) { return (value + 7) & ~7; }
+
+uint32_t alignDownTo8(uint32_t value) { return value & ~7; }
+
+uint32_t alignUpTo64(uint32_t value) { return (value + 63) & ~63; }
+
+int main() {
+  if (dpu_idle) {
+    return 0;
+  }
+  int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset();
+  }
+  barrier_wait(&mem_reset_barrier);
+
+  // Sanity checks: rows are handed out in pairs, because rows per tasklet should be even
+  if ((args.rows_per_dpu & 1) || args.nr_vectors == 0 || args.nr_vectors > MAX_VECTORS) {
+    return 1;
+  }
+  // Every tasklet gets the same number of pairs, the first ones take one leftover pair each
+  uint32_t nr_pairs = args.rows_per_dpu / 2;
+  uint32_t leftover_pairs = nr_pairs % NR_TASKLETS;
+  uint32_t first_pair = tasklet_id * (nr_pairs / NR_TASKLETS);
+  first_pair += tasklet_id < leftover_pairs ? tasklet_id : leftover_pairs;
+  uint32_t first_row = 2 * first_pair;
+  int rows_per_tasklet = 2 * (nr_pairs / NR_TASKLETS + (tasklet_id < leftover_pairs ? 1 : 0));
+  if (rows_per_tasklet == 0) {
+    return 0;
+  }
+  uint32_t nr_vectors = args.nr_vectors;
+
+  uint32_t mram_offset_in_bytes = 0;
+
+  int *A_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes + (first_row * args.row_size) * sizeof(int));
+  mram_offset_in_bytes += alignUpTo8(args.row_size * args.rows_per_dpu * sizeof(int));
+
+  // Every x vector starts 8B aligned
+  int *x_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+  uint32_t x_stride = alignUpTo8(args.row_size * sizeof(int)) / sizeof(int);
+  mram_offset_in_bytes += MAX_VECTORS * x_stride * sizeof(int);
+
+  // first_row is even, so every y part is 8B aligned
+  int *y_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes + first_row * sizeof(int));
+  uint32_t y_stride = args.rows_per_dpu;
+
+  int *x_wram = (int *)mem_alloc(MAX_VECTORS * BLOCK_SIZE * sizeof(int));
+  // Extra 64B for reading unaligned rows, same as in gemv_int32
+  int *A_wram = (int *)mem_alloc(BLOCK_SIZE * sizeof(int) + 64);
+
+  // Accumulators are stored row after row: acc_wram[row * nr_vectors + vector]
+  uint32_t acc_size = alignUpTo64(rows_per_tasklet * nr_vectors * sizeof(int));
+  int *acc_wram = (int *)mem_alloc(acc_size);
+  memset(acc_wram, 0, acc_size);
+
+  int nr_blocks = (args.row_size - 1) / BLOCK_SIZE + 1;
+  for (uint32_t block = 0; block < nr_blocks; block++) {
+    const int block_offset = block * BLOCK_SIZE;
+
+    int block_length = block_offset + BLOCK_SIZE <= args.row_size ? BLOCK_SIZE : args.row_size - block_offset;
+    for (uint32_t v = 0; v < nr_vectors; v++) {
+      mram_read((__mram_ptr void *)(x_mram + v * x_stride + block_offset), x_wram + v * BLOCK_SIZE,
+                BLOCK_SIZE * sizeof(int));
+    }
+
+    for (uint32_t i = 0; i < rows_per_tasklet; i++) {
+      uint32_t a_offset = (uint32_t)(A_mram + i * args.row_size + block_offset);
+      int *A_wram_read = NULL;
+      if (a_offset & 7) {
+        mram_read((__mram_ptr void *)(alignDownTo8(a_offset)), A_wram, (BLOCK_SIZE + 2) * sizeof(int));
+        A_wram_read = (A_wram + 1);
+      } else {
+        mram_read((__mram_ptr void *)(a_offset), A_wram, BLOCK_SIZE * sizeof(int));
+        A_wram_read = A_wram;
+      }
+
+      int *acc = acc_wram + i * nr_vectors;
+      for (uint32_t v = 0; v < nr_vectors; v++) {
+        int *x_wram_read = x_wram + v * BLOCK_SIZE;
+        int sum = 0;
+#pragma unroll(16)
+        for (uint32_t j = 0; j < block_length; ++j) {
+          sum += mul32(A_wram_read[j], x_wram_read[j]);
+        }
+        acc[v] += sum;
+      }
+    }
+  }
+
+  uint32_t result_size = alignUpTo64(rows_per_tasklet * sizeof(int));
+  int *result_wram = (int *)mem_alloc(result_size);
+  for (uint32_t v = 0; v < nr_vectors; v++) {
+    int *result_mram = y_mram + v * y_stride;
+    if (args.beta != 0) {
+      mram_read((__mram_ptr void *)(result_mram), result_wram, rows_per_tasklet * sizeof(int));
+      for (uint32_t i = 0; i < rows_per_tasklet; i++) {
+        result_wram[i] = args.alpha * acc_wram[i * nr_vectors + v] + args.beta * result_wram[i];
+      }
+    } else {
+      for (uint32_t i = 0; i < rows_per_tasklet; i++) {
+        result_wram[i] = args.alpha * acc_wram[i * nr_vectors + v];
+      }
+    }
+    mram_write(result_wram, (__mram_ptr void *)result_mram, rows_per_tasklet * sizeof(int));
+  }
+
+  return 0;
+}
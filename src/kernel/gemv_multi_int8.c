@@ -0,0 +1,162 @@
+#include <alloc.h>
+#include <barrier.h>
+#include <built_ins.h>
+#include <defs.h>
+#include <mram.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dpu_idle.h"
+#include "int_mul.h"
+
+/*
+Multi vector GEMV kernel performing Y = alpha * A * X + beta * Y
+A is a matrix of size m x n,
+X holds nr_vectors vectors of size n
+Y holds nr_vectors vectors of size m
+
+Notes:
+Part of A is transferred to single DPU - rows_per_dpu rows
+Part of every y - rows_per_dpu elements
+
+X is same across all DPU's
+Every block of A is read from MRAM once and multiplied by the matching block of all x vectors,
+so GEMM can process nr_vectors columns of B in a single launch.
+
+MRAM layout:
+A - rows_per_dpu * row_size
+X - MAX_VECTORS * row_size, every vector starts 8B aligned
+Y - nr_vectors * rows_per_dpu, placement does not depend on nr_vectors
+
+Computing parameters:
+NR_TASKLETS - number of tasklets (threads) running on single DPU
+rows_per_dpu - number of rows to be processed by single DPU, even
+row_size - maximum size of single matrix row
+nr_vectors - number of x vectors, at most MAX_VECTORS
+*/
+
+// Blocks of all x vectors have to fit in WRAM at the same time - 4 vectors x 256B = 1KB per tasklet.
+// Every tasklet keeps its own blocks, past 16 tasklets they are halved to fit in WRAM
+#if NR_TASKLETS > 16
+#define BLOCK_SIZE 128
+#else
+#define BLOCK_SIZE 256
+#endif
+#define MAX_VECTORS 4
+
+#define MIN(x, y) (((y) < (x)) ? (y) : (x))
+#define ROUND_UP(x, s) (((x) + ((s) - 1)) & ~((s) - 1))
+#define ROUND_DOWN(x, s) ((x) & ~((s) - 1))
+
+struct params {
+  uint32_t rows_per_dpu;
+  uint32_t row_size;
+  uint32_t nr_vectors;
+  int alpha;
+  int beta;
+};
+
+__host struct params args;
+
+BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+
+int main() {
+  if (dpu_idle) {
+    return 0;
+  }
+  int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset();
+  }
+  barrier_wait(&mem_reset_barrier);
+
+  // Sanity checks: rows are handed out in pairs, because rows per tasklet should be even
+  if ((args.rows_per_dpu & 1) || args.nr_vectors == 0 || args.nr_vectors > MAX_VECTORS) {
+    return 1;
+  }
+  // Every tasklet gets the same number of pairs, the first ones take one leftover pair each
+  uint32_t nr_pairs = args.rows_per_dpu / 2;
+  uint32_t leftover_pairs = nr_pairs % NR_TASKLETS;
+  uint32_t first_pair = tasklet_id * (nr_pairs / NR_TASKLETS);
+  first_pair += tasklet_id < leftover_pairs ? tasklet_id : leftover_pairs;
+  uint32_t first_row = 2 * first_pair;
+  int rows_per_tasklet = 2 * (nr_pairs / NR_TASKLETS + (tasklet_id < leftover_pairs ? 1 : 0));
+  if (rows_per_tasklet == 0) {
+    return 0;
+  }
+  int nr_vectors = args.nr_vectors;
+
+  int A_mram_offset = first_row * args.row_size;
+  int8_t *A_mram = (int8_t *)(DPU_MRAM_HEAP_POINTER);
+  int mram_offset = ROUND_UP(args.row_size * args.rows_per_dpu, 8);
+
+  // Every x vector starts 8B aligned
+  int8_t *x_mram = (int8_t *)(DPU_MRAM_HEAP_POINTER + mram_offset);
+  int x_stride = ROUND_UP(args.row_size, 8);
+  mram_offset += MAX_VECTORS * x_stride;
+
+  // first_row is even, so every y part is 8B aligned
+  int *y_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset + first_row * sizeof(int));
+  int y_stride = args.rows_per_dpu;
+
+  int8_t *x_wram = (int8_t *)mem_alloc(MAX_VECTORS * BLOCK_SIZE);
+  // Extra 8B for reading unaligned rows, same as in gemv_int8
+  int8_t *A_wram = (int8_t *)mem_alloc(BLOCK_SIZE + 8);
+
+  // Accumulators are stored row after row: Ax_wram[row * nr_vectors + vector]
+  int Ax_len = rows_per_tasklet * nr_vectors * sizeof(int);
+  int *Ax_wram = (int *)mem_alloc(Ax_len);
+  memset(Ax_wram, 0, Ax_len);
+
+  int nr_blocks = (args.row_size - 1) / BLOCK_SIZE + 1;
+  for (int b = 0; b < nr_blocks; ++b) {
+    int b_offset = b * BLOCK_SIZE;
+    int b_length = MIN(BLOCK_SIZE, args.row_size - b_offset);
+    for (int v = 0; v < nr_vectors; ++v) {
+      mram_read((__mram_ptr void *)(x_mram + v * x_stride + b_offset), x_wram + v * BLOCK_SIZE, BLOCK_SIZE);
+    }
+
+    for (int i = 0; i < rows_per_tasklet; ++i) {
+      int A_offset = A_mram_offset + i * args.row_size + b_offset;
+      int8_t *A_wram_read = A_wram;
+      int aligned = (A_offset & 7) == 0;
+      if (aligned) {
+        mram_read((__mram_ptr void *)(A_mram + A_offset), A_wram, BLOCK_SIZE);
+      } else {
+        mram_read((__mram_ptr void *)(A_mram + ROUND_DOWN(A_offset, 8)), A_wram, BLOCK_SIZE + 8);
+        A_wram_read += A_offset & 7;
+      }
+
+      int *Ax = Ax_wram + i * nr_vectors;
+      for (int v = 0; v < nr_vectors; ++v) {
+        int8_t *x_wram_read = x_wram + v * BLOCK_SIZE;
+        int acc = 0;
+        int j = 0;
+        if (aligned) {
+#pragma unroll(8)
+          for (; j < ROUND_DOWN(b_length, 8); j += 8) {
+            DOT_8(&A_wram_read[j], &x_wram_read[j], acc);
+          }
+        }
+
+        for (; j < b_length; ++j) {
+          acc += A_wram_read[j] * x_wram_read[j];
+        }
+        Ax[v] += acc;
+      }
+    }
+  }
+
+  int *y_wram = (int *)mem_alloc(rows_per_tasklet * sizeof(int));
+  for (int v = 0; v < nr_vectors; ++v) {
+    int *y_mram_v = y_mram + v * y_stride;
+    mram_read((__mram_ptr void *)y_mram_v, y_wram, rows_per_tasklet * sizeof(int));
+
+    for (int i = 0; i < rows_per_tasklet; ++i) {
+      y_wram[i] = args.alpha * Ax_wram[i * nr_vectors + v] + args.beta * y_wram[i];
+    }
+
+    mram_write(y_wram, (__mram_ptr void *)y_mram_v, rows_per_tasklet * sizeof(int));
+  }
+  return 0;
+}
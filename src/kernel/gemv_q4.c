@@ -0,0 +1,205 @@
+#include <alloc.h>
+#include <barrier.h>
+#include <defs.h>
+#include <mram.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dpu_idle.h"
+#include "int_mul.h"
+#include "perf_helper.h"
+#include "share_half.h"
+#include "share_q4.h"
+
+/*
+GEMV kernel with 4-bit grouped quantized A performing y = alpha * x_scale * (A * x) + beta * y
+A is a matrix of size m x n, rows in the layout of share_q4.h
+x is a vector of size n, int8 with x_scale and sums per group (share_q4.h)
+y is a vector of size m, float
+
+Notes:
+Part of A is transferred to single DPU - nr_rows rows
+Part of y - nr_rows elements
+
+x is same across all DPU's
+
+Computing parameters:
+NR_TASKLETS - number of tasklets (threads) running on single DPU
+rows_per_dpu - rows of A and y reserved in MRAM, same on every DPU
+nr_rows - number of rows processed by this DPU, even and at most rows_per_dpu
+row_size - n, weights of a row before padding to whole groups
+group_size - weights sharing a scale (and zero point)
+zero_points - 1 if groups have zero points, Q4_SYMMETRIC_ZERO is used otherwise
+
+Every group is summed in int32 (4-bit weights times int8 x with DOT_8), its zero point is taken off
+with the sum of x over the group and only then the fp16 scale is applied, so float math happens once per group.
+*/
+
+// Half of a block of weights is read per row at once, x blocks are shared by the tasklets
+#define BLOCK_SIZE Q4_BLOCK_WEIGHTS
+#define BLOCK_BYTES (BLOCK_SIZE / 2)
+#define MAX_BLOCK_GROUPS (BLOCK_SIZE / Q4_MIN_GROUP)
+// Part of a shared x block read by a single tasklet, see gemv_int8.c
+#define X_SLICE (((BLOCK_SIZE + NR_TASKLETS - 1) / NR_TASKLETS + 7) & ~7)
+
+#define MIN(x, y) (((y) < (x)) ? (y) : (x))
+#define NIBBLES 0x0F0F0F0F0F0F0F0FUL
+
+struct params {
+  uint32_t rows_per_dpu;
+  uint32_t nr_rows;
+  uint32_t row_size;
+  uint32_t group_size;
+  uint32_t zero_points;
+  float alpha;
+  float beta;
+};
+
+__host struct params args;
+
+// Shared x blocks and their group sums, double buffered as in gemv_int8.c
+__dma_aligned int8_t x_blocks[2][BLOCK_SIZE];
+__dma_aligned int32_t xsum_blocks[2][MAX_BLOCK_GROUPS];
+__dma_aligned float x_scale[2];
+
+BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+BARRIER_INIT(x_barrier, NR_TASKLETS);
+
+int main() {
+  if (dpu_idle) {
+    return 0;
+  }
+  int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset();
+  }
+  barrier_wait(&mem_reset_barrier);
+  PERF_START();
+
+  // Sanity checks: rows are handed out in pairs, group size is a power of two the layout supports
+  if ((args.rows_per_dpu & 1) || (args.nr_rows & 1) || args.nr_rows > args.rows_per_dpu) {
+    return 1;
+  }
+  if (args.group_size < Q4_MIN_GROUP || args.group_size > Q4_MAX_GROUP || (args.group_size & (args.group_size - 1))) {
+    return 1;
+  }
+  // Every tasklet gets the same number of pairs, the first ones take one leftover pair each
+  uint32_t nr_pairs = args.nr_rows / 2;
+  uint32_t leftover_pairs = nr_pairs % NR_TASKLETS;
+  uint32_t first_pair = tasklet_id * (nr_pairs / NR_TASKLETS);
+  first_pair += tasklet_id < leftover_pairs ? tasklet_id : leftover_pairs;
+  uint32_t first_row = 2 * first_pair;
+  // Tasklets without rows still load their slices of x
+  int rows_per_tasklet = 2 * (nr_pairs / NR_TASKLETS + (tasklet_id < leftover_pairs ? 1 : 0));
+
+  uint32_t group_size = args.group_size;
+  uint32_t row_weights = Q4_ROW_WEIGHTS(args.row_size, group_size);
+  uint32_t row_bytes = Q4_ROW_BYTES(args.row_size, group_size, args.zero_points);
+  uint32_t scale_offset = Q4_WEIGHT_BYTES(args.row_size, group_size);
+  uint32_t zero_offset = scale_offset + Q4_SCALE_BYTES(args.row_size, group_size);
+
+  // Note: All MRAM allocations need to be 8B aligned in order to read from/write to them.
+  uint32_t mram_offset_in_bytes = 0;
+  __mram_ptr uint8_t *A_mram = (__mram_ptr uint8_t *)(DPU_MRAM_HEAP_POINTER + first_row * row_bytes);
+  mram_offset_in_bytes += args.rows_per_dpu * row_bytes;
+
+  __mram_ptr int8_t *x_mram = (__mram_ptr int8_t *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+  mram_offset_in_bytes += Q4_X_BYTES(args.row_size, group_size);
+  __mram_ptr int32_t *xsum_mram = (__mram_ptr int32_t *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+  mram_offset_in_bytes += Q4_XSUM_BYTES(args.row_size, group_size);
+  __mram_ptr float *x_scale_mram = (__mram_ptr float *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+  mram_offset_in_bytes += 8;
+
+  __mram_ptr float *y_mram =
+      (__mram_ptr float *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes + first_row * sizeof(float));
+
+  uint64_t *A_wram = (uint64_t *)mem_alloc(BLOCK_BYTES);
+  uint16_t *scales_wram = (uint16_t *)mem_alloc(MAX_BLOCK_GROUPS * sizeof(uint16_t));
+  uint8_t *zeros_wram = (uint8_t *)mem_alloc(MAX_BLOCK_GROUPS);
+
+  // Allocation needs to be aligned to 64B, or we start getting allocations on top of another...
+  uint32_t result_size = (rows_per_tasklet * sizeof(float) + 63) & ~63;
+  float *Ax_wram = (float *)mem_alloc(result_size);
+  memset(Ax_wram, 0, result_size);
+
+  if (tasklet_id == 0) {
+    mram_read((__mram_ptr void *)x_scale_mram, x_scale, sizeof(x_scale));
+  }
+
+  // Slice of every x block loaded by this tasklet, empty for tasklets past the end of the block
+  uint32_t x_first = tasklet_id * X_SLICE;
+  uint32_t x_length = x_first < BLOCK_SIZE ? BLOCK_SIZE - x_first : 0;
+  x_length = MIN(x_length, X_SLICE);
+
+  int nr_blocks = (row_weights - 1) / BLOCK_SIZE + 1;
+  for (int b = 0; b < nr_blocks; ++b) {
+    uint32_t b_offset = b * BLOCK_SIZE;
+    uint32_t b_groups = MIN(BLOCK_SIZE, row_weights - b_offset) / group_size;
+    uint32_t first_group = b_offset / group_size;
+    // Buffer of this block was last used for block b - 2, every tasklet is done with it,
+    // because it went through the barrier of block b - 1 after that
+    int8_t *x_wram = x_blocks[b & 1];
+    int32_t *xsum_wram = xsum_blocks[b & 1];
+    if (x_length != 0) {
+      mram_read((__mram_ptr void *)(x_mram + b_offset + x_first), x_wram + x_first, x_length);
+    }
+    if (tasklet_id == NR_TASKLETS - 1) {
+      mram_read((__mram_ptr void *)(xsum_mram + first_group), xsum_wram, Q4_ALIGN8(b_groups * 4));
+    }
+    barrier_wait(&x_barrier);
+
+    for (int i = 0; i < rows_per_tasklet; ++i) {
+      __mram_ptr uint8_t *row = A_mram + i * row_bytes;
+      // Reads of a short last block run into the scales, those weights are never looked at
+      mram_read((__mram_ptr void *)(row + b_offset / 2), A_wram, BLOCK_BYTES);
+      mram_read((__mram_ptr void *)(row + scale_offset + first_group * 2), scales_wram, Q4_ALIGN8(b_groups * 2));
+      if (args.zero_points) {
+        mram_read((__mram_ptr void *)(row + zero_offset + first_group), zeros_wram, Q4_ALIGN8(b_groups));
+      }
+
+      uint64_t *w = A_wram;
+      int8_t *x = x_wram;
+      float sum = 0;
+      for (uint32_t g = 0; g < b_groups; g++) {
+        int acc = 0;
+        for (uint32_t k = 0; k < group_size / 16; k++) {
+          uint64_t word = *w++;
+          uint64_t low = word & NIBBLES;
+          uint64_t high = (word >> 4) & NIBBLES;
+          DOT_8_VALUE(low, x, acc);
+          DOT_8_VALUE(high, x + 8, acc);
+          x += 16;
+        }
+        int zero = args.zero_points ? zeros_wram[g] : Q4_SYMMETRIC_ZERO;
+        acc -= zero * xsum_wram[g];
+        if (acc != 0) {
+          sum += half_to_float(scales_wram[g]) * (float)acc;
+        }
+      }
+      Ax_wram[i] += sum;
+    }
+  }
+
+  if (rows_per_tasklet == 0) {
+    PERF_STOP();
+    return 0;
+  }
+
+  float *y_wram = (float *)mem_alloc(result_size);
+  mram_read((__mram_ptr void *)y_mram, y_wram, rows_per_tasklet * sizeof(float));
+
+  float alpha = args.alpha * x_scale[0];
+  if (args.beta != 0.0f) {
+    for (int i = 0; i < rows_per_tasklet; ++i) {
+      y_wram[i] = alpha * Ax_wram[i] + args.beta * y_wram[i];
+    }
+  } else {
+    for (int i = 0; i < rows_per_tasklet; ++i) {
+      y_wram[i] = alpha * Ax_wram[i];
+    }
+  }
+
+  mram_write(y_wram, (__mram_ptr void *)y_mram, rows_per_tasklet * sizeof(float));
+  PERF_STOP();
+  return 0;
+}
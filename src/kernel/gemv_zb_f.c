@@ -0,0 +1,145 @@
+#include <alloc.h>
+#include <barrier.h>
+#include <defs.h>
+#include <mram.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dpu_idle.h"
+#include "zero_blocks.h"
+
+/*
+GEMV kernel on zero word compressed A performing y = alpha * A * x + beta * y
+A is a matrix of size m x n,
+x is a vector of size n
+y is a vector of size m
+
+Notes:
+Same split of rows as gemv_f, but A region holds the compressed rows of the DPU (see share_zero_blocks.h).
+Blocks are decoded into WRAM as rows are streamed, blocks with no non zero words are skipped.
+Rows are padded to 8B, so every block is aligned.
+
+Computing parameters:
+NR_TASKLETS - number of tasklets (threads) running on single DPU
+rows_per_dpu - rows of A table and y reserved in MRAM, same on every DPU
+nr_rows - number of rows processed by this DPU, even and at most rows_per_dpu
+row_size - size of single matrix row
+
+*/
+
+// Decoded block has the size of a compressed block
+#define BLOCK_SIZE (ZB_BLOCK_BYTES / sizeof(float))
+
+struct params {
+  uint32_t rows_per_dpu;
+  uint32_t nr_rows;
+  uint32_t row_size;
+  float alpha;
+  float beta;
+};
+
+__host struct params args;
+
+BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+
+uint32_t alignUpTo8(uint32_t value) { return (value + 7) & ~7; }
+
+uint32_t alignUpTo64(uint32_t value) { return (value + 63) & ~63; }
+
+uint32_t alignUpTo2(uint32_t value) { return (value + 1) & ~1; }
+
+int main() {
+  if (dpu_idle) {
+    return 0;
+  }
+  int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset();
+  }
+  barrier_wait(&mem_reset_barrier);
+
+  // Sanity checks: rows are handed out in pairs, because rows per tasklet should be even
+  if ((args.rows_per_dpu & 1) || (args.nr_rows & 1) || args.nr_rows > args.rows_per_dpu) {
+    return 1;
+  }
+  // Every tasklet gets the same number of pairs, the first ones take one leftover pair each
+  uint32_t nr_pairs = args.nr_rows / 2;
+  uint32_t leftover_pairs = nr_pairs % NR_TASKLETS;
+  uint32_t first_pair = tasklet_id * (nr_pairs / NR_TASKLETS);
+  first_pair += tasklet_id < leftover_pairs ? tasklet_id : leftover_pairs;
+  uint32_t first_row = 2 * first_pair;
+  int rows_per_tasklet = 2 * (nr_pairs / NR_TASKLETS + (tasklet_id < leftover_pairs ? 1 : 0));
+  if (rows_per_tasklet == 0) {
+    return 0;
+  }
+
+  // Note: All MRAM allocations need to be 8B aligned in order to read from/write to them.
+
+  uint8_t *A_mram = (uint8_t *)(DPU_MRAM_HEAP_POINTER);
+  uint32_t mram_offset_in_bytes = ZB_REGION_BOUND(args.rows_per_dpu, args.row_size * sizeof(float));
+
+  float *x_mram = (float *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes);
+  mram_offset_in_bytes += alignUpTo8(args.row_size * sizeof(float));
+
+  // Should be fine as long as rows_per_tasklet is even
+  float *result_mram = (float *)(DPU_MRAM_HEAP_POINTER + mram_offset_in_bytes + first_row * sizeof(float));
+
+  float *x_wram = (float *)mem_alloc(BLOCK_SIZE * sizeof(float));
+  float *A_wram = (float *)mem_alloc(BLOCK_SIZE * sizeof(float));
+  uint32_t *masks = (uint32_t *)mem_alloc(ZB_HEADER_BYTES);
+
+  // Offsets of compressed rows, advanced block by block
+  uint32_t *row_offsets = (uint32_t *)mem_alloc(rows_per_tasklet * sizeof(uint32_t));
+  mram_read((__mram_ptr void *)(A_mram + first_row * sizeof(uint32_t)), row_offsets,
+            rows_per_tasklet * sizeof(uint32_t));
+
+  // Allocation needs to be aligned to 64B, or we start getting
+  // allocations on top of another...
+  uint32_t result_size = alignUpTo64(rows_per_tasklet * sizeof(float));
+  float *mul_result_wram = (float *)mem_alloc(result_size);
+
+  // zero out the results - it's required when we are running the kernel multiple times.
+  memset(mul_result_wram, 0, result_size);
+
+  int nr_blocks = (args.row_size - 1) / BLOCK_SIZE + 1;
+  for (uint32_t block = 0; block < nr_blocks; block++) {
+    const int block_offset = block * BLOCK_SIZE;
+
+    int block_length = block_offset + BLOCK_SIZE <= args.row_size ? BLOCK_SIZE : args.row_size - block_offset;
+    mram_read((__mram_ptr void *)(x_mram + block_offset), x_wram, BLOCK_SIZE * sizeof(float));
+    for (uint32_t i = 0; i < rows_per_tasklet; i++) {
+      uint32_t nr_words;
+      row_offsets[i] += zb_decode_block(A_mram + row_offsets[i], (uint64_t *)A_wram, masks, &nr_words);
+      if (nr_words == 0) {
+        continue;
+      }
+
+      // x past the end of the row isn't initialized, so it's not multiplied even by zeros
+      float sum = 0;
+      for (uint32_t j = 0; j < block_length; ++j) {
+        sum += A_wram[j] * x_wram[j];
+      }
+
+      mul_result_wram[i] += sum;
+    }
+  }
+
+  float *result_wram = (float *)mem_alloc(result_size);
+  mram_read((__mram_ptr void *)(result_mram), result_wram, rows_per_tasklet * sizeof(float));
+
+  if (args.beta != 0.0f) {
+    for (uint32_t i = 0; i < rows_per_tasklet; i++) {
+      // y = alpha * Ax + beta * y
+      result_wram[i] = args.alpha * mul_result_wram[i] + args.beta * result_wram[i];
+    }
+  } else {
+    for (uint32_t i = 0; i < rows_per_tasklet; i++) {
+      // y = alpha * Ax
+      result_wram[i] = args.alpha * mul_result_wram[i];
+    }
+  }
+
+  mram_write(result_wram, (__mram_ptr void *)result_mram, rows_per_tasklet * sizeof(float));
+
+  return 0;
+}
\ No newline at end of file
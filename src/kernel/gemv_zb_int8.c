@@ -0,0 +1,132 @@
+#include <alloc.h>
+#include <barrier.h>
+#include <built_ins.h>
+#include <defs.h>
+#include <mram.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dpu_idle.h"
+#include "int_mul.h"
+#include "zero_blocks.h"
+
+/*
+GEMV kernel on zero word compressed A performing y = alpha * A * x + beta * y
+A is a matrix of size m x n,
+x is a vector of size n
+y is a vector of size m
+
+Notes:
+Same split of rows as gemv_int8, but A region holds the compressed rows of the DPU (see share_zero_blocks.h).
+Blocks are decoded into WRAM as rows are streamed, blocks with no non zero words are skipped.
+Rows are padded to 8B, so every block is aligned and its tail is zero.
+
+Computing parameters:
+NR_TASKLETS - number of tasklets (threads) running on single DPU
+rows_per_dpu - rows of A table and y reserved in MRAM, same on every DPU
+nr_rows - number of rows processed by this DPU, even and at most rows_per_dpu
+row_size - size of single matrix row
+
+*/
+
+#define BLOCK_SIZE ZB_BLOCK_BYTES
+
+#define MIN(x, y) (((y) < (x)) ? (y) : (x))
+#define ROUND_UP(x, s) (((x) + ((s) - 1)) & ~((s) - 1))
+
+struct params {
+  uint32_t rows_per_dpu;
+  uint32_t nr_rows;
+  uint32_t row_size;
+  int alpha;
+  int beta;
+};
+
+__host struct params args;
+
+BARRIER_INIT(mem_reset_barrier, NR_TASKLETS);
+
+int main() {
+  if (dpu_idle) {
+    return 0;
+  }
+  int tasklet_id = me();
+  if (tasklet_id == 0) {
+    mem_reset();
+  }
+  barrier_wait(&mem_reset_barrier);
+
+  // Sanity checks: rows are handed out in pairs, because rows per tasklet should be even
+  if ((args.rows_per_dpu & 1) || (args.nr_rows & 1) || args.nr_rows > args.rows_per_dpu) {
+    return 1;
+  }
+  // Every tasklet gets the same number of pairs, the first ones take one leftover pair each
+  uint32_t nr_pairs = args.nr_rows / 2;
+  uint32_t leftover_pairs = nr_pairs % NR_TASKLETS;
+  uint32_t first_pair = tasklet_id * (nr_pairs / NR_TASKLETS);
+  first_pair += tasklet_id < leftover_pairs ? tasklet_id : leftover_pairs;
+  uint32_t first_row = 2 * first_pair;
+  int rows_per_tasklet = 2 * (nr_pairs / NR_TASKLETS + (tasklet_id < leftover_pairs ? 1 : 0));
+  if (rows_per_tasklet == 0) {
+    return 0;
+  }
+
+  // Note: All MRAM allocations need to be 8B aligned in order to read from/write to them.
+
+  uint8_t *A_mram = (uint8_t *)(DPU_MRAM_HEAP_POINTER);
+  int mram_offset = ZB_REGION_BOUND(args.rows_per_dpu, args.row_size);
+
+  int8_t *x_mram = (int8_t *)(DPU_MRAM_HEAP_POINTER + mram_offset);
+  mram_offset += ROUND_UP(args.row_size, 8);
+
+  // Should be fine as long as rows_per_tasklet is even
+  int *y_mram = (int *)(DPU_MRAM_HEAP_POINTER + mram_offset + first_row * sizeof(int));
+
+  int8_t *x_wram = (int8_t *)mem_alloc(BLOCK_SIZE);
+  int8_t *A_wram = (int8_t *)mem_alloc(BLOCK_SIZE);
+  uint32_t *masks = (uint32_t *)mem_alloc(ZB_HEADER_BYTES);
+
+  // Offsets of compressed rows, advanced block by block
+  uint32_t *row_offsets = (uint32_t *)mem_alloc(rows_per_tasklet * sizeof(uint32_t));
+  mram_read((__mram_ptr void *)(A_mram + first_row * sizeof(uint32_t)), row_offsets,
+            rows_per_tasklet * sizeof(uint32_t));
+
+  int Ax_len = rows_per_tasklet * sizeof(int);
+  int *Ax_wram = (int *)mem_alloc(Ax_len);
+
+  // zero out the results - it's required when we are running the kernel multiple times.
+  memset(Ax_wram, 0, Ax_len);
+
+  int nr_blocks = (args.row_size - 1) / BLOCK_SIZE + 1;
+  for (int b = 0; b < nr_blocks; ++b) {
+    int b_offset = b * BLOCK_SIZE;
+    int b_length = MIN(BLOCK_SIZE, args.row_size - b_offset);
+    mram_read((__mram_ptr void *)(x_mram + b_offset), x_wram, BLOCK_SIZE);
+    for (int i = 0; i < rows_per_tasklet; ++i) {
+      uint32_t nr_words;
+      row_offsets[i] += zb_decode_block(A_mram + row_offsets[i], (uint64_t *)A_wram, masks, &nr_words);
+      if (nr_words == 0) {
+        continue;
+      }
+
+      // Padding of the row is zero, so the last words can be multiplied as a whole
+      int acc = 0;
+#pragma unroll(64)
+      for (int j = 0; j < ROUND_UP(b_length, 8); j += 8) {
+        DOT_8(&A_wram[j], &x_wram[j], acc);
+      }
+
+      Ax_wram[i] += acc;
+    }
+  }
+
+  int *y_wram = (int *)mem_alloc(Ax_len);
+  mram_read((__mram_ptr void *)y_mram, y_wram, rows_per_tasklet * sizeof(int));
+
+  for (int i = 0; i < rows_per_tasklet; ++i) {
+    y_wram[i] = args.alpha * Ax_wram[i] + args.beta * y_wram[i];
+  }
+
+  mram_write(y_wram, (__mram_ptr void *)y_mram, rows_per_tasklet * sizeof(int));
+  return 0;
+}
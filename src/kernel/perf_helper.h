@@ -1,5 +1,12 @@
+#pragma once
+
 #include <barrier.h>
 #include <defs.h>
+
+// Per tasklet cycle and instruction counters. Kernels built with -DPERF_COUNTERS (KERNEL_PERF_COUNTERS=ON)
+// store them into nb_cycles and nb_instructions, otherwise PERF_START and PERF_STOP compile to nothing.
+// PERF_START has a barrier, so every tasklet has to call it.
+#ifdef PERF_COUNTERS
 #include <perfcounter.h>
 
 __host uint32_t nb_cycles[NR_TASKLETS];
@@ -17,4 +24,11 @@ void perfcount_stop() {
   perfcounter_pair_t counters = perfcounter_get_both(false);
   nb_cycles[me()] = counters.cycles;
   nb_instructions[me()] = counters.instr;
-}
\ No newline at end of file
+}
+
+#define PERF_START() perfcount_start()
+#define PERF_STOP() perfcount_stop()
+#else
+#define PERF_START()
+#define PERF_STOP()
+#endif
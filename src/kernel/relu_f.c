@@ -2,6 +2,8 @@
 #include <mram.h>
 #include <stdio.h>
 
+#include "dpu_idle.h"
+
 #define BUFFER_SIZE 512
 // 32MB of MRAM allocation
 #define MRAM_ALLOCATION (1024 * 1024 * 8)
@@ -9,6 +11,9 @@ __mram_noinit float buffer[MRAM_ALLOCATION];
 __mram_noinit int32_t params[4];
 
 int main() {
+  if (dpu_idle) {
+    return 0;
+  }
   __dma_aligned float local_cache[BUFFER_SIZE];
   int tasklet_id = me();
   if (tasklet_id > 0) {
@@ -3,6 +3,8 @@
 #include <mram.h>
 #include <stdio.h>
 
+#include "dpu_idle.h"
+
 #define FLT_MIN 1.175494351e-38F
 
 #define LOCAL_BUFFER_SIZE 512
@@ -122,6 +124,9 @@ void f_divide(int tasklet_id, float *vec_mram, int elems_per_tasklet) {
 }
 
 int main() {
+  if (dpu_idle) {
+    return 0;
+  }
   int tasklet_id = me();
 
   int elems_per_tasklet = alignUpTo2((vec_size - 1) / NR_TASKLETS + 1);
@@ -1,6 +1,7 @@
 #include <stdlib.h>
 
 #include "common_kernel.h"
+#include "dpu_idle.h"
 #include "share_vector_add.h"
 __host dpu_arguments_t DPU_INPUT_ARGUMENTS;
 
@@ -10,7 +11,12 @@ extern int vec_add_kernel(void);
 
 int (*kernels[total_kernels])(void) = {vec_add_kernel};
 
-int main(void) { return kernels[DPU_INPUT_ARGUMENTS.kernel](); }
+int main(void) {
+  if (dpu_idle) {
+    return 0;
+  }
+  return kernels[DPU_INPUT_ARGUMENTS.kernel]();
+}
 
 int hasAlignedTo8(unsigned int v) { return v % 8 == 0; }
 
@@ -2,6 +2,8 @@
 #include <mram.h>
 #include <stdio.h>
 
+#include "dpu_idle.h"
+
 #define BUFFER_SIZE 512
 // 2x 16MB allocation
 #define MRAM_ALLOCATION (1024 * 1024 * 4)
@@ -17,6 +19,9 @@ __mram_noinit int32_t params[4];
 #define VEC_SUB 3
 
 int main() {
+  if (dpu_idle) {
+    return 0;
+  }
   __dma_aligned float local_cache_a[BUFFER_SIZE];
   __dma_aligned float local_cache_b[BUFFER_SIZE];
   int tasklet_id = me();
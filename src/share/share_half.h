@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// IEEE half precision and bfloat16 conversions shared by the host and DPU kernels (no FPU needed, only integer ops).
+
+static inline float half_to_float(uint16_t h) {
+  uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+  uint32_t exp = (h >> 10) & 0x1f;
+  uint32_t mant = h & 0x3ff;
+  uint32_t bits;
+  if (exp == 0) {
+    if (mant == 0) {
+      bits = sign;
+    } else {
+      // Subnormal, normalize the mantissa
+      exp = 127 - 15 + 1;
+      while ((mant & 0x400) == 0) {
+        mant <<= 1;
+        exp--;
+      }
+      bits = sign | (exp << 23) | ((mant & 0x3ff) << 13);
+    }
+  } else if (exp == 0x1f) {
+    bits = sign | 0x7f800000 | (mant << 13);
+  } else {
+    bits = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+  }
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+// Rounds to nearest even, too big values go to infinity
+static inline uint16_t float_to_half(float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  uint16_t sign = (bits >> 16) & 0x8000;
+  uint32_t abs = bits & 0x7fffffff;
+  if (abs > 0x7f800000) {
+    return sign | 0x7e00;
+  }
+  if (abs >= 0x47800000) {
+    return sign | 0x7c00;
+  }
+  if (abs < 0x33000000) {
+    return sign;
+  }
+
+  uint32_t h;
+  uint32_t rem;
+  uint32_t halfway;
+  if (abs < 0x38800000) {
+    // Subnormal half, mantissa with the implicit bit shifted into place
+    uint32_t shift = 126 - (abs >> 23);
+    uint32_t mant = (abs & 0x7fffff) | 0x800000;
+    h = mant >> shift;
+    rem = mant & ((1u << shift) - 1);
+    halfway = 1u << (shift - 1);
+  } else {
+    // Rebias the exponent, a carry out of the mantissa moves into it
+    h = (abs - 0x38000000) >> 13;
+    rem = abs & 0x1fff;
+    halfway = 0x1000;
+  }
+  if (rem > halfway || (rem == halfway && (h & 1))) {
+    h++;
+  }
+  return sign | h;
+}
+
+// bfloat16 is the upper half of a float
+static inline float bf16_to_float(uint16_t h) {
+  uint32_t bits = (uint32_t)h << 16;
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+// Rounds to nearest even, NaN stays NaN
+static inline uint16_t float_to_bf16(float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  if ((bits & 0x7fffffff) > 0x7f800000) {
+    return (bits >> 16) | 0x40;
+  }
+  bits += 0x7fff + ((bits >> 16) & 1);
+  return bits >> 16;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+// 4-bit grouped quantization of matrix rows, shared by the host packer and the gemv_q4 kernel.
+//
+// A row of n weights is padded to whole groups of group_size weights (a power of two from Q4_MIN_GROUP
+// to Q4_MAX_GROUP). Weight i of group g is scale_g * (q_i - zero_g), q_i is an unsigned 4-bit value.
+// A row is stored as:
+//  - weights, every 8B word holds 16 of them, weight j < 8 in the low nibble of byte j, weight j + 8 in the high one
+//  - fp16 scales of the groups, padded to 8B
+//  - with zero points, a byte per group, padded to 8B. Without them zero_g is Q4_SYMMETRIC_ZERO.
+// Padding weights are zero_g, so they are exactly 0.
+//
+// x is int8 with a single float scale. Its region holds x padded to whole groups, 32 bit sums of x per group
+// (zero points are applied once per group with them) and x_scale in an 8B slot.
+
+#define Q4_MIN_GROUP 16
+#define Q4_MAX_GROUP 256
+#define Q4_SYMMETRIC_ZERO 8
+// Weights per block the kernel streams, a multiple of every group size
+#define Q4_BLOCK_WEIGHTS 2048
+
+#define Q4_ALIGN8(x) (((x) + 7) & ~7)
+#define Q4_ROW_WEIGHTS(n, group) (((n) + (group) - 1) / (group) * (group))
+#define Q4_NR_GROUPS(n, group) (((n) + (group) - 1) / (group))
+#define Q4_WEIGHT_BYTES(n, group) (Q4_ROW_WEIGHTS(n, group) / 2)
+#define Q4_SCALE_BYTES(n, group) Q4_ALIGN8(Q4_NR_GROUPS(n, group) * 2)
+#define Q4_ZERO_BYTES(n, group) Q4_ALIGN8(Q4_NR_GROUPS(n, group))
+#define Q4_ROW_BYTES(n, group, zero_points) \
+  (Q4_WEIGHT_BYTES(n, group) + Q4_SCALE_BYTES(n, group) + ((zero_points) ? Q4_ZERO_BYTES(n, group) : 0))
+
+#define Q4_X_BYTES(n, group) Q4_ALIGN8(Q4_ROW_WEIGHTS(n, group))
+#define Q4_XSUM_BYTES(n, group) Q4_ALIGN8(Q4_NR_GROUPS(n, group) * 4)
+#define Q4_X_REGION_BYTES(n, group) (Q4_X_BYTES(n, group) + Q4_XSUM_BYTES(n, group) + 8)
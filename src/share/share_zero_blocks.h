@@ -0,0 +1,22 @@
+#pragma once
+
+// Zero word compression of matrix rows, shared by the host packer and DPU kernels.
+//
+// Every row is padded with zeros to 8B and cut into blocks of ZB_BLOCK_BYTES. A block is stored as
+// ZB_MASK_WORDS 32 bit masks (bit i of mask j set when 8B word 32 * j + i is not zero) followed by
+// the non zero words in order. Words past the end of the row are zero, so they are never stored.
+//
+// A region of a DPU starts with a table of rows_per_dpu 32 bit offsets (relative to the region)
+// of the compressed rows, rows follow the table. Region size is bounded by ZB_REGION_BOUND, so the
+// MRAM layout after A is known before the data is compressed.
+
+#define ZB_BLOCK_BYTES 1024
+#define ZB_BLOCK_WORDS (ZB_BLOCK_BYTES / 8)
+#define ZB_MASK_WORDS (ZB_BLOCK_WORDS / 32)
+#define ZB_HEADER_BYTES (ZB_MASK_WORDS * 4)
+
+#define ZB_ALIGN8(x) (((x) + 7) & ~7)
+#define ZB_NR_BLOCKS(row_bytes) (((row_bytes) + ZB_BLOCK_BYTES - 1) / ZB_BLOCK_BYTES)
+#define ZB_TABLE_BYTES(rows) ZB_ALIGN8((rows) * 4)
+#define ZB_ROW_BOUND(row_bytes) (ZB_NR_BLOCKS(row_bytes) * ZB_HEADER_BYTES + ZB_ALIGN8(row_bytes))
+#define ZB_REGION_BOUND(rows, row_bytes) (ZB_TABLE_BYTES(rows) + (rows) * ZB_ROW_BOUND(row_bytes))
@@ -0,0 +1,60 @@
+#include "common.hpp"
+#include "dpu_pool.hpp"
+#include "test_helper.hpp"
+
+int host_gemv_int8(uint32_t m, uint32_t n, const int8_t *mat, const int8_t *vec, int *y) {
+  for (size_t row = 0; row < m; ++row) {
+    int mul_res = 0;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += static_cast<int>(vec[col]) * static_cast<int>(mat[row * n + col]);
+    }
+    y[row] = mul_res;
+  }
+
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  auto &pool = DPUPool::instance();
+  if (false == pool.enabled() && false == pool.reserve(2)) {
+    std::cout << "Couldn't reserve ranks\n";
+    RET_TEST_FAIL;
+  }
+
+  uint32_t nr_free = pool.get_nr_free_dpus();
+
+  // Second run reuses the leased ranks, the small shape leaves most DPUs of the lease spare
+  // with args of the first run, the last run uses them again
+  const uint32_t shapes[][2] = {{1331, 1427}, {1331, 1427}, {20, 1427}, {1331, 1427}};
+  int alpha = 1;
+  int beta = 0;
+
+  for (int run = 0; run < 4; run++) {
+    const uint32_t M = shapes[run][0];
+    const uint32_t N = shapes[run][1];
+    auto mat =
+        generateRandomIntegral<int8_t>(M * N, std::numeric_limits<int8_t>::min(), std::numeric_limits<int8_t>::max());
+    auto vec =
+        generateRandomIntegral<int8_t>(N, std::numeric_limits<int8_t>::min(), std::numeric_limits<int8_t>::max());
+    auto y_host = pimblas::vector<int>(M);
+    host_gemv_int8(M, N, mat.data(), vec.data(), y_host.data());
+
+    auto y = generate(M);
+    if (gemv_int8(M, N, mat.data(), vec.data(), y.data(), &alpha, &beta) != 0) {
+      RET_TEST_FAIL;
+    }
+
+    if (false == same_vectors(y, y_host)) {
+      std::cout << "fail run " << run << "\n";
+      RET_TEST_FAIL;
+    }
+
+    if (pool.get_nr_free_dpus() != nr_free) {
+      std::cout << "Lease wasn't returned to the pool\n";
+      RET_TEST_FAIL;
+    }
+  }
+
+  std::cout << "SUCCESS " << std::endl;
+  RET_TEST_OK;
+}
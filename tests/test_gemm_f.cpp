@@ -59,6 +59,41 @@ bool test_sgemm_wrapper() {
   return mostly_same_rel(C.data(), C_host.data(), M * N, 1e-4f);
 }
 
+// Sub-views of bigger matrices, every operand has a leading dimension larger than its rows
+bool test_sgemm_wrapper_padded(char transa, char transb) {
+  const int M = 301;
+  const int N = 37;
+  const int K = 130;
+  bool ta = (transa == 't');
+  bool tb = (transb == 't');
+  const int lda = (ta ? K : M) + 6;
+  const int ldb = (tb ? N : K) + 3;
+  const int ldc = M + 5;
+  auto A = generateRandomFloats(lda * (ta ? M : K), 1.0f, 10.0f);
+  auto B = generateRandomFloats(ldb * (tb ? K : N), 1.0f, 10.0f);
+  auto C = generateRandomFloats(ldc * N, 1.0f, 10.0f);
+  auto C_host = pimblas::vector<float>(C.begin(), C.end());
+  float alpha = 1.5f;
+  float beta = 0.5f;
+
+  sgemm_wrapper(&transa, &transb, &M, &N, &K, &alpha, A.data(), &lda, B.data(), &ldb, &beta, C.data(), &ldc);
+
+  for (size_t col = 0; col < N; col++) {
+    for (size_t row = 0; row < M; row++) {
+      float sum = 0.0f;
+      for (size_t i = 0; i < K; i++) {
+        float a = ta ? A[i + row * lda] : A[row + i * lda];
+        float b = tb ? B[col + i * ldb] : B[i + col * ldb];
+        sum += a * b;
+      }
+      C_host[row + col * ldc] = alpha * sum + beta * C_host[row + col * ldc];
+    }
+  }
+
+  // Padding between columns of C must stay untouched
+  return mostly_same_rel(C.data(), C_host.data(), ldc * N, 1e-4f);
+}
+
 bool test_gemm_row_maj_f() {
   const int M = 1111;
   const int N = 143;
@@ -79,13 +114,41 @@ bool test_gemm_row_maj_f() {
   return true;
 }
 
+// Square-ish shape, goes through the tiled GEMM kernel
+bool test_gemm_row_maj_f_tiled() {
+  const int M = 517;
+  const int N = 389;
+  const int K = 211;
+  auto A = generateRandomFloats(M * K, 1.0f, 10.0f);
+  auto B = generateRandomFloats(K * N, 1.0f, 10.0f);
+  auto C = generateRandomFloats(M * N, 1.0f, 10.0f);
+  auto C_host = pimblas::vector<float>(C.begin(), C.end());
+  float alpha = 1.5f;
+  float beta = 0.5f;
+
+  gemm_row_maj_f(&M, &N, &K, &alpha, A.data(), B.data(), &beta, C.data());
+  host_sgemm_row_major(A.data(), B.data(), C_host.data(), alpha, beta, M, N, K);
+
+  return mostly_same_rel(C.data(), C_host.data(), M * N, 1e-4f);
+}
+
 int main(int argc, char **argv) {
   if (false == test_sgemm_wrapper()) {
     RET_TEST_FAIL;
   }
+  for (char transa : {'n', 't'}) {
+    for (char transb : {'n', 't'}) {
+      if (false == test_sgemm_wrapper_padded(transa, transb)) {
+        RET_TEST_FAIL;
+      }
+    }
+  }
   if (false == test_gemm_row_maj_f()) {
     RET_TEST_FAIL;
   }
+  if (false == test_gemm_row_maj_f_tiled()) {
+    RET_TEST_FAIL;
+  }
 
   std::cout << "SUCCESS" << std::endl;
   RET_TEST_OK;
@@ -0,0 +1,47 @@
+#include "common.hpp"
+#include "test_helper.hpp"
+
+int host_gemm_row_major_int16(const int16_t *A, const int16_t *B, int *C, int alpha, int beta, uint32_t M, uint32_t N,
+                              uint32_t K) {
+  for (size_t row = 0; row < M; row++) {
+    for (size_t col = 0; col < N; col++) {
+      int sum = 0;
+      for (size_t i = 0; i < K; i++) {
+        sum += static_cast<int>(A[row * K + i]) * static_cast<int>(B[i * N + col]);
+      }
+      C[row * N + col] = alpha * sum + beta * C[row * N + col];
+    }
+  }
+  return 0;
+}
+
+bool test_gemm_row_maj_int16(int M, int N, int K, int alpha, int beta) {
+  auto A = generateRandomIntegral<int16_t>(M * K, -1000, 1000);
+  auto B = generateRandomIntegral<int16_t>(K * N, -1000, 1000);
+  auto C = generateRandomIntegral<int32_t>(M * N, -1000, 1000);
+  auto C_host = pimblas::vector<int32_t>(C.begin(), C.end());
+
+  gemm_row_maj_int16(&M, &N, &K, &alpha, A.data(), B.data(), &beta, C.data());
+  host_gemm_row_major_int16(A.data(), B.data(), C_host.data(), alpha, beta, M, N, K);
+
+  if (false == same(C.data(), C_host.data(), C.size())) {
+    std::cout << "FAIL\n";
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  // Thin C, goes through the multi-vector int16 GEMV path
+  if (false == test_gemm_row_maj_int16(1341, 101, 1473, 2, 0)) {
+    RET_TEST_FAIL;
+  }
+
+  // Square-ish shape and odd k, goes through the tiled GEMM kernel with unaligned rows
+  if (false == test_gemm_row_maj_int16(517, 389, 211, 2, 3)) {
+    RET_TEST_FAIL;
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}
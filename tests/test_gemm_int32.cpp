@@ -50,6 +50,11 @@ int main(int argc, char **argv) {
     RET_TEST_FAIL;
   }
 
+  // Square-ish shape, goes through the tiled GEMM kernel
+  if (false == test_gemm_row_maj_int32(517, 389, 211, alpha, 3)) {
+    RET_TEST_FAIL;
+  }
+
   std::cout << "SUCCESS" << std::endl;
   RET_TEST_OK;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <chrono>
 
 #include "common.hpp"
+#include "gemm_kernel.hpp"
 #include "test_helper.hpp"
 
 int host_gemm_row_major_int8(const int8_t *A, const int8_t *B, int *C, int alpha, int beta, uint32_t M, uint32_t N,
@@ -50,6 +51,20 @@ int main(int argc, char **argv) {
     RET_TEST_FAIL;
   }
 
+  // Square-ish shape, goes through the tiled GEMM kernel
+  if (false == test_gemm_row_maj_int8(517, 389, 211, alpha, 3)) {
+    RET_TEST_FAIL;
+  }
+
+  // Long rows of A and B cost more to replicate than a smaller grid costs in work, not every DPU pays off
+  uint32_t rows_per_dpu = 0;
+  uint32_t cols_per_dpu = 0;
+  if (false == GEMM_INT8_Kernel::partition(64, 64, 65536, 512, 3, rows_per_dpu, cols_per_dpu) ||
+      (64 / rows_per_dpu) * (64 / cols_per_dpu) >= 512) {
+    std::cout << "FAIL partition " << rows_per_dpu << "x" << cols_per_dpu << std::endl;
+    RET_TEST_FAIL;
+  }
+
   std::cout << "SUCCESS" << std::endl;
   RET_TEST_OK;
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "common.hpp"
+#include "gemv_kernel.hpp"
+#include "test_helper.hpp"
+
+void host_gemv_int32(uint32_t m, uint32_t n, const int *mat, const int *vec, int *y, int alpha, int beta) {
+  for (size_t row = 0; row < m; ++row) {
+    int mul_res = 0;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += vec[col] * mat[row * n + col];
+    }
+    y[row] = alpha * mul_res + beta * y[row];
+  }
+}
+
+bool test_partition(uint32_t m, uint32_t nr_dpus) {
+  auto part = balance_rows(m, nr_dpus, 2);
+  uint32_t next_row = 0;
+  uint32_t min_rows = part.rows_per_dpu;
+  for (uint32_t i = 0; i < part.nr_dpus; i++) {
+    if (part.first_row(i) != next_row || part.nr_rows(i) > part.rows_per_dpu) {
+      return false;
+    }
+    next_row += part.nr_rows(i);
+    min_rows = std::min(min_rows, part.nr_rows(i));
+  }
+  // Every row is covered, padding is at most one row and shares differ by one pair at most
+  return next_row >= m && next_row - m < 2 && part.rows_per_dpu - min_rows <= 2;
+}
+
+bool test_gemv(uint32_t m, uint32_t n, uint32_t nr_dpus, int alpha, int beta) {
+  auto mat = generateRandomIntegral<int>(m * n, -100, 100);
+  auto vec = generateRandomIntegral<int>(n, -100, 100);
+  auto y = generateRandomIntegral<int>(m, -100, 100);
+  auto y_host = pimblas::vector<int>(y.begin(), y.end());
+  host_gemv_int32(m, n, mat.data(), vec.data(), y_host.data(), alpha, beta);
+
+  GEMV_INT32_Kernel kernel;
+  if (false == kernel.init(m, n, nr_dpus, alignUp((m - 1) / nr_dpus + 1, 32))) {
+    return false;
+  }
+  kernel.set_params(&alpha, &beta, false);
+  kernel.set_A(mat.data(), true);
+  kernel.set_x(vec.data(), true);
+  kernel.set_y(y.data(), true);
+  kernel.launch(true);
+  kernel.get_y(y.data(), true);
+  kernel.sync();
+  return same_vectors(y, y_host);
+}
+
+int main(int argc, char **argv) {
+  if (false == test_partition(1001, 64) || false == test_partition(64, 64) || false == test_partition(7, 64) ||
+      false == test_partition(4099, 64)) {
+    std::cout << "fail partition\n";
+    RET_TEST_FAIL;
+  }
+
+  // Odd m, DPUs get 16 or 14 rows and the last one a padded row
+  if (false == test_gemv(1001, 131, 64, 2, 3)) {
+    std::cout << "fail ragged\n";
+    RET_TEST_FAIL;
+  }
+  // Fewer rows than tasklets
+  if (false == test_gemv(21, 517, 2, 1, 0)) {
+    std::cout << "fail short\n";
+    RET_TEST_FAIL;
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}
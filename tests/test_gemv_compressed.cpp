@@ -0,0 +1,108 @@
+#include "common.hpp"
+#include "gemv_kernel.hpp"
+#include "test_helper.hpp"
+#include "zero_blocks.hpp"
+
+template <typename inType, typename outType>
+void host_gemv(uint32_t m, uint32_t n, const inType *mat, const inType *vec, outType *y, outType alpha, outType beta) {
+  for (size_t row = 0; row < m; ++row) {
+    outType mul_res = 0;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += vec[col] * mat[row * n + col];
+    }
+    y[row] = alpha * mul_res + beta * y[row];
+  }
+}
+
+// Zero out all but every density-th value, whole rows and blocks of A end up empty
+template <typename T>
+void sparsify(pimblas::vector<T> &mat, size_t density) {
+  for (size_t i = 0; i < mat.size(); i++) {
+    if (i % density != 0) {
+      mat[i] = 0;
+    }
+  }
+}
+
+bool test_compress_row() {
+  // 2 blocks and a partial word at the end
+  const size_t row_bytes = ZB_BLOCK_BYTES + 13;
+  std::vector<uint8_t> row(row_bytes, 0);
+  std::vector<uint64_t> out;
+  zb_compress_row(row.data(), row_bytes, out);
+  if (out.size() * 8 != 2 * ZB_HEADER_BYTES) {
+    return false;
+  }
+
+  row[3] = 1;
+  row[row_bytes - 1] = 2;
+  out.clear();
+  zb_compress_row(row.data(), row_bytes, out);
+  uint32_t masks[ZB_MASK_WORDS];
+  std::memcpy(masks, out.data(), ZB_HEADER_BYTES);
+  if (out.size() * 8 != 2 * ZB_HEADER_BYTES + 16 || masks[0] != 1 || out[ZB_HEADER_BYTES / 8] != (1ull << 24)) {
+    return false;
+  }
+  // Last word of the row is zero padded
+  return out.back() == (2ull << 32) && out.size() * 8 <= ZB_ROW_BOUND(row_bytes);
+}
+
+template <typename inType, typename outType, class Kernel>
+bool test_gemv(uint32_t m, uint32_t n, uint32_t nr_dpus, pimblas::vector<inType> &mat, pimblas::vector<inType> &vec,
+               outType alpha, outType beta) {
+  auto y = pimblas::vector<outType>(m, 3);
+  auto y_host = pimblas::vector<outType>(y.begin(), y.end());
+  host_gemv(m, n, mat.data(), vec.data(), y_host.data(), alpha, beta);
+
+  Kernel kernel;
+  if (false == kernel.init(m, n, nr_dpus, alignUp((m - 1) / nr_dpus + 1, 32))) {
+    return false;
+  }
+  kernel.set_params(&alpha, &beta, false);
+  kernel.set_A(mat.data(), true);
+  kernel.set_x(vec.data(), true);
+  kernel.set_y(y.data(), true);
+  kernel.launch(true);
+  kernel.get_y(y.data(), true);
+  kernel.sync();
+  if constexpr (std::is_floating_point<outType>::value) {
+    return mostly_same_rel(y.data(), y_host.data(), m, 1e-4f);
+  } else {
+    return same_vectors(y, y_host);
+  }
+}
+
+int main(int argc, char **argv) {
+  if (false == test_compress_row()) {
+    std::cout << "fail compress row\n";
+    RET_TEST_FAIL;
+  }
+
+  {
+    // Odd row size, rows aren't 8B aligned in the source
+    const uint32_t m = 1001;
+    const uint32_t n = 2051;
+    auto mat = generateRandomIntegral<int8_t>(m * n, -100, 100);
+    auto vec = generateRandomIntegral<int8_t>(n, -100, 100);
+    sparsify(mat, 97);
+    if (false == test_gemv<int8_t, int, GEMV_INT8_ZB_Kernel>(m, n, 64, mat, vec, 2, 3)) {
+      std::cout << "fail int8\n";
+      RET_TEST_FAIL;
+    }
+  }
+
+  {
+    const uint32_t m = 517;
+    const uint32_t n = 777;
+    auto mat = generateRandomFloats(m * n, 1.0f, 10.0f);
+    auto vec = generateRandomFloats(n, 1.0f, 10.0f);
+    sparsify(mat, 31);
+    if (false == test_gemv<float, float, GEMVF_ZB_Kernel>(m, n, 32, mat, vec, 1.5f, 0.5f)) {
+      std::cout << "fail float\n";
+      RET_TEST_FAIL;
+    }
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}
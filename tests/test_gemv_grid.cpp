@@ -0,0 +1,90 @@
+#include "common.hpp"
+#include "dpu_transfer_helper.hpp"
+#include "test_helper.hpp"
+
+void host_gemv_f(uint32_t m, uint32_t n, const float *mat, const float *vec, float *y, float alpha, float beta) {
+  for (size_t row = 0; row < m; ++row) {
+    float mul_res = 0.0f;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += vec[col] * mat[row * n + col];
+    }
+    y[row] = alpha * mul_res + y[row] * beta;
+  }
+}
+
+void host_gemv_int8(uint32_t m, uint32_t n, const int8_t *mat, const int8_t *vec, int *y, int alpha, int beta) {
+  for (size_t row = 0; row < m; ++row) {
+    int mul_res = 0;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += static_cast<int>(vec[col]) * static_cast<int>(mat[row * n + col]);
+    }
+    y[row] = alpha * mul_res + y[row] * beta;
+  }
+}
+
+bool test_plan() {
+  // Tall matrix fills the DPUs with rows
+  auto tall = plan_gemv_partition<float>(65536, 512, 64, 64);
+  if (tall.grid_cols != 1 || tall.nr_dpus() != 64) {
+    return false;
+  }
+  // Short and wide, a single row block and the columns over the rest
+  auto wide = plan_gemv_partition<float>(32, 1 << 20, 64, 64);
+  if (wide.grid_rows != 1 || wide.grid_cols != 64 || wide.cols_per_dpu % 8 != 0) {
+    return false;
+  }
+  // 2D grid
+  auto grid = plan_gemv_partition<int>(128, 1 << 20, 64, 64);
+  return grid.grid_rows == 4 && grid.grid_cols == 16;
+}
+
+bool test_grid_f(uint32_t m, uint32_t n, float alpha, float beta) {
+  auto mat = generateRandomFloats(m * n, -1.0f, 1.0f);
+  auto vec = generateRandomFloats(n, -1.0f, 1.0f);
+  auto y = generateRandomFloats(m, -1.0f, 1.0f);
+  auto y_host = pimblas::vector<float>(y.begin(), y.end());
+
+  if (gemv_f(m, n, mat.data(), vec.data(), y.data(), &alpha, &beta) != 0) {
+    return false;
+  }
+  host_gemv_f(m, n, mat.data(), vec.data(), y_host.data(), alpha, beta);
+  return mostly_same_rel(y.data(), y_host.data(), m, 1e-3f);
+}
+
+bool test_grid_int8(uint32_t m, uint32_t n, int alpha, int beta) {
+  auto mat = generateRandomIntegral<int8_t>(m * n, -100, 100);
+  auto vec = generateRandomIntegral<int8_t>(n, -100, 100);
+  auto y = generateRandomIntegral<int>(m, -100, 100);
+  auto y_host = pimblas::vector<int>(y.begin(), y.end());
+
+  if (gemv_int8(m, n, mat.data(), vec.data(), y.data(), &alpha, &beta) != 0) {
+    return false;
+  }
+  host_gemv_int8(m, n, mat.data(), vec.data(), y_host.data(), alpha, beta);
+  return same_vectors(y, y_host);
+}
+
+int main(int argc, char **argv) {
+  if (false == test_plan()) {
+    std::cout << "fail plan\n";
+    RET_TEST_FAIL;
+  }
+
+  // 4 x 16 grid, the last column block is padded
+  if (false == test_grid_f(100, 40003, 0.5f, 2.0f)) {
+    std::cout << "fail grid f\n";
+    RET_TEST_FAIL;
+  }
+  // Column split only, fewer rows than a DPU block
+  if (false == test_grid_int8(20, 70001, 2, 0)) {
+    std::cout << "fail column split int8\n";
+    RET_TEST_FAIL;
+  }
+  if (false == test_grid_int8(100, 20000, 1, 3)) {
+    std::cout << "fail grid int8\n";
+    RET_TEST_FAIL;
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}
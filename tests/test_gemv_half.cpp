@@ -0,0 +1,106 @@
+#include "common.hpp"
+#include "share_half.h"
+#include "test_helper.hpp"
+
+using ToFloat = float (*)(uint16_t);
+using FromFloat = uint16_t (*)(float);
+
+// Random 16-bit values and the floats they stand for
+void generate_half(size_t size, FromFloat from_float, ToFloat to_float, pimblas::vector<uint16_t> &bits,
+                   pimblas::vector<float> &values) {
+  auto floats = generateRandomFloats(size, 1.0f, 10.0f);
+  bits.resize(size);
+  values.resize(size);
+  for (size_t i = 0; i < size; i++) {
+    bits[i] = from_float(floats[i]);
+    values[i] = to_float(bits[i]);
+  }
+}
+
+bool test_bf16() {
+  if (float_to_bf16(1.0f) != 0x3F80 || bf16_to_float(0x3F80) != 1.0f || bf16_to_float(float_to_bf16(-2.5f)) != -2.5f) {
+    return false;
+  }
+  // 1 + 2^-8 is halfway between 1 and 1 + 2^-7, ties go to even
+  return float_to_bf16(1.00390625f) == 0x3F80 && float_to_bf16(1.01171875f) == 0x3F82;
+}
+
+bool test_gemv(uint32_t m, uint32_t n, bool bf16) {
+  FromFloat from_float = bf16 ? float_to_bf16 : float_to_half;
+  ToFloat to_float = bf16 ? bf16_to_float : half_to_float;
+  pimblas::vector<uint16_t> A, x;
+  pimblas::vector<float> A_f, x_f;
+  generate_half(static_cast<size_t>(m) * n, from_float, to_float, A, A_f);
+  generate_half(n, from_float, to_float, x, x_f);
+  auto y = generateRandomFloats(m, 1.0f, 10.0f);
+  auto y_host = pimblas::vector<float>(y.begin(), y.end());
+  float alpha = 1.5f;
+  float beta = 0.5f;
+
+  for (size_t row = 0; row < m; row++) {
+    float sum = 0;
+    for (size_t col = 0; col < n; col++) {
+      sum += A_f[row * n + col] * x_f[col];
+    }
+    y_host[row] = alpha * sum + beta * y_host[row];
+  }
+
+  int ret = bf16 ? gemv_bf16(m, n, A.data(), x.data(), y.data(), &alpha, &beta)
+                 : hgemv(m, n, A.data(), x.data(), y.data(), &alpha, &beta);
+  return ret == 0 && mostly_same_rel(y.data(), y_host.data(), m, 1e-4f);
+}
+
+bool test_gemm(int m, int n, int k, bool bf16) {
+  FromFloat from_float = bf16 ? float_to_bf16 : float_to_half;
+  ToFloat to_float = bf16 ? bf16_to_float : half_to_float;
+  pimblas::vector<uint16_t> A, B;
+  pimblas::vector<float> A_f, B_f;
+  generate_half(static_cast<size_t>(m) * k, from_float, to_float, A, A_f);
+  generate_half(static_cast<size_t>(k) * n, from_float, to_float, B, B_f);
+  auto C = generateRandomFloats(static_cast<size_t>(m) * n, 1.0f, 10.0f);
+  auto C_host = pimblas::vector<float>(C.begin(), C.end());
+  float alpha = 1.0f;
+  float beta = 1.0f;
+
+  for (size_t row = 0; row < m; row++) {
+    for (size_t col = 0; col < n; col++) {
+      float sum = 0;
+      for (size_t i = 0; i < k; i++) {
+        sum += A_f[row * k + i] * B_f[i * n + col];
+      }
+      C_host[row * n + col] = alpha * sum + beta * C_host[row * n + col];
+    }
+  }
+
+  if (bf16) {
+    gemm_row_maj_bf16(&m, &n, &k, &alpha, A.data(), B.data(), &beta, C.data());
+  } else {
+    gemm_row_maj_f16(&m, &n, &k, &alpha, A.data(), B.data(), &beta, C.data());
+  }
+  return mostly_same_rel(C.data(), C_host.data(), C.size(), 1e-4f);
+}
+
+int main(int argc, char **argv) {
+  if (false == test_bf16()) {
+    std::cout << "fail bf16 conversion\n";
+    RET_TEST_FAIL;
+  }
+  for (bool bf16 : {false, true}) {
+    // Odd n leaves rows starting at every even offset
+    for (uint32_t n : {13u, 511u, 1427u, 4096u}) {
+      if (false == test_gemv(1331, n, bf16)) {
+        std::cout << "fail gemv n=" << n << " bf16=" << bf16 << "\n";
+        RET_TEST_FAIL;
+      }
+    }
+    // Tiled kernel and the 16-bit multi-vector GEMV fallback, odd k leaves rows of A unaligned
+    if (false == test_gemm(300, 260, 301, bf16) || false == test_gemm(17, 300, 130, bf16) ||
+        false == test_gemm(17, 301, 131, bf16)) {
+      std::cout << "fail gemm bf16=" << bf16 << "\n";
+      RET_TEST_FAIL;
+    }
+  }
+
+  std::cout << "SUCCESS " << std::endl;
+  RET_TEST_OK;
+}
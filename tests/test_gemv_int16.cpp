@@ -0,0 +1,75 @@
+#include "common.hpp"
+#include "gemv_kernel.hpp"
+#include "test_helper.hpp"
+
+int host_gemv_int16(uint32_t m, uint32_t n, const int16_t *mat, const int16_t *vec, int *y, int alpha, int beta) {
+  for (size_t row = 0; row < m; ++row) {
+    // Sums of full range products wrap, unsigned keeps that defined
+    uint32_t mul_res = 0;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += static_cast<uint32_t>(static_cast<int>(vec[col]) * static_cast<int>(mat[row * n + col]));
+    }
+    y[row] = alpha * static_cast<int>(mul_res) + y[row] * beta;
+  }
+
+  return 0;
+}
+
+// Rows zero padded to 8B on the host or moved as they are
+bool test_padded_rows(uint32_t m, uint32_t n, bool padded_rows) {
+  auto mat = generateRandomIntegral<int16_t>(m * n, -1000, 1000);
+  auto vec = generateRandomIntegral<int16_t>(n, -1000, 1000);
+  auto y = generateRandomIntegers(m, -100, 100);
+  auto y_host = pimblas::vector<int>(y.begin(), y.end());
+  int alpha = 2;
+  int beta = 3;
+  host_gemv_int16(m, n, mat.data(), vec.data(), y_host.data(), alpha, beta);
+
+  GEMV_INT16_Kernel kernel(padded_rows);
+  if (false == kernel.init(m, n)) {
+    return false;
+  }
+  kernel.set_params(&alpha, &beta, false);
+  kernel.set_A(mat.data(), false);
+  kernel.set_x(vec.data(), false);
+  kernel.set_y(y.data(), false);
+  kernel.launch(false);
+  kernel.get_y(y.data(), false);
+  return same_vectors(y, y_host);
+}
+
+int main(int argc, char **argv) {
+  for (uint32_t n : {13u, 1023u, 1024u, 1026u}) {
+    for (bool padded_rows : {true, false}) {
+      if (false == test_padded_rows(777, n, padded_rows)) {
+        std::cout << "fail n=" << n << " padded_rows=" << padded_rows << "\n";
+        RET_TEST_FAIL;
+      }
+    }
+  }
+
+  // Full int16 range, sums wrap the same way on both sides
+  const int M = 1331;
+  const int N = 1427;
+  auto mat =
+      generateRandomIntegral<int16_t>(M * N, std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max());
+  auto vec =
+      generateRandomIntegral<int16_t>(N, std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max());
+  auto y = generateRandomIntegers(M, -100, 100);
+  auto y_host = pimblas::vector<int>(y.begin(), y.end());
+  int alpha = 1;
+  int beta = 0;
+
+  if (gemv_int16(M, N, mat.data(), vec.data(), y.data(), &alpha, &beta) != 0) {
+    RET_TEST_FAIL;
+  }
+  host_gemv_int16(M, N, mat.data(), vec.data(), y_host.data(), alpha, beta);
+
+  if (false == same_vectors(y, y_host)) {
+    std::cout << "fail\n";
+    RET_TEST_FAIL;
+  }
+
+  std::cout << "SUCCESS " << std::endl;
+  RET_TEST_OK;
+}
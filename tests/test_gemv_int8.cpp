@@ -1,4 +1,5 @@
 #include "common.hpp"
+#include "gemv_kernel.hpp"
 #include "test_helper.hpp"
 
 int host_gemv_int8(uint32_t m, uint32_t n, const int8_t *mat, const int8_t *vec, int *y, int alpha, int beta) {
@@ -13,7 +14,39 @@ int host_gemv_int8(uint32_t m, uint32_t n, const int8_t *mat, const int8_t *vec,
   return 0;
 }
 
+// Rows zero padded to 8B on the host or moved as they are
+bool test_padded_rows(uint32_t m, uint32_t n, bool padded_rows) {
+  auto mat = generateRandomIntegral<int8_t>(m * n, -100, 100);
+  auto vec = generateRandomIntegral<int8_t>(n, -100, 100);
+  auto y = generateRandomIntegers(m, -100, 100);
+  auto y_host = pimblas::vector<int>(y.begin(), y.end());
+  int alpha = 2;
+  int beta = 3;
+  host_gemv_int8(m, n, mat.data(), vec.data(), y_host.data(), alpha, beta);
+
+  GEMV_INT8_Kernel kernel(padded_rows);
+  if (false == kernel.init(m, n)) {
+    return false;
+  }
+  kernel.set_params(&alpha, &beta, false);
+  kernel.set_A(mat.data(), false);
+  kernel.set_x(vec.data(), false);
+  kernel.set_y(y.data(), false);
+  kernel.launch(false);
+  kernel.get_y(y.data(), false);
+  return same_vectors(y, y_host);
+}
+
 int main(int argc, char **argv) {
+  for (uint32_t n : {13u, 4095u, 4096u, 2049u}) {
+    for (bool padded_rows : {true, false}) {
+      if (false == test_padded_rows(777, n, padded_rows)) {
+        std::cout << "fail n=" << n << " padded_rows=" << padded_rows << "\n";
+        RET_TEST_FAIL;
+      }
+    }
+  }
+
   const int M = 1331;
   const int N = 1427;
   auto mat =
@@ -0,0 +1,113 @@
+#include "common.hpp"
+#include "gemv_multi_kernel.hpp"
+#include "test_helper.hpp"
+
+// X holds nr_vectors vectors of size n, Y nr_vectors vectors of size m
+template <typename inType, typename outType>
+void host_gemv_multi(uint32_t m, uint32_t n, uint32_t nr_vectors, const inType *A, const inType *X, outType *Y,
+                     outType alpha, outType beta) {
+  for (uint32_t v = 0; v < nr_vectors; v++) {
+    for (uint32_t row = 0; row < m; row++) {
+      outType acc = 0;
+      for (uint32_t col = 0; col < n; col++) {
+        acc += static_cast<outType>(A[row * n + col]) * static_cast<outType>(X[v * n + col]);
+      }
+      Y[v * m + row] = alpha * acc + beta * Y[v * m + row];
+    }
+  }
+}
+
+template <typename T>
+pimblas::vector<T> generate_values(size_t size) {
+  return generateRandomIntegral<T>(size, -100, 100);
+}
+
+template <>
+pimblas::vector<float> generate_values<float>(size_t size) {
+  return generateRandomFloats(size, -1.0f, 1.0f);
+}
+
+template <typename T>
+bool same_values(T *a, T *b, size_t size) {
+  return same(a, b, size);
+}
+
+template <>
+bool same_values<float>(float *a, float *b, size_t size) {
+  return mostly_same_abs(a, b, size, 1e-3f);
+}
+
+// More vectors than max_vectors go in several launches, the last one with the rest.
+// rows_per_dpu of 0 takes the split of gemv_launch_statistics.
+template <class Kernel, typename inType, typename outType>
+bool test_multi(uint32_t m, uint32_t n, uint32_t nr_vectors, outType alpha, outType beta, uint32_t rows_per_dpu = 0) {
+  auto A = generate_values<inType>(m * n);
+  auto X = generate_values<inType>(n * nr_vectors);
+  auto Y = generate_values<outType>(m * nr_vectors);
+  auto Y_host = pimblas::vector<outType>(Y.begin(), Y.end());
+  host_gemv_multi(m, n, nr_vectors, A.data(), X.data(), Y_host.data(), alpha, beta);
+
+  uint32_t nr_dpus = 64;
+  if (rows_per_dpu == 0) {
+    gemv_launch_statistics<outType>(m, n, nr_dpus, rows_per_dpu, get_dpus_per_rank());
+  } else {
+    nr_dpus = (m - 1) / rows_per_dpu + 1;
+  }
+  uint32_t max_vectors = Kernel::fit_nr_vectors(n, rows_per_dpu, Kernel::max_vectors, Kernel::base_nr_tasklets);
+  if (max_vectors == 0) {
+    return false;
+  }
+
+  Kernel kernel;
+  if (false == kernel.init(m, n, nr_dpus, rows_per_dpu)) {
+    return false;
+  }
+  kernel.set_A(A.data(), true);
+  for (uint32_t v = 0; v < nr_vectors; v += max_vectors) {
+    uint32_t batch = std::min(max_vectors, nr_vectors - v);
+    kernel.set_params(&alpha, &beta, batch, false);
+    kernel.set_x(X.data() + v * n, batch, true);
+    kernel.set_y(Y.data() + v * m, batch, true);
+    kernel.launch(true);
+    kernel.get_y_safe(Y.data() + v * m, batch);
+  }
+  return same_values(Y.data(), Y_host.data(), Y.size());
+}
+
+int main(int argc, char **argv) {
+  // x of 3M floats leaves no room for max_vectors of them next to 2 rows
+  if (GEMVF_Multi_Kernel::fit_nr_vectors(3 * 1024 * 1024, 2, GEMVF_Multi_Kernel::max_vectors, 16) != 0 ||
+      GEMVF_Multi_Kernel::fit_nr_vectors(1024, 32, GEMVF_Multi_Kernel::max_vectors, 16) !=
+          GEMVF_Multi_Kernel::max_vectors) {
+    std::cout << "fail fit_nr_vectors\n";
+    RET_TEST_FAIL;
+  }
+
+  for (uint32_t nr_vectors : {3u, 2 * GEMV_INT8_Multi_Kernel::max_vectors + 1}) {
+    if (false == test_multi<GEMV_INT8_Multi_Kernel, int8_t, int>(1331, 1427, nr_vectors, 2, 3)) {
+      std::cout << "fail int8 nr_vectors=" << nr_vectors << "\n";
+      RET_TEST_FAIL;
+    }
+    // Odd row size, most rows of A start unaligned
+    if (false == test_multi<GEMV_INT16_Multi_Kernel, int16_t, int>(1331, 1427, nr_vectors, 2, 3)) {
+      std::cout << "fail int16 nr_vectors=" << nr_vectors << "\n";
+      RET_TEST_FAIL;
+    }
+    if (false == test_multi<GEMV_INT32_Multi_Kernel, int, int>(1001, 517, nr_vectors, 2, 3)) {
+      std::cout << "fail int32 nr_vectors=" << nr_vectors << "\n";
+      RET_TEST_FAIL;
+    }
+    if (false == test_multi<GEMVF_Multi_Kernel, float, float>(1001, 1023, nr_vectors, 1.5f, 0.5f)) {
+      std::cout << "fail float nr_vectors=" << nr_vectors << "\n";
+      RET_TEST_FAIL;
+    }
+    // 9 pairs of rows per DPU, the last tasklets have none
+    if (false == test_multi<GEMV_INT32_Multi_Kernel, int, int>(1001, 517, nr_vectors, 2, 3, 18)) {
+      std::cout << "fail int32 short rows nr_vectors=" << nr_vectors << "\n";
+      RET_TEST_FAIL;
+    }
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}
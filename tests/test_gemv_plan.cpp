@@ -0,0 +1,89 @@
+#include "common.hpp"
+#include "test_helper.hpp"
+
+int host_gemv_f(uint32_t m, uint32_t n, const float *mat, const float *vec, float *y, float alpha, float beta) {
+  for (size_t row = 0; row < m; ++row) {
+    float mul_res = 0.0f;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += vec[col] * mat[row * n + col];
+    }
+    y[row] = alpha * mul_res + y[row] * beta;
+  }
+
+  return 0;
+}
+
+int host_gemv_int8(uint32_t m, uint32_t n, const int8_t *mat, const int8_t *vec, int *y, int alpha, int beta) {
+  for (size_t row = 0; row < m; ++row) {
+    int mul_res = 0;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += static_cast<int>(vec[col]) * static_cast<int>(mat[row * n + col]);
+    }
+    y[row] = alpha * mul_res + y[row] * beta;
+  }
+
+  return 0;
+}
+
+bool test_gemv_plan_f(uint32_t M, uint32_t N, int runs) {
+  auto mat = generateRandomFloats(M * N, -1.0f, 1.0f);
+  auto *plan = pimblas_gemv_plan_create(M, N, mat.data(), PIMBLAS_DTYPE_FLOAT);
+  if (plan == nullptr) {
+    return false;
+  }
+
+  float alpha = 0.5f;
+  float beta = 2.0f;
+  bool ok = true;
+  for (int run = 0; run < runs && ok; run++) {
+    auto vec = generateRandomFloats(N, -1.0f, 1.0f);
+    auto y = generateRandomFloats(M, -1.0f, 1.0f);
+    auto y_host = pimblas::vector<float>(y.begin(), y.end());
+    pimblas_gemv_plan_execute(plan, vec.data(), y.data(), &alpha, &beta);
+    host_gemv_f(M, N, mat.data(), vec.data(), y_host.data(), alpha, beta);
+    ok = mostly_same_abs(y.data(), y_host.data(), M, 1e-3f);
+  }
+
+  pimblas_gemv_plan_destroy(plan);
+  return ok;
+}
+
+bool test_gemv_plan_int8(uint32_t M, uint32_t N, int runs) {
+  auto mat =
+      generateRandomIntegral<int8_t>(M * N, std::numeric_limits<int8_t>::min(), std::numeric_limits<int8_t>::max());
+  auto *plan = pimblas_gemv_plan_create(M, N, mat.data(), PIMBLAS_DTYPE_INT8);
+  if (plan == nullptr) {
+    return false;
+  }
+
+  int alpha = 1;
+  int beta = 0;
+  bool ok = true;
+  for (int run = 0; run < runs && ok; run++) {
+    auto vec =
+        generateRandomIntegral<int8_t>(N, std::numeric_limits<int8_t>::min(), std::numeric_limits<int8_t>::max());
+    auto y = generate(M);
+    auto y_host = generate(M);
+    pimblas_gemv_plan_execute(plan, vec.data(), y.data(), &alpha, &beta);
+    host_gemv_int8(M, N, mat.data(), vec.data(), y_host.data(), alpha, beta);
+    ok = same_vectors(y, y_host);
+  }
+
+  pimblas_gemv_plan_destroy(plan);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  if (false == test_gemv_plan_f(1024, 1000, 8)) {
+    std::cout << "test_gemv_plan_f FAIL\n";
+    RET_TEST_FAIL;
+  }
+
+  if (false == test_gemv_plan_int8(1331, 1427, 8)) {
+    std::cout << "test_gemv_plan_int8 FAIL\n";
+    RET_TEST_FAIL;
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}
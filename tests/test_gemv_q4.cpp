@@ -0,0 +1,97 @@
+#include <cmath>
+
+#include "common.hpp"
+#include "gemv_q4_kernel.hpp"
+#include "share_half.h"
+#include "test_helper.hpp"
+
+bool test_half() {
+  if (float_to_half(1.0f) != 0x3C00 || half_to_float(0x3C00) != 1.0f) {
+    return false;
+  }
+  if (half_to_float(float_to_half(65504.0f)) != 65504.0f || half_to_float(float_to_half(-2.5f)) != -2.5f) {
+    return false;
+  }
+  // Smallest subnormal
+  float tiny = std::ldexp(1.0f, -24);
+  return float_to_half(tiny) == 1 && half_to_float(1) == tiny;
+}
+
+// Every weight is within half a step of its group
+bool test_pack_row(uint32_t n, uint32_t group_size, bool zero_points) {
+  auto W = generateRandomFloats(n, -3.0f, 2.0f);
+  std::vector<uint8_t> packed(Q4_ROW_BYTES(n, group_size, zero_points));
+  std::vector<float> unpacked(n);
+  q4_pack_row(W.data(), n, group_size, zero_points, packed.data());
+  q4_unpack_row(packed.data(), n, group_size, zero_points, unpacked.data());
+  auto *scales = reinterpret_cast<const uint16_t *>(packed.data() + Q4_WEIGHT_BYTES(n, group_size));
+  for (uint32_t i = 0; i < n; i++) {
+    float step = half_to_float(scales[i / group_size]);
+    if (std::fabs(W[i] - unpacked[i]) > step * 0.5f + 1e-6f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Kernel against the unpacked weights times the quantized x
+bool test_gemv(uint32_t m, uint32_t n, uint32_t group_size, bool zero_points) {
+  auto W = generateRandomFloats(static_cast<size_t>(m) * n, -1.0f, 1.0f);
+  auto x = generateRandomFloats(n, -1.0f, 1.0f);
+  auto y = generateRandomFloats(m, -1.0f, 1.0f);
+  float alpha = 1.5f;
+  float beta = 0.5f;
+
+  std::vector<uint8_t> packed(pimblas_q4_size(m, n, group_size, zero_points));
+  if (0 != pimblas_q4_pack(m, n, W.data(), group_size, zero_points, packed.data())) {
+    return false;
+  }
+  std::vector<int8_t> x_q(n);
+  float x_scale = q4_quantize_x(x.data(), n, x_q.data());
+
+  auto y_host = pimblas::vector<float>(y.begin(), y.end());
+  size_t row_bytes = Q4_ROW_BYTES(n, group_size, zero_points);
+  std::vector<float> row(n);
+  for (uint32_t r = 0; r < m; r++) {
+    q4_unpack_row(packed.data() + r * row_bytes, n, group_size, zero_points, row.data());
+    double sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      sum += static_cast<double>(row[i]) * x_q[i];
+    }
+    y_host[r] = alpha * x_scale * static_cast<float>(sum) + beta * y_host[r];
+  }
+
+  if (0 != gemv_q4_f(m, n, packed.data(), group_size, zero_points, x.data(), y.data(), &alpha, &beta)) {
+    return false;
+  }
+  // Group sums are exact, only float accumulation differs
+  return mostly_same_abs(y.data(), y_host.data(), m, 1e-3f);
+}
+
+int main(int argc, char **argv) {
+  if (false == test_half()) {
+    std::cout << "fail half\n";
+    RET_TEST_FAIL;
+  }
+  for (uint32_t group_size : {16u, 32u, 64u, 128u, 256u}) {
+    for (bool zero_points : {false, true}) {
+      if (false == test_pack_row(1000, group_size, zero_points)) {
+        std::cout << "fail pack group_size=" << group_size << " zero_points=" << zero_points << "\n";
+        RET_TEST_FAIL;
+      }
+    }
+  }
+  for (uint32_t n : {1000u, 4095u, 4096u}) {
+    for (uint32_t group_size : {32u, 64u, 128u}) {
+      for (bool zero_points : {false, true}) {
+        if (false == test_gemv(555, n, group_size, zero_points)) {
+          std::cout << "fail n=" << n << " group_size=" << group_size << " zero_points=" << zero_points << "\n";
+          RET_TEST_FAIL;
+        }
+      }
+    }
+  }
+
+  std::cout << "SUCCESS " << std::endl;
+  RET_TEST_OK;
+}
@@ -0,0 +1,48 @@
+#include "common.hpp"
+#include "gemv_streaming.hpp"
+#include "test_helper.hpp"
+
+void host_gemv_int32(uint32_t m, uint32_t n, const int *mat, const int *vec, int *y, int alpha, int beta) {
+  for (size_t row = 0; row < m; ++row) {
+    int mul_res = 0;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += vec[col] * mat[row * n + col];
+    }
+    y[row] = alpha * mul_res + beta * y[row];
+  }
+}
+
+bool test_streaming(uint32_t m, uint32_t n, int alpha, int beta, uint32_t max_dpus, uint32_t max_slab_rows) {
+  auto mat = generateRandomIntegral<int>(m * n, -100, 100);
+  auto vec = generateRandomIntegral<int>(n, -100, 100);
+  auto y = generateRandomIntegral<int>(m, -100, 100);
+  auto y_host = pimblas::vector<int>(y.begin(), y.end());
+  host_gemv_int32(m, n, mat.data(), vec.data(), y_host.data(), alpha, beta);
+
+  if (gemv_streaming<int, int, GEMV_INT32_Kernel>(m, n, mat.data(), vec.data(), y.data(), &alpha, &beta, max_dpus,
+                                                  max_slab_rows) != 0) {
+    return false;
+  }
+  return same_vectors(y, y_host);
+}
+
+int main(int argc, char **argv) {
+  // Slabs are limited to force streaming: 8 slabs, the last one partial
+  if (false == test_streaming(1999, 523, 2, 0, 16, 256)) {
+    std::cout << "fail beta == 0\n";
+    RET_TEST_FAIL;
+  }
+  if (false == test_streaming(1999, 523, 1, 3, 16, 256)) {
+    std::cout << "fail beta != 0\n";
+    RET_TEST_FAIL;
+  }
+
+  // Everything fits, single slab
+  if (false == test_streaming(1024, 77, 1, 0, 64, 0)) {
+    std::cout << "fail single slab\n";
+    RET_TEST_FAIL;
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}
@@ -0,0 +1,113 @@
+#include "common.hpp"
+#include "gemv_kernel.hpp"
+#include "gemv_variants.hpp"
+#include "test_helper.hpp"
+
+void host_gemv_f(uint32_t m, uint32_t n, const float *mat, const float *vec, float *y, float alpha, float beta) {
+  for (size_t row = 0; row < m; ++row) {
+    float mul_res = 0;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += vec[col] * mat[row * n + col];
+    }
+    y[row] = alpha * mul_res + beta * y[row];
+  }
+}
+
+bool test_selection() {
+  // Short rows take the smallest block holding them
+  auto v = select_gemv_variant("gemv_f.kernel", 1024, 40, sizeof(float));
+  if (v.block_size != 64 || false == v.aligned_rows) {
+    return false;
+  }
+  v = select_gemv_variant("gemv_f.kernel", 1024, 201, sizeof(float));
+  if (v.block_size != 256 || v.aligned_rows) {
+    return false;
+  }
+  // Long rows take the largest block
+  v = select_gemv_variant("gemv_int8.kernel", 1024, 100000, sizeof(int8_t));
+  if (v.block_size != 2048 || false == v.aligned_rows) {
+    return false;
+  }
+  v = select_gemv_variant("gemv_int8.kernel", 1024, 1001, sizeof(int8_t));
+  if (v.block_size != 1024 || v.aligned_rows) {
+    return false;
+  }
+  // Fewest tasklets with a pair of rows each
+  if (v.nr_tasklets != 16 || select_gemv_variant("gemv_f.kernel", 2, 40, sizeof(float)).nr_tasklets != 4 ||
+      select_gemv_variant("gemv_f.kernel", 16, 40, sizeof(float)).nr_tasklets != 8 ||
+      select_gemv_variant("gemv_f.kernel", 18, 40, sizeof(float)).nr_tasklets != 16) {
+    return false;
+  }
+  // No variants
+  uint32_t nr_tasklets = 0;
+  return select_gemv_program("gemv_zb_f.kernel", 1024, 40, sizeof(float), nr_tasklets) == "gemv_zb_f.kernel" &&
+         nr_tasklets == Kernel::base_nr_tasklets;
+}
+
+bool test_launch_statistics() {
+  // Short matrix padded to pairs of rows only, spread over most of the rank
+  uint32_t nr_dpus = 64;
+  uint32_t rows_per_dpu = 0;
+  gemv_launch_statistics<float>(100, 256, nr_dpus, rows_per_dpu, DPUS_PER_RANK, 1);
+  if (rows_per_dpu != 2 || nr_dpus != 50) {
+    return false;
+  }
+  // Default keeps rows aligned for 16 tasklets
+  nr_dpus = 64;
+  gemv_launch_statistics<float>(100, 256, nr_dpus, rows_per_dpu, DPUS_PER_RANK);
+  return rows_per_dpu == 32 && nr_dpus == 4;
+}
+
+bool test_gemv_f(uint32_t m, uint32_t n) {
+  auto mat = generateRandomFloats(m * n, 1.0f, 10.0f);
+  auto vec = generateRandomFloats(n, 1.0f, 10.0f);
+  auto y = generateRandomFloats(m, 1.0f, 10.0f);
+  auto y_host = pimblas::vector<float>(y.begin(), y.end());
+  float alpha = 2.0f;
+  float beta = 0.5f;
+  host_gemv_f(m, n, mat.data(), vec.data(), y_host.data(), alpha, beta);
+
+  GEMVF_Kernel kernel;
+  if (false == kernel.init(m, n)) {
+    return false;
+  }
+  kernel.set_params(&alpha, &beta, false);
+  kernel.set_A(mat.data(), true);
+  kernel.set_x(vec.data(), true);
+  kernel.set_y(y.data(), true);
+  kernel.launch(true);
+  kernel.get_y(y.data(), true);
+  kernel.sync();
+  return mostly_same_rel(y.data(), y_host.data(), m, 1e-4f);
+}
+
+int main(int argc, char **argv) {
+  if (false == test_selection()) {
+    std::cout << "fail selection\n";
+    RET_TEST_FAIL;
+  }
+
+  if (false == test_launch_statistics()) {
+    std::cout << "fail launch statistics\n";
+    RET_TEST_FAIL;
+  }
+
+  // Smallest block with aligned and unaligned rows, a block boundary right at the end of the row
+  for (uint32_t n : {40u, 63u, 128u, 513u}) {
+    if (false == test_gemv_f(1000, n)) {
+      std::cout << "fail n=" << n << "\n";
+      RET_TEST_FAIL;
+    }
+  }
+
+  // Short matrices, DPUs run 4 and 8 tasklet variants, some tasklets without rows
+  for (uint32_t m : {7u, 100u, 900u}) {
+    if (false == test_gemv_f(m, 300)) {
+      std::cout << "fail m=" << m << "\n";
+      RET_TEST_FAIL;
+    }
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}
@@ -0,0 +1,70 @@
+#include "common.hpp"
+#include "dpu_transfer_helper.hpp"
+#include "gemv_kernel.hpp"
+#include "test_helper.hpp"
+
+void host_gemv_f(uint32_t m, uint32_t n, const float *mat, const float *vec, float *y) {
+  for (size_t row = 0; row < m; ++row) {
+    float mul_res = 0.0f;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += vec[col] * mat[row * n + col];
+    }
+    y[row] = mul_res;
+  }
+}
+
+int main(int argc, char **argv) {
+  const uint32_t M = 4099;
+  const uint32_t N = 517;
+
+  // Rows are spread over whole ranks
+  uint32_t dpus_per_rank = get_dpus_per_rank();
+  uint32_t nr_dpus = 64;
+  uint32_t rows_per_dpu = 0;
+  gemv_launch_statistics<float>(M, N, nr_dpus, rows_per_dpu, dpus_per_rank);
+  uint32_t nr_ranks = (nr_dpus - 1) / dpus_per_rank + 1;
+  if (nr_dpus * rows_per_dpu < M || (nr_ranks - 1) * dpus_per_rank * rows_per_dpu >= M) {
+    std::cout << "Unexpected partitioning nr_dpus=" << nr_dpus << " rows_per_dpu=" << rows_per_dpu << "\n";
+    RET_TEST_FAIL;
+  }
+
+  auto mat = generateRandomFloats(M * N, -10.0f, 10.0f);
+  auto vec = generateRandomFloats(N, -10.0f, 10.0f);
+  auto y = pimblas::vector<float>(M);
+  auto y_host = pimblas::vector<float>(M);
+  host_gemv_f(M, N, mat.data(), vec.data(), y_host.data());
+  float alpha = 1.0f;
+  float beta = 0.0f;
+
+  GEMVF_Kernel kernel;
+  if (false == kernel.init(M, N, nr_dpus, rows_per_dpu)) {
+    RET_TEST_FAIL;
+  }
+  kernel.enable_rank_timing(true);
+  kernel.set_params(&alpha, &beta, false);
+  kernel.set_A(mat.data(), true);
+  kernel.set_x(vec.data(), true);
+  kernel.launch(true);
+  kernel.sync();
+  kernel.get_y_safe(y.data());
+
+  if (false == mostly_same_rel(y.data(), y_host.data(), M, 1e-4f)) {
+    std::cout << "Wrong result\n";
+    RET_TEST_FAIL;
+  }
+
+  auto stats = kernel.get_rank_transfer_stats();
+  size_t bytes = 0;
+  for (size_t i = 0; i < stats.size(); i++) {
+    bytes += stats[i].bytes;
+    std::cout << "rank " << i << " dpus=" << stats[i].nr_dpus << " transfers=" << stats[i].nr_transfers
+              << " bytes=" << stats[i].bytes << " GB/s=" << stats[i].bytes / stats[i].seconds / 1e9 << "\n";
+  }
+  if (stats.empty() || bytes == 0) {
+    std::cout << "Missing rank timings\n";
+    RET_TEST_FAIL;
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}
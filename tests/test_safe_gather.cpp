@@ -0,0 +1,64 @@
+#include "common.hpp"
+#include "kernel.hpp"
+#include "staging_pool.hpp"
+#include "test_helper.hpp"
+
+// Chunks are scattered with a transfer plan and gathered back by safe_gather into an exact sized buffer
+bool test_gather(uint32_t nr_dpus, size_t chunk_size, size_t size) {
+  Kernel kernel;
+  if (false == kernel.allocate_n(nr_dpus)) {
+    return false;
+  }
+  kernel.load_program("gemv_f.kernel");
+
+  auto in = generateRandomIntegral<uint8_t>(size, 0, 255);
+  // Guard bytes after the buffer must survive the gather
+  auto out = pimblas::vector<uint8_t>(size + 8, 0xAB);
+  kernel.set_arg_scatter(DPU_MRAM_HEAP_POINTER_NAME, 0, in.data(), chunk_size, size, false);
+  safe_gather(kernel.get_dpu_set(), nr_dpus, DPU_MRAM_HEAP_POINTER_NAME, 0, out.data(), chunk_size, size);
+
+  for (size_t i = 0; i < size; i++) {
+    if (in[i] != out[i]) {
+      return false;
+    }
+  }
+  for (size_t i = size; i < out.size(); i++) {
+    if (out[i] != 0xAB) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  // In place
+  if (false == test_gather(8, 1024, 8 * 1024)) {
+    std::cout << "fail aligned\n";
+    RET_TEST_FAIL;
+  }
+  // Short unaligned tail
+  if (false == test_gather(8, 1024, 7 * 1024 + 13)) {
+    std::cout << "fail tail\n";
+    RET_TEST_FAIL;
+  }
+  // Unaligned chunks, every DPU staged
+  if (false == test_gather(5, 1001, 5 * 1001 - 3)) {
+    std::cout << "fail unaligned chunks\n";
+    RET_TEST_FAIL;
+  }
+
+  // Released buffers are handed out again
+  uint8_t *first = nullptr;
+  {
+    auto buffer = StagingPool::instance().acquire(4096);
+    first = buffer.data();
+  }
+  auto again = StagingPool::instance().acquire(4096);
+  if (again.data() != first || again.size() % 8 != 0) {
+    std::cout << "fail staging reuse\n";
+    RET_TEST_FAIL;
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}
@@ -0,0 +1,100 @@
+#include "common.hpp"
+#include "test_helper.hpp"
+
+int host_gemv_f(uint32_t m, uint32_t n, const float *mat, const float *vec, float *y, float alpha, float beta) {
+  for (size_t row = 0; row < m; ++row) {
+    float mul_res = 0.0f;
+    for (size_t col = 0; col < n; ++col) {
+      mul_res += vec[col] * mat[row * n + col];
+    }
+    y[row] = alpha * mul_res + y[row] * beta;
+  }
+
+  return 0;
+}
+
+void host_relu(const float *input, float *output, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    output[i] = input[i] > 0 ? input[i] : 0;
+  }
+}
+
+// alpha and beta go out of scope before the op runs, the stream has to copy them
+void enqueue_plan(pimblas_stream *stream, pimblas_gemv_plan *plan, const float *x, float *y) {
+  float alpha = 2.0f;
+  float beta = 0.0f;
+  pimblas_gemv_plan_execute_async(stream, plan, x, y, &alpha, &beta);
+}
+
+int main(int argc, char **argv) {
+  const int M = 2048;
+  const int N = 1024;
+  const int NR_STREAMS = 4;
+
+  auto mat = generateRandomFloats(M * N, -1.0f, 1.0f);
+  std::vector<pimblas::vector<float>> vecs;
+  std::vector<pimblas::vector<float>> ys;
+  for (int i = 0; i < NR_STREAMS; i++) {
+    vecs.push_back(generateRandomFloats(N, -1.0f, 1.0f));
+    ys.push_back(pimblas::vector<float>(M, 0.0f));
+  }
+  float alpha = 1.0f;
+  float beta = 0.0f;
+
+  // Independent GEMVs in flight on separate streams
+  std::vector<pimblas_stream *> streams;
+  for (int i = 0; i < NR_STREAMS; i++) {
+    streams.push_back(pimblas_stream_create());
+    gemv_f_async(streams[i], M, N, mat.data(), vecs[i].data(), ys[i].data(), &alpha, &beta);
+  }
+
+  // Second stream relu depends on the first gemv through an event
+  pimblas_event *event = pimblas_event_create();
+  pimblas_event_record(event, streams[0]);
+  pimblas_stream_wait_event(streams[1], event);
+  pimblas::vector<float> relu_out(M, 0.0f);
+  relu_f_async(streams[1], ys[0].data(), relu_out.data(), M);
+
+  // Plan op queued behind the gemv of the last stream
+  pimblas_gemv_plan *plan = pimblas_gemv_plan_create(M, N, mat.data(), PIMBLAS_DTYPE_FLOAT);
+  pimblas::vector<float> plan_y(M, 0.0f);
+  if (plan != nullptr) {
+    enqueue_plan(streams[NR_STREAMS - 1], plan, vecs[0].data(), plan_y.data());
+  }
+
+  bool ok = plan != nullptr;
+  for (int i = 0; i < NR_STREAMS; i++) {
+    ok &= pimblas_stream_synchronize(streams[i]) == 0;
+  }
+  ok &= pimblas_event_query(event) == 1;
+
+  for (int i = 0; i < NR_STREAMS && ok; i++) {
+    pimblas::vector<float> y_host(M, 0.0f);
+    host_gemv_f(M, N, mat.data(), vecs[i].data(), y_host.data(), alpha, beta);
+    ok = mostly_same_abs(ys[i].data(), y_host.data(), M, 1e-3f);
+  }
+
+  if (ok) {
+    pimblas::vector<float> y_host(M, 0.0f);
+    host_gemv_f(M, N, mat.data(), vecs[0].data(), y_host.data(), 2.0f, 0.0f);
+    ok = mostly_same_abs(plan_y.data(), y_host.data(), M, 2e-3f);
+  }
+
+  pimblas::vector<float> relu_host(M, 0.0f);
+  host_relu(ys[0].data(), relu_host.data(), M);
+  ok = ok && same(relu_out.data(), relu_host.data(), M);
+
+  pimblas_gemv_plan_destroy(plan);
+  pimblas_event_destroy(event);
+  for (auto *stream : streams) {
+    pimblas_stream_destroy(stream);
+  }
+
+  if (!ok) {
+    std::cout << "FAIL" << std::endl;
+    RET_TEST_FAIL;
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}
@@ -0,0 +1,53 @@
+#include "common.hpp"
+#include "kernel.hpp"
+#include "test_helper.hpp"
+
+// Round trip of chunks through MRAM heap, the same plans are rebound to fresh buffers every run
+bool test_chunks(uint32_t nr_dpus, size_t chunk_size, size_t size, size_t expected_staged) {
+  Kernel kernel;
+  if (false == kernel.allocate_n(nr_dpus)) {
+    return false;
+  }
+  kernel.load_program("gemv_f.kernel");
+
+  auto scatter = TransferPlan::chunks(kernel.get_dpu_set(), nr_dpus, DPU_XFER_TO_DPU, DPU_MRAM_HEAP_POINTER_NAME, 0,
+                                      chunk_size, size);
+  auto gather = TransferPlan::chunks(kernel.get_dpu_set(), nr_dpus, DPU_XFER_FROM_DPU, DPU_MRAM_HEAP_POINTER_NAME, 0,
+                                     chunk_size, size);
+  if (gather.get_nr_staged() != expected_staged) {
+    std::cout << "staged " << gather.get_nr_staged() << " expected " << expected_staged << "\n";
+    return false;
+  }
+
+  for (int run = 0; run < 3; run++) {
+    auto in = generateRandomIntegral<uint8_t>(size, 0, 255);
+    auto out = pimblas::vector<uint8_t>(size);
+    scatter.execute(in.data(), DPU_XFER_ASYNC);
+    gather.execute(out.data(), DPU_XFER_DEFAULT);
+    if (false == same_vectors(in, out)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  // Even split, nothing staged
+  if (false == test_chunks(8, 1024, 8 * 1024, 0)) {
+    std::cout << "fail even\n";
+    RET_TEST_FAIL;
+  }
+  // Short last chunk
+  if (false == test_chunks(8, 1024, 7 * 1024 + 100, 1)) {
+    std::cout << "fail remainder\n";
+    RET_TEST_FAIL;
+  }
+  // Chunks not 8B aligned overlap in a gather, all of them are staged
+  if (false == test_chunks(4, 1001, 4 * 1001, 4)) {
+    std::cout << "fail unaligned\n";
+    RET_TEST_FAIL;
+  }
+
+  std::cout << "SUCCESS" << std::endl;
+  RET_TEST_OK;
+}